@@ -0,0 +1,368 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+#ifndef UTIX_ALGORITHM_H_
+#define UTIX_ALGORITHM_H_
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <numeric>
+#include <utility>
+#include "Ints.h"
+#include "Alloc.h"
+#include "Log.h"
+#include "Traits.h"
+#include "ThreadPool.h"
+#include "Vector.h"
+
+
+namespace utix {
+
+
+// ranges shorter than this run the serial std algorithm,
+// splitting them costs more than the other workers save
+constexpr size_t ParallelSerialCutoff = 32 * 1024;
+
+// smallest chunk given to a worker: enough work to pay for a steal,
+// and it still fits in L2 while the worker goes through it
+constexpr size_t ParallelChunkBytes = 64 * 1024;
+
+
+inline bool _parallel_serial(const ThreadPool& pool, const size_t count)
+{
+	return count < ParallelSerialCutoff || !pool.IsRunning();
+}
+
+
+template<class T>
+inline size_t _parallel_chunk(const ThreadPool& pool, const size_t count)
+{
+	const size_t grain = _parallel_grain(pool, count);
+	const size_t min_elems = sizeof(T) < ParallelChunkBytes ? ParallelChunkBytes / sizeof(T) : 2;
+	return grain > min_elems ? grain : min_elems;
+}
+
+
+
+
+// out[i] = op(first[i]). out may be first, to transform in place
+template<class T, class U, class F>
+void parallel_transform(ThreadPool& pool, const T* const first, const T* const last, U* const out, F&& op)
+{
+	const size_t count = last - first;
+
+	if( _parallel_serial(pool, count) ) {
+		std::transform(first, last, out, op);
+		return;
+	}
+
+	parallel_for(pool, 0, count, [first, out, &op](const size_t begin, const size_t end) {
+		for(size_t i = begin; i < end; ++i)
+			out[i] = op(first[i]);
+	}, _parallel_chunk<T>(pool, count));
+}
+
+
+// every element of dst is written over, trivial ones aren't constructed first
+template<class U, class UA, class UG>
+inline enable_if_t<std::is_trivial<U>::value == true, 
+bool> _resize_for_overwrite(Vector<U, UA, UG>& dst, const size_t size)
+{
+	return dst.resize_uninitialized(size);
+}
+
+
+template<class U, class UA, class UG>
+inline enable_if_t<std::is_trivial<U>::value == false, 
+bool> _resize_for_overwrite(Vector<U, UA, UG>& dst, const size_t size)
+{
+	return dst.resize(size);
+}
+
+
+// resizes dst to src's size, false if it can't
+template<class T, class A, class G, class U, class UA, class UG, class F>
+bool parallel_transform(ThreadPool& pool, const Vector<T, A, G>& src, Vector<U, UA, UG>& dst, F&& op)
+{
+	if( !_resize_for_overwrite(dst, src.size()) )
+		return false;
+
+	parallel_transform(pool, src.begin(), src.end(), dst.data(), op);
+	return true;
+}
+
+
+template<class T, class A, class G, class F>
+void parallel_transform(ThreadPool& pool, Vector<T, A, G>& vec, F&& op)
+{
+	parallel_transform(pool, vec.data(), vec.data() + vec.size(), vec.data(), op);
+}
+
+
+
+
+// folds [first, last) with op(R, T) -> R, which also joins the chunk 
+// results as op(R, R) -> R, so it must be associative. 
+// 'init' must be op's identity (0 for +, 1 for *): every chunk starts from it
+template<class T, class R, class F>
+R parallel_reduce(ThreadPool& pool, const T* const first, const T* const last, R init, F&& op)
+{
+	const size_t count = last - first;
+
+	if( _parallel_serial(pool, count) )
+		return std::accumulate(first, last, std::move(init), op);
+
+	return parallel_reduce(pool, size_t(0), count, std::move(init), 
+		[first, &op](const size_t begin, const size_t end, R acc) {
+			for(size_t i = begin; i < end; ++i)
+				acc = op(std::move(acc), first[i]);
+			return acc;
+		}, op, _parallel_chunk<T>(pool, count));
+}
+
+
+template<class T, class A, class G, class R, class F>
+R parallel_reduce(ThreadPool& pool, const Vector<T, A, G>& vec, R init, F&& op)
+{
+	return parallel_reduce(pool, vec.begin(), vec.end(), std::move(init), op);
+}
+
+
+
+
+// first element that satisfies pred, or last.
+// chunks after one that already matched stop early
+template<class T, class P>
+const T* parallel_find_if(ThreadPool& pool, const T* const first, const T* const last, P&& pred)
+{
+	const size_t count = last - first;
+
+	if( _parallel_serial(pool, count) )
+		return std::find_if(first, last, pred);
+
+	std::atomic<size_t> found{count};
+
+	parallel_for(pool, 0, count, [first, &pred, &found](const size_t begin, const size_t end) {
+		for(size_t i = begin; i < end; ++i) 
+		{
+			if( (i == begin || (i % 1024) == 0) && i >= found.load(std::memory_order_relaxed) )
+				return;
+
+			if( pred(first[i]) ) {
+				size_t current = found.load(std::memory_order_relaxed);
+				while( i < current && !found.compare_exchange_weak(current, i, std::memory_order_relaxed) ) {}
+				return;
+			}
+		}
+	}, _parallel_chunk<T>(pool, count));
+
+	return first + found.load(std::memory_order_relaxed);
+}
+
+
+template<class T, class A, class G, class P>
+const T* parallel_find_if(ThreadPool& pool, const Vector<T, A, G>& vec, P&& pred)
+{
+	return parallel_find_if(pool, vec.begin(), vec.end(), pred);
+}
+
+
+template<class T>
+const T* parallel_find(ThreadPool& pool, const T* const first, const T* const last, const T& value)
+{
+	return parallel_find_if(pool, first, last, [&value](const T& elem) { return elem == value; });
+}
+
+
+template<class T, class A, class G>
+const T* parallel_find(ThreadPool& pool, const Vector<T, A, G>& vec, const T& value)
+{
+	return parallel_find(pool, vec.begin(), vec.end(), value);
+}
+
+
+
+
+// parallel_sort internals
+
+// merges [a, a_end) and [b, b_end) into out. above 'grain' elements the
+// larger run is split at its middle and the other at the matching bound,
+// and the two halves merge in parallel. grain must be at least 2
+template<class T, class C>
+void _parallel_merge(ThreadPool& pool, T* const a, T* const a_end, T* const b, T* const b_end, 
+                     T* const out, C& comp, const size_t grain)
+{
+	const size_t a_len = a_end - a;
+	const size_t b_len = b_end - b;
+
+	if( a_len + b_len <= grain ) {
+		std::merge(std::make_move_iterator(a), std::make_move_iterator(a_end),
+		           std::make_move_iterator(b), std::make_move_iterator(b_end), 
+		           out, [&comp](const T& x, const T& y) { return comp(x, y); });
+		return;
+	}
+
+	T* a_mid;
+	T* b_mid;
+
+	if( a_len >= b_len ) {
+		a_mid = a + (a_len / 2);
+		b_mid = std::lower_bound(b, b_end, *a_mid, comp);
+	} else {
+		b_mid = b + (b_len / 2);
+		a_mid = std::upper_bound(a, a_end, *b_mid, comp);
+	}
+
+	T* const out_mid = out + (a_mid - a) + (b_mid - b);
+
+	parallel_invoke(pool, 
+		[&] { _parallel_merge(pool, a, a_mid, b, b_mid, out, comp, grain); },
+		[&] { _parallel_merge(pool, a_mid, a_end, b_mid, b_end, out_mid, comp, grain); });
+}
+
+
+// the merge passes assign into the scratch buffer, so types that aren't
+// trivially copyable need live objects there: the elements are moved into
+// it and sorted from there. returns where the runs are to be sorted
+template<class T>
+inline enable_if_t<is_trivially_copyable<T>::value == true, T*> 
+_sort_buffer_construct(ThreadPool&, T* const, T* const data, const size_t, const size_t) 
+{
+	return data;
+}
+
+
+template<class T>
+inline enable_if_t<is_trivially_copyable<T>::value == true> 
+_sort_buffer_destroy(T* const, const size_t) 
+{
+}
+
+
+template<class T>
+inline enable_if_t<is_trivially_copyable<T>::value == false, T*> 
+_sort_buffer_construct(ThreadPool& pool, T* const buffer, T* const data, const size_t count, const size_t grain)
+{
+	parallel_for(pool, 0, count, [buffer, data](const size_t begin, const size_t end) {
+		for(size_t i = begin; i < end; ++i)
+			new(&buffer[i]) T(std::move(data[i]));
+	}, grain);
+
+	return buffer;
+}
+
+
+template<class T>
+inline enable_if_t<is_trivially_copyable<T>::value == false> 
+_sort_buffer_destroy(T* const buffer, const size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+		buffer[i].~T();
+}
+
+
+
+
+// unstable sort: runs of one chunk each are sorted in parallel, then merged
+// pairwise, going back and forth between the range and a scratch buffer.
+// if the buffer can't be allocated it falls back to std::sort
+template<class T, class C>
+void parallel_sort(ThreadPool& pool, T* const first, T* const last, C&& comp)
+{
+	const size_t count = last - first;
+
+	if( _parallel_serial(pool, count) ) {
+		std::sort(first, last, comp);
+		return;
+	}
+
+	T* const buffer = alloc_arr<T>(count);
+
+	if( !buffer ) {
+		LogError("Failed to allocate parallel_sort buffer of %zu elements", count);
+		std::sort(first, last, comp);
+		return;
+	}
+
+	const size_t chunk = _parallel_chunk<T>(pool, count);
+	const size_t runs = (count + chunk - 1) / chunk;
+
+	T* src = _sort_buffer_construct(pool, buffer, first, count, chunk);
+	T* dst = src == first ? buffer : first;
+
+	parallel_for(pool, 0, runs, [src, count, chunk, &comp](const size_t begin, const size_t end) {
+		for(size_t run = begin; run < end; ++run) {
+			const size_t lo = run * chunk;
+			std::sort(src + lo, src + std::min(lo + chunk, count), comp);
+		}
+	}, 1);
+
+	for(size_t width = chunk; width < count; width *= 2) 
+	{
+		const size_t pairs = (count + (2 * width) - 1) / (2 * width);
+
+		parallel_for(pool, 0, pairs, [&pool, src, dst, count, width, chunk, &comp](const size_t begin, const size_t end) {
+			for(size_t pair = begin; pair < end; ++pair) {
+				const size_t lo = pair * 2 * width;
+				const size_t mid = std::min(lo + width, count);
+				const size_t hi = std::min(lo + (2 * width), count);
+				_parallel_merge(pool, src + lo, src + mid, src + mid, src + hi, dst + lo, comp, chunk);
+			}
+		}, 1);
+
+		std::swap(src, dst);
+	}
+
+	if( src != first ) {
+		parallel_for(pool, 0, count, [src, first](const size_t begin, const size_t end) {
+			std::move(src + begin, src + end, first + begin);
+		}, chunk);
+	}
+
+	_sort_buffer_destroy(buffer, count);
+	free_arr(buffer);
+}
+
+
+template<class T>
+void parallel_sort(ThreadPool& pool, T* const first, T* const last)
+{
+	parallel_sort(pool, first, last, std::less<T>());
+}
+
+
+template<class T, class A, class G, class C>
+void parallel_sort(ThreadPool& pool, Vector<T, A, G>& vec, C&& comp)
+{
+	parallel_sort(pool, vec.data(), vec.data() + vec.size(), comp);
+}
+
+
+template<class T, class A, class G>
+void parallel_sort(ThreadPool& pool, Vector<T, A, G>& vec)
+{
+	parallel_sort(pool, vec.data(), vec.data() + vec.size(), std::less<T>());
+}
+
+
+}
+
+#endif // UTIX_ALGORITHM_H_
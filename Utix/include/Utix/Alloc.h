@@ -23,15 +23,33 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 #define UTIX_ALLOC_H_
 #include <stdlib.h>
 #include <string.h>
+#include <type_traits>
 #include "Exceptions.h"
 #include "Ints.h"
 #include "BaseTraits.h"
 #include "Assert.h"
 
+
+// arrays of at least UTIX_MMAP_THRESHOLD bytes are mapped straight from the
+// system with huge pages advice, and grown with mremap instead of copied.
+// define UTIX_MMAP_HUGETLB to ask for explicit huge pages first.
+// 0, the default, leaves every array to malloc. the CMake option sets it
+#ifndef UTIX_MMAP_THRESHOLD
+#define UTIX_MMAP_THRESHOLD 0
+#endif
+
+
 namespace utix {
 
 extern void* _alloc_arr(const size_t bytes) UTIX_NOEXCEPT_;
 extern void* _realloc_arr(void* from, const size_t bytes) UTIX_NOEXCEPT_;
+extern void _free_arr(void* block) UTIX_NOEXCEPT_;
+extern void* _alloc_arr_aligned(const size_t bytes, const size_t alignment) UTIX_NOEXCEPT_;
+extern void* _realloc_arr_aligned(void* from, const size_t bytes, const size_t alignment) UTIX_NOEXCEPT_;
+extern void _free_arr_aligned(void* block) UTIX_NOEXCEPT_;
+
+
+constexpr size_t CacheLineSize = 64;
 
 
 template<class T = uint8_t>
@@ -49,27 +67,84 @@ inline T* realloc_arr(void* from, const size_t size) {
 inline void free_arr(const void* block)
 {
 	ASSERT_MSG(block != nullptr, "attempt to free null pointer!");
-	free(((size_t*)block) - 1);
+	_free_arr(const_cast<void*>(block));
+}
+
+
+
+// aligned arrays: alignment must be a power of two.
+// arr_size works as usual, but they must be released with free_arr_aligned 
+// and resized with realloc_arr_aligned
+template<class T = uint8_t>
+inline T* alloc_arr_aligned(const size_t size, const size_t alignment) {
+	return static_cast<T*>(_alloc_arr_aligned(sizeof(T) * size, alignment));
+}
+
+
+template<class T = uint8_t>
+inline T* realloc_arr_aligned(void* from, const size_t size, const size_t alignment) {
+	return static_cast<T*>(_realloc_arr_aligned(from, sizeof(T) * size, alignment));
+}
+
+
+inline void free_arr_aligned(const void* block)
+{
+	ASSERT_MSG(block != nullptr, "attempt to free null pointer!");
+	_free_arr_aligned(const_cast<void*>(block));
 }
 
 
 
+// array allocators back containers like Vector. an allocator is a copyable
+// object, possibly holding state (like a pointer to an Arena), with:
+//   void* allocate(size_t bytes);                  nullptr on failure
+//   void* reallocate(void* from, size_t bytes);    keeps the contents, nullptr on failure
+//   void deallocate(const void* block);
+// blocks must carry the arr_size header, and a block must go back to the 
+// allocator it came from. containers move and swap allocators with their blocks.
+// see ArenaArrAlloc (Arena.h) and SlabArrAlloc (Slab.h)
+
+
+// default array allocator, goes through alloc_arr / realloc_arr / free_arr
+struct DefaultArrAlloc
+{
+	void* allocate(const size_t bytes) { return _alloc_arr(bytes); }
+	void* reallocate(void* from, const size_t bytes) { return _realloc_arr(from, bytes); }
+	void deallocate(const void* block) { free_arr(block); }
+};
+
+
+// array allocator for storage aligned to ALIGNMENT bytes, 
+// e.g. CacheLineSize or 32 for AVX loads
+template<size_t ALIGNMENT>
+struct AlignedArrAlloc
+{
+	static_assert(ALIGNMENT != 0 && (ALIGNMENT & (ALIGNMENT - 1)) == 0, "ALIGNMENT must be a power of two");
+	void* allocate(const size_t bytes) { return _alloc_arr_aligned(bytes, ALIGNMENT); }
+	void* reallocate(void* from, const size_t bytes) { return _realloc_arr_aligned(from, bytes, ALIGNMENT); }
+	void deallocate(const void* block) { free_arr_aligned(block); }
+};
+
+
+
 
 
+// element count of an alloc_arr block. only one level of pointer is
+// stripped, so arrays of pointers (T**) count pointers
 template<class T>
-inline enable_if_t<is_pointer<T>::value && !is_same<remove_all_t<T>, uint8_t>::value,
+inline enable_if_t<is_pointer<T>::value && !is_same<remove_cv_t<typename std::remove_pointer<T>::type>, uint8_t>::value,
 size_t> arr_size(const T arr)
 {
 	if(!arr)
 		return 0;
 
 	const auto size = reinterpret_cast<const size_t*>(arr) - 1;
-	return (*size) / sizeof(remove_all_t<T>);
+	return (*size) / sizeof(*arr);
 }
 
 
 template<class T>
-inline enable_if_t<is_pointer<T>::value && is_same<remove_all_t<T>, uint8_t>::value,
+inline enable_if_t<is_pointer<T>::value && is_same<remove_cv_t<typename std::remove_pointer<T>::type>, uint8_t>::value,
 size_t> arr_size(const T arr)
 {
 	if(!arr)
@@ -0,0 +1,68 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#ifndef UTIX_ALLOC_STATS_H_
+#define UTIX_ALLOC_STATS_H_
+#include <string>
+#include "Ints.h"
+
+
+namespace utix {
+
+
+// allocation counters of alloc_arr / realloc_arr / free_arr and the aligned versions.
+// only collected when built with UTIX_ALLOC_STATS. each thread counts on its own
+// and GetAllocStats merges them. live bytes are published from each thread 
+// every AllocStatsFlushBytes, so live and peak may be that much behind per thread.
+
+constexpr size_t AllocStatsBuckets = 32;
+constexpr size_t AllocStatsFlushBytes = 64 * 1024;
+
+
+struct AllocStats
+{
+	bool enabled;
+	uint64_t allocs;
+	uint64_t reallocs;
+	uint64_t frees;
+	int64_t liveBytes;
+	int64_t peakBytes;
+	// histogram[i]: allocs and reallocs to a size in [2^i, 2^(i+1)), 
+	// the last bucket takes everything above
+	uint64_t histogram[AllocStatsBuckets];
+};
+
+
+extern AllocStats GetAllocStats() noexcept;
+extern std::string AllocStatsToJson(const AllocStats& stats);
+
+
+// hooks called by Alloc.cpp when built with UTIX_ALLOC_STATS
+extern void _alloc_stats_on_alloc(const size_t bytes) noexcept;
+extern void _alloc_stats_on_realloc(const size_t oldBytes, const size_t bytes) noexcept;
+extern void _alloc_stats_on_free(const size_t bytes) noexcept;
+
+
+
+
+}
+
+
+#endif // UTIX_ALLOC_STATS_H_
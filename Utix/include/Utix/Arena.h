@@ -0,0 +1,164 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#ifndef UTIX_ARENA_H_
+#define UTIX_ARENA_H_
+#include "Ints.h"
+#include "Assert.h"
+
+
+namespace utix {
+
+
+
+// Arena: bump allocator for scratch data.
+// every block carries the same size_t header as alloc_arr,
+// so arr_size works on arena blocks. memory is only given back
+// by Reset, Rollback or Free, never call free_arr on arena blocks.
+// an Arena can start on a caller's buffer (e.g. on the stack) and
+// only goes to malloc once the buffer is full.
+class Arena
+{
+	struct Chunk
+	{
+		Chunk* next;
+		size_t size;
+		size_t used;
+		bool owned;
+	};
+
+public:
+	struct Mark
+	{
+		Chunk* chunk;
+		size_t used;
+	};
+
+	static constexpr size_t DefaultChunkSize = 64 * 1024;
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	explicit Arena(const size_t chunkSize = DefaultChunkSize) noexcept;
+	Arena(void* buffer, const size_t bufferSize, const size_t chunkSize = DefaultChunkSize) noexcept;
+	Arena(Arena&& rhs) noexcept;
+	Arena& operator=(Arena&& rhs) noexcept;
+	~Arena();
+
+	void* Alloc(const size_t bytes) noexcept;
+	void* Realloc(void* from, const size_t bytes) noexcept;
+
+	template<class T = uint8_t>
+	T* AllocArr(const size_t size) noexcept;
+	template<class T = uint8_t>
+	T* ReallocArr(void* from, const size_t size) noexcept;
+
+	Mark GetMark() const noexcept;
+	void Rollback(const Mark& mark) noexcept;
+	void Reset() noexcept;
+	void Free() noexcept;
+	void Swap(Arena& other) noexcept;
+
+private:
+	bool NextChunk(const size_t minSize) noexcept;
+
+	Chunk* _head = nullptr;
+	Chunk* _current = nullptr;
+	size_t _chunkSize;
+};
+
+
+
+// rolls the arena back to where it was on construction
+class ArenaScope
+{
+public:
+	ArenaScope(const ArenaScope&) = delete;
+	ArenaScope& operator=(const ArenaScope&) = delete;
+	explicit ArenaScope(Arena& arena) noexcept;
+	~ArenaScope();
+
+private:
+	Arena& _arena;
+	const Arena::Mark _mark;
+};
+
+
+
+
+// lets containers like Vector draw their storage from an Arena.
+// deallocate does nothing, the memory comes back with the arena.
+struct ArenaArrAlloc
+{
+	ArenaArrAlloc(Arena& arena) noexcept : arena(&arena) {}
+	void* allocate(const size_t bytes) noexcept { return arena->Alloc(bytes); }
+	void* reallocate(void* from, const size_t bytes) noexcept { return arena->Realloc(from, bytes); }
+	void deallocate(const void*) noexcept {}
+
+	Arena* arena;
+};
+
+
+
+
+
+
+template<class T>
+inline T* Arena::AllocArr(const size_t size) noexcept
+{
+	return static_cast<T*>(this->Alloc(sizeof(T) * size));
+}
+
+
+template<class T>
+inline T* Arena::ReallocArr(void* from, const size_t size) noexcept
+{
+	return static_cast<T*>(this->Realloc(from, sizeof(T) * size));
+}
+
+
+inline Arena::Mark Arena::GetMark() const noexcept
+{
+	return { _current, _current ? _current->used : 0 };
+}
+
+
+
+inline ArenaScope::ArenaScope(Arena& arena) noexcept
+	: _arena(arena),
+	_mark(arena.GetMark())
+{
+
+}
+
+
+inline ArenaScope::~ArenaScope()
+{
+	_arena.Rollback(_mark);
+}
+
+
+
+
+
+}
+
+
+#endif // UTIX_ARENA_H_
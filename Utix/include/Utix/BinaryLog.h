@@ -0,0 +1,180 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_BINARY_LOG_H_
+#define UTIX_BINARY_LOG_H_
+#include "Ints.h"
+
+
+namespace utix {
+
+
+// binary log files (see StartBinaryLog) are a BinaryLogHeader followed by
+// entries of [kind, uint16 payload size, payload], in the writer's byte order:
+//   BinaryLogFormat   uint64 id, format text. comes before the id's first record
+//   BinaryLogRecord   uint8 stream, uint64 id, uint64 time, arguments
+//   BinaryLogText     uint8 stream, uint64 time, text formatted at the call
+//   BinaryLogDropped  uint64 lines lost to full buffers
+// times are steady clock nanoseconds. the arguments follow the format's
+// conversions: '*' widths and precisions as int32, integers and pointers
+// as 64 bits, double, long double, and strings as uint16 length + bytes.
+
+constexpr char BinaryLogMagic[8] = { 'U', 'T', 'I', 'X', 'B', 'L', 'O', 'G' };
+constexpr uint32_t BinaryLogVersion = 1;
+
+struct BinaryLogHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t longDoubleSize;
+	uint64_t startTime;      // steady clock when the log started
+	uint64_t startWallTime;  // system clock at the same point
+};
+
+
+enum BinaryLogKind : uint8_t
+{
+	BinaryLogFormat = 'F',
+	BinaryLogRecord = 'R',
+	BinaryLogText = 'T',
+	BinaryLogDropped = 'D'
+};
+
+
+enum class LogArg : uint8_t
+{
+	None,        // %%
+	Int,
+	Unsigned,
+	Double,
+	LongDouble,
+	String,
+	Pointer,
+	Unsupported  // %n, wide characters, anything unknown
+};
+
+
+enum class LogLength : uint8_t
+{
+	None, Char, Short, Long, LongLong, IntMax, Size, PtrDiff, LongDouble
+};
+
+
+struct LogSpec
+{
+	LogArg arg;
+	LogLength length;
+	uint8_t stars;       // int arguments before the value, for '*' width and precision
+	bool starPrecision;  // the last star is the precision
+	int32_t precision;   // a literal precision, -1 if there is none
+	size_t size;         // characters from the '%' through the conversion
+};
+
+
+// parses the printf conversion starting at the '%' in spec
+inline LogSpec parse_log_spec(const char* const spec)
+{
+	LogSpec result { LogArg::Unsupported, LogLength::None, 0, false, -1, 0 };
+	const char* itr = spec + 1;
+
+	while( *itr == '-' || *itr == '+' || *itr == ' ' || *itr == '#' || *itr == '0' || *itr == '\'' )
+		++itr;
+
+	if( *itr == '*' ) {
+		++result.stars;
+		++itr;
+	}
+	else {
+		while( *itr >= '0' && *itr <= '9' )
+			++itr;
+	}
+
+	if( *itr == '.' ) 
+	{
+		++itr;
+		if( *itr == '*' ) {
+			++result.stars;
+			result.starPrecision = true;
+			++itr;
+		}
+		else {
+			// a lone '.' is a precision of 0, anything too long to be real is capped
+			result.precision = 0;
+			for(; *itr >= '0' && *itr <= '9'; ++itr)
+				if( result.precision < 0xfffffff )
+					result.precision = result.precision * 10 + (*itr - '0');
+		}
+	}
+
+	switch( *itr )
+	{
+	case 'h':
+		result.length = itr[1] == 'h' ? LogLength::Char : LogLength::Short;
+		itr += itr[1] == 'h' ? 2 : 1;
+		break;
+	case 'l':
+		result.length = itr[1] == 'l' ? LogLength::LongLong : LogLength::Long;
+		itr += itr[1] == 'l' ? 2 : 1;
+		break;
+	case 'j': result.length = LogLength::IntMax; ++itr; break;
+	case 'z': result.length = LogLength::Size; ++itr; break;
+	case 't': result.length = LogLength::PtrDiff; ++itr; break;
+	case 'L': result.length = LogLength::LongDouble; ++itr; break;
+	default: break;
+	}
+
+	switch( *itr )
+	{
+	case '%':
+		result.arg = LogArg::None;
+		break;
+	case 'd': case 'i':
+		result.arg = LogArg::Int;
+		break;
+	case 'u': case 'o': case 'x': case 'X':
+		result.arg = LogArg::Unsigned;
+		break;
+	case 'c':
+		result.arg = result.length == LogLength::None ? LogArg::Int : LogArg::Unsupported;
+		break;
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		result.arg = result.length == LogLength::LongDouble ? LogArg::LongDouble : LogArg::Double;
+		break;
+	case 's':
+		result.arg = result.length == LogLength::None ? LogArg::String : LogArg::Unsupported;
+		break;
+	case 'p':
+		result.arg = LogArg::Pointer;
+		break;
+	default:
+		break;
+	}
+
+	result.size = static_cast<size_t>(itr - spec) + (*itr ? 1 : 0);
+	return result;
+}
+
+
+}
+
+#endif // UTIX_BINARY_LOG_H_
@@ -21,13 +21,14 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 #ifndef UTIX_CLIOPTS_H_
 #define UTIX_CLIOPTS_H_
 #include <string>
-#include <Utix/Vector.h>
+#include <Utix/SmallVector.h>
 
 namespace utix {
 
 
 
-class CliOpts : public Vector<std::string>
+// command lines rarely pass more than a handful of arguments
+class CliOpts : public SmallVector<std::string, 16>
 {
 public:
 	CliOpts(int argc, char** argv);
@@ -0,0 +1,100 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+#ifndef UTIX_CPU_FEATURES_H_
+#define UTIX_CPU_FEATURES_H_
+#include "Ints.h"
+#include "Assert.h"
+
+
+namespace utix {
+
+
+// what the cpu (and the os, for the wide x86 registers) supports.
+// detected once, on the first get_cpu_features() call
+struct CpuFeatures
+{
+	enum Flag : uint32_t
+	{
+		// x86
+		Sse2     = 1u << 0,
+		Sse3     = 1u << 1,
+		Ssse3    = 1u << 2,
+		Sse41    = 1u << 3,
+		Sse42    = 1u << 4,
+		Popcnt   = 1u << 5,
+		Avx      = 1u << 6,
+		Avx2     = 1u << 7,
+		Fma      = 1u << 8,
+		Bmi1     = 1u << 9,
+		Bmi2     = 1u << 10,
+		Avx512F  = 1u << 11,
+		Avx512BW = 1u << 12,
+		Avx512VL = 1u << 13,
+
+		// arm
+		Neon     = 1u << 16,
+		Crc32    = 1u << 17
+	};
+
+	bool Has(const uint32_t required) const noexcept { return (flags & required) == required; }
+
+	uint32_t flags;
+	char vendor[13];  // x86 cpuid vendor, e.g. GenuineIntel. empty elsewhere
+};
+
+
+extern const CpuFeatures& get_cpu_features();
+
+// lowercase name of a single flag, e.g. "avx2"
+extern const char* get_cpu_feature_name(const uint32_t flag);
+
+
+
+
+// one implementation of T and the CpuFeatures flags it needs
+template<class T>
+struct CpuVariant
+{
+	uint32_t required;
+	const T* value;
+};
+
+
+// the first variant this cpu can run. list them best first and end with one
+// that requires nothing, e.g.
+//   static const Kernels& kernels = cpu_dispatch(variants);
+// binds a table of function pointers once, on first use
+template<class T, size_t N>
+const T& cpu_dispatch(const CpuVariant<T> (&variants)[N])
+{
+	const CpuFeatures& cpu = get_cpu_features();
+
+	for(const CpuVariant<T>& variant : variants)
+		if( cpu.Has(variant.required) )
+			return *variant.value;
+
+	ASSERT_MSG(false, "cpu_dispatch without a variant for every cpu");
+	return *variants[N - 1].value;
+}
+
+
+}
+
+#endif // UTIX_CPU_FEATURES_H_
@@ -34,6 +34,7 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 #endif
 
 #include <string>
+#include "Traits.h"
 
 namespace utix {
 
@@ -62,6 +63,12 @@ private:
 };
 
 
+// DLoader only holds a handle, Vector can realloc it.
+// declared with the class, so every Vector<DLoader> sees it
+template<>
+struct is_trivially_relocatable<DLoader> : true_type {};
+
+
 
 
 
@@ -0,0 +1,275 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_FLAT_MAP_H_
+#define UTIX_FLAT_MAP_H_
+#include "FlatTable.h"
+
+
+namespace utix {
+
+
+template<class KEY, class VALUE>
+struct FlatMapEntry
+{
+	KEY key;
+	VALUE value;
+};
+
+
+
+
+// sorted map in a contiguous Vector, for small or read-mostly tables. (see FlatTable)
+// inserts are O(n), bulk loads should go through push_unsorted and sort.
+// iteration is in key order. inserts and erases invalidate pointers to entries.
+template<class KEY, class VALUE, class LESS = Less>
+class FlatMap
+{
+public:
+	using Entry = FlatMapEntry<KEY, VALUE>;
+
+private:
+	struct KeyOf { static const KEY& get(const Entry& entry) { return entry.key; } };
+	using Table = FlatTable<KEY, Entry, KeyOf, LESS>;
+
+public:
+	FlatMap(const FlatMap&) = delete;
+	FlatMap& operator=(const FlatMap&) = delete;
+
+	FlatMap() = default;
+	FlatMap(FlatMap&&) = default;
+	FlatMap& operator=(FlatMap&&) = default;
+
+	bool empty() const;
+	size_t size() const;
+	bool reserve(const size_t count);
+	void clear();
+	void swap(FlatMap& other) noexcept;
+	void free() noexcept;
+
+	const Entry* begin() const;
+	const Entry* end() const;
+
+	template<class Q>
+	VALUE* find(const Q& key);
+	template<class Q>
+	const VALUE* find(const Q& key) const;
+	template<class Q>
+	bool contains(const Q& key) const;
+
+	// these return the key's value, or nullptr if it could not be inserted
+	VALUE* insert(KEY key, VALUE value);
+	VALUE* insert_or_assign(KEY key, VALUE value);
+	VALUE* find_or_insert(KEY key);
+
+	template<class Q>
+	bool erase(const Q& key);
+
+	bool push_unsorted(KEY key, VALUE value);
+	void sort();
+	bool freeze();
+	bool is_frozen() const;
+
+private:
+	Table _table;
+};
+
+
+
+
+
+
+
+template<class KEY, class VALUE, class LESS>
+inline bool FlatMap<KEY, VALUE, LESS>::empty() const
+{
+	return _table.empty();
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline size_t FlatMap<KEY, VALUE, LESS>::size() const
+{
+	return _table.size();
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline bool FlatMap<KEY, VALUE, LESS>::reserve(const size_t count)
+{
+	return _table.reserve(count);
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline void FlatMap<KEY, VALUE, LESS>::clear()
+{
+	_table.clear();
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline void FlatMap<KEY, VALUE, LESS>::swap(FlatMap& other) noexcept
+{
+	_table.swap(other._table);
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline void FlatMap<KEY, VALUE, LESS>::free() noexcept
+{
+	_table.free();
+}
+
+
+
+
+template<class KEY, class VALUE, class LESS>
+inline const typename FlatMap<KEY, VALUE, LESS>::Entry* FlatMap<KEY, VALUE, LESS>::begin() const
+{
+	return _table.begin();
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline const typename FlatMap<KEY, VALUE, LESS>::Entry* FlatMap<KEY, VALUE, LESS>::end() const
+{
+	return _table.end();
+}
+
+
+
+
+template<class KEY, class VALUE, class LESS>
+template<class Q>
+inline VALUE* FlatMap<KEY, VALUE, LESS>::find(const Q& key)
+{
+	Entry* const entry = _table.find(key);
+	return entry ? &entry->value : nullptr;
+}
+
+
+template<class KEY, class VALUE, class LESS>
+template<class Q>
+inline const VALUE* FlatMap<KEY, VALUE, LESS>::find(const Q& key) const
+{
+	const Entry* const entry = _table.find(key);
+	return entry ? &entry->value : nullptr;
+}
+
+
+template<class KEY, class VALUE, class LESS>
+template<class Q>
+inline bool FlatMap<KEY, VALUE, LESS>::contains(const Q& key) const
+{
+	return _table.find(key) != nullptr;
+}
+
+
+
+
+// an existing value is kept
+template<class KEY, class VALUE, class LESS>
+inline VALUE* FlatMap<KEY, VALUE, LESS>::insert(KEY key, VALUE value)
+{
+	Entry* entry = _table.lower_bound(key);
+
+	if( !_table.matches(entry, key) )
+		entry = _table.insert_at(entry, Entry{std::move(key), std::move(value)});
+
+	return entry ? &entry->value : nullptr;
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline VALUE* FlatMap<KEY, VALUE, LESS>::insert_or_assign(KEY key, VALUE value)
+{
+	Entry* entry = _table.lower_bound(key);
+
+	if( _table.matches(entry, key) )
+		entry->value = std::move(value);
+	else
+		entry = _table.insert_at(entry, Entry{std::move(key), std::move(value)});
+
+	return entry ? &entry->value : nullptr;
+}
+
+
+// a new value is value initialized
+template<class KEY, class VALUE, class LESS>
+inline VALUE* FlatMap<KEY, VALUE, LESS>::find_or_insert(KEY key)
+{
+	Entry* entry = _table.lower_bound(key);
+
+	if( !_table.matches(entry, key) )
+		entry = _table.insert_at(entry, Entry{std::move(key), VALUE()});
+
+	return entry ? &entry->value : nullptr;
+}
+
+
+
+
+template<class KEY, class VALUE, class LESS>
+template<class Q>
+inline bool FlatMap<KEY, VALUE, LESS>::erase(const Q& key)
+{
+	return _table.erase(key);
+}
+
+
+
+
+// lookups and inserts must wait for sort()
+template<class KEY, class VALUE, class LESS>
+inline bool FlatMap<KEY, VALUE, LESS>::push_unsorted(KEY key, VALUE value)
+{
+	return _table.push_unsorted(Entry{std::move(key), std::move(value)});
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline void FlatMap<KEY, VALUE, LESS>::sort()
+{
+	_table.sort();
+}
+
+
+// for the big read-only tables, any change unfreezes
+template<class KEY, class VALUE, class LESS>
+inline bool FlatMap<KEY, VALUE, LESS>::freeze()
+{
+	return _table.freeze();
+}
+
+
+template<class KEY, class VALUE, class LESS>
+inline bool FlatMap<KEY, VALUE, LESS>::is_frozen() const
+{
+	return _table.is_frozen();
+}
+
+
+}
+
+#endif // UTIX_FLAT_MAP_H_
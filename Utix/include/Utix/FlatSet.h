@@ -0,0 +1,211 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_FLAT_SET_H_
+#define UTIX_FLAT_SET_H_
+#include "FlatTable.h"
+
+
+namespace utix {
+
+
+// sorted set in a contiguous Vector, FlatMap without values. (see FlatMap)
+template<class KEY, class LESS = Less>
+class FlatSet
+{
+	struct KeyOf { static const KEY& get(const KEY& key) { return key; } };
+	using Table = FlatTable<KEY, KEY, KeyOf, LESS>;
+
+public:
+	FlatSet(const FlatSet&) = delete;
+	FlatSet& operator=(const FlatSet&) = delete;
+
+	FlatSet() = default;
+	FlatSet(FlatSet&&) = default;
+	FlatSet& operator=(FlatSet&&) = default;
+
+	bool empty() const;
+	size_t size() const;
+	bool reserve(const size_t count);
+	void clear();
+	void swap(FlatSet& other) noexcept;
+	void free() noexcept;
+
+	const KEY* begin() const;
+	const KEY* end() const;
+
+	template<class Q>
+	const KEY* find(const Q& key) const;
+	template<class Q>
+	bool contains(const Q& key) const;
+
+	// returns the key in the set, or nullptr if it could not be inserted
+	const KEY* insert(KEY key);
+
+	template<class Q>
+	bool erase(const Q& key);
+
+	bool push_unsorted(KEY key);
+	void sort();
+	bool freeze();
+	bool is_frozen() const;
+
+private:
+	Table _table;
+};
+
+
+
+
+
+
+
+template<class KEY, class LESS>
+inline bool FlatSet<KEY, LESS>::empty() const
+{
+	return _table.empty();
+}
+
+
+template<class KEY, class LESS>
+inline size_t FlatSet<KEY, LESS>::size() const
+{
+	return _table.size();
+}
+
+
+template<class KEY, class LESS>
+inline bool FlatSet<KEY, LESS>::reserve(const size_t count)
+{
+	return _table.reserve(count);
+}
+
+
+template<class KEY, class LESS>
+inline void FlatSet<KEY, LESS>::clear()
+{
+	_table.clear();
+}
+
+
+template<class KEY, class LESS>
+inline void FlatSet<KEY, LESS>::swap(FlatSet& other) noexcept
+{
+	_table.swap(other._table);
+}
+
+
+template<class KEY, class LESS>
+inline void FlatSet<KEY, LESS>::free() noexcept
+{
+	_table.free();
+}
+
+
+
+
+template<class KEY, class LESS>
+inline const KEY* FlatSet<KEY, LESS>::begin() const
+{
+	return _table.begin();
+}
+
+
+template<class KEY, class LESS>
+inline const KEY* FlatSet<KEY, LESS>::end() const
+{
+	return _table.end();
+}
+
+
+
+
+template<class KEY, class LESS>
+template<class Q>
+inline const KEY* FlatSet<KEY, LESS>::find(const Q& key) const
+{
+	return _table.find(key);
+}
+
+
+template<class KEY, class LESS>
+template<class Q>
+inline bool FlatSet<KEY, LESS>::contains(const Q& key) const
+{
+	return _table.find(key) != nullptr;
+}
+
+
+template<class KEY, class LESS>
+inline const KEY* FlatSet<KEY, LESS>::insert(KEY key)
+{
+	KEY* const pos = _table.lower_bound(key);
+
+	if( _table.matches(pos, key) )
+		return pos;
+
+	return _table.insert_at(pos, std::move(key));
+}
+
+
+template<class KEY, class LESS>
+template<class Q>
+inline bool FlatSet<KEY, LESS>::erase(const Q& key)
+{
+	return _table.erase(key);
+}
+
+
+
+
+template<class KEY, class LESS>
+inline bool FlatSet<KEY, LESS>::push_unsorted(KEY key)
+{
+	return _table.push_unsorted(std::move(key));
+}
+
+
+template<class KEY, class LESS>
+inline void FlatSet<KEY, LESS>::sort()
+{
+	_table.sort();
+}
+
+
+template<class KEY, class LESS>
+inline bool FlatSet<KEY, LESS>::freeze()
+{
+	return _table.freeze();
+}
+
+
+template<class KEY, class LESS>
+inline bool FlatSet<KEY, LESS>::is_frozen() const
+{
+	return _table.is_frozen();
+}
+
+
+}
+
+#endif // UTIX_FLAT_SET_H_
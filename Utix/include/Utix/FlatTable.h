@@ -0,0 +1,445 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_FLAT_TABLE_H_
+#define UTIX_FLAT_TABLE_H_
+#include <algorithm>
+#include <utility>
+#include "Vector.h"
+
+
+namespace utix {
+
+
+// default LESS for the flat containers, compares any two types that have operator<
+struct Less
+{
+	template<class A, class B>
+	bool operator()(const A& a, const B& b) const { return a < b; }
+};
+
+
+
+
+// entries kept sorted by key in a Vector, the storage behind FlatMap and FlatSet.
+// lookups are a branchless binary search, or a walk down an Eytzinger ordered 
+// copy of the keys once freeze() is called. any change drops that copy.
+// KEY_OF::get(entry) gives an entry's key. LESS is default constructed on use 
+// and may take other key types, for heterogeneous lookup.
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+class FlatTable
+{
+	struct Node
+	{
+		KEY key;
+		size_t index;
+	};
+
+public:
+	FlatTable(const FlatTable&) = delete;
+	FlatTable& operator=(const FlatTable&) = delete;
+
+	FlatTable() = default;
+	FlatTable(FlatTable&&) = default;
+	FlatTable& operator=(FlatTable&&) = default;
+
+	bool empty() const;
+	size_t size() const;
+	bool reserve(const size_t count);
+	void clear();
+	void swap(FlatTable& other) noexcept;
+	void free() noexcept;
+
+	ENTRY* begin();
+	ENTRY* end();
+	const ENTRY* begin() const;
+	const ENTRY* end() const;
+
+	// entries' keys must not change through the non-const pointers
+	template<class Q>
+	ENTRY* lower_bound(const Q& key);
+	template<class Q>
+	const ENTRY* lower_bound(const Q& key) const;
+	template<class Q>
+	ENTRY* find(const Q& key);
+	template<class Q>
+	const ENTRY* find(const Q& key) const;
+	template<class Q>
+	bool matches(const ENTRY* pos, const Q& key) const;
+
+	// pos must be lower_bound of entry's key
+	ENTRY* insert_at(const ENTRY* pos, ENTRY&& entry);
+	template<class Q>
+	bool erase(const Q& key);
+
+	// bulk loading: push in any order, then sort once.
+	// for equal keys the one pushed first is kept
+	bool push_unsorted(ENTRY&& entry);
+	void sort();
+	bool is_sorted() const;
+
+	// builds the Eytzinger copy of the keys, KEY must be default constructible
+	bool freeze();
+	bool is_frozen() const;
+
+private:
+	template<class Q>
+	const ENTRY* search_sorted(const Q& key) const;
+	template<class Q>
+	const ENTRY* search_eytzinger(const Q& key) const;
+	size_t fill_eytzinger(size_t node, size_t index);
+	void changed();
+
+	Vector<ENTRY> _entries;
+	Vector<Node> _layout;
+	bool _unsorted = false;
+};
+
+
+
+
+
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline bool FlatTable<KEY, ENTRY, KEY_OF, LESS>::empty() const
+{
+	return _entries.empty();
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline size_t FlatTable<KEY, ENTRY, KEY_OF, LESS>::size() const
+{
+	return _entries.size();
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline bool FlatTable<KEY, ENTRY, KEY_OF, LESS>::reserve(const size_t count)
+{
+	if( _entries.data() == nullptr )
+		return _entries.initialize(count);
+
+	return count <= _entries.capacity() || _entries.reserve(count);
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline void FlatTable<KEY, ENTRY, KEY_OF, LESS>::clear()
+{
+	_entries.clear();
+	this->changed();
+	_unsorted = false;
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline void FlatTable<KEY, ENTRY, KEY_OF, LESS>::swap(FlatTable& other) noexcept
+{
+	_entries.swap(other._entries);
+	_layout.swap(other._layout);
+	std::swap(_unsorted, other._unsorted);
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline void FlatTable<KEY, ENTRY, KEY_OF, LESS>::free() noexcept
+{
+	_entries.free();
+	_layout.free();
+	_unsorted = false;
+}
+
+
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::begin()
+{
+	return _entries.begin();
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::end()
+{
+	return _entries.end();
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline const ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::begin() const
+{
+	return _entries.begin();
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline const ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::end() const
+{
+	return _entries.end();
+}
+
+
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+template<class Q>
+inline ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::lower_bound(const Q& key)
+{
+	return const_cast<ENTRY*>(static_cast<const FlatTable*>(this)->lower_bound(key));
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+template<class Q>
+inline const ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::lower_bound(const Q& key) const
+{
+	ASSERT_MSG(!_unsorted, "FlatTable lookup before sort()");
+
+	if( !_layout.empty() )
+		return this->search_eytzinger(key);
+
+	return this->search_sorted(key);
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+template<class Q>
+inline ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::find(const Q& key)
+{
+	return const_cast<ENTRY*>(static_cast<const FlatTable*>(this)->find(key));
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+template<class Q>
+inline const ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::find(const Q& key) const
+{
+	const ENTRY* const pos = this->lower_bound(key);
+	return this->matches(pos, key) ? pos : nullptr;
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+template<class Q>
+inline bool FlatTable<KEY, ENTRY, KEY_OF, LESS>::matches(const ENTRY* const pos, const Q& key) const
+{
+	return pos != this->end() && !LESS()(key, KEY_OF::get(*pos));
+}
+
+
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::insert_at(const ENTRY* const pos, ENTRY&& entry)
+{
+	ASSERT_MSG(!_unsorted, "FlatTable insert before sort()");
+
+	const size_t index = static_cast<size_t>(pos - _entries.begin());
+
+	if( !_entries.insert(pos, std::move(entry)) )
+		return nullptr;
+
+	this->changed();
+	return _entries.begin() + index;
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+template<class Q>
+inline bool FlatTable<KEY, ENTRY, KEY_OF, LESS>::erase(const Q& key)
+{
+	ENTRY* const pos = this->find(key);
+
+	if( !pos )
+		return false;
+
+	_entries.erase(pos);
+	this->changed();
+	return true;
+}
+
+
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline bool FlatTable<KEY, ENTRY, KEY_OF, LESS>::push_unsorted(ENTRY&& entry)
+{
+	if( _entries.data() == nullptr && !_entries.initialize() )
+		return false;
+
+	if( !_entries.push_back(std::move(entry)) )
+		return false;
+
+	this->changed();
+	_unsorted = true;
+	return true;
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+void FlatTable<KEY, ENTRY, KEY_OF, LESS>::sort()
+{
+	if( !_unsorted )
+		return;
+
+	const auto less = [](const ENTRY& a, const ENTRY& b) { 
+		return LESS()(KEY_OF::get(a), KEY_OF::get(b)); 
+	};
+
+	// stable, so the first of equal keys stays in front and survives
+	std::stable_sort(_entries.begin(), _entries.end(), less);
+
+	ENTRY* const first = _entries.begin();
+	ENTRY* const last = _entries.end();
+	ENTRY* kept = first;
+
+	for(ENTRY* itr = first; itr != last; ++itr)
+	{
+		if( itr != first && !less(*(kept - 1), *itr) )
+			continue;
+
+		if( kept != itr )
+			*kept = std::move(*itr);
+
+		++kept;
+	}
+
+	_entries.erase(kept, last);
+	_unsorted = false;
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline bool FlatTable<KEY, ENTRY, KEY_OF, LESS>::is_sorted() const
+{
+	return !_unsorted;
+}
+
+
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+bool FlatTable<KEY, ENTRY, KEY_OF, LESS>::freeze()
+{
+	ASSERT_MSG(!_unsorted, "FlatTable freeze before sort()");
+
+	const size_t count = _entries.size();
+
+	if( count == 0 )
+		return true;
+
+	// slot 0 is unused, children of k are 2k and 2k+1
+	if( !_layout.initialize(count + 1) || !_layout.resize(count + 1) )
+		return false;
+
+	this->fill_eytzinger(1, 0);
+	return true;
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline bool FlatTable<KEY, ENTRY, KEY_OF, LESS>::is_frozen() const
+{
+	return !_layout.empty();
+}
+
+
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+template<class Q>
+const ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::search_sorted(const Q& key) const
+{
+	const ENTRY* base = _entries.begin();
+	size_t count = _entries.size();
+
+	if( count == 0 )
+		return base;
+
+	// the compare picks the half with a conditional move, not a branch
+	while( count > 1 )
+	{
+		const size_t half = count / 2;
+		base = LESS()(KEY_OF::get(base[half - 1]), key) ? base + half : base;
+		count -= half;
+	}
+
+	return base + LESS()(KEY_OF::get(*base), key);
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+template<class Q>
+const ENTRY* FlatTable<KEY, ENTRY, KEY_OF, LESS>::search_eytzinger(const Q& key) const
+{
+	const Node* const nodes = _layout.data();
+	const size_t count = _layout.size() - 1;
+	size_t node = 1;
+
+	// top levels of the tree share cache lines, the path down is branch free
+	while( node <= count )
+		node = (node * 2) + LESS()(nodes[node].key, key);
+
+	// drop the right turns taken after the last left turn, that node is the answer
+	while( node & 1 )
+		node >>= 1;
+
+	node >>= 1;
+
+	if( node == 0 )
+		return this->end();
+
+	return _entries.begin() + nodes[node].index;
+}
+
+
+// in-order walk of the implicit tree hands out the sorted keys
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+size_t FlatTable<KEY, ENTRY, KEY_OF, LESS>::fill_eytzinger(const size_t node, size_t index)
+{
+	if( node < _layout.size() )
+	{
+		index = this->fill_eytzinger(node * 2, index);
+		_layout[node].key = KEY_OF::get(_entries[index]);
+		_layout[node].index = index;
+		index = this->fill_eytzinger((node * 2) + 1, index + 1);
+	}
+
+	return index;
+}
+
+
+template<class KEY, class ENTRY, class KEY_OF, class LESS>
+inline void FlatTable<KEY, ENTRY, KEY_OF, LESS>::changed()
+{
+	if( !_layout.empty() )
+		_layout.free();
+}
+
+
+}
+
+#endif // UTIX_FLAT_TABLE_H_
@@ -0,0 +1,179 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_FORMAT_H_
+#define UTIX_FORMAT_H_
+#include <string.h>
+#include <string>
+#include "Ints.h"
+
+
+namespace utix {
+
+
+// Vector.h includes Log.h, which includes this
+template<class TYPE, class ALLOC, class GROWTH>
+class Vector;
+
+
+// type safe formatting. '{}' takes the next argument, '{{' and '}}' are braces.
+// a placeholder may hold a spec, {:[[fill]align][+][#][0][width][.precision][type]}
+//   align  < left, > right, ^ center. numbers go right, the rest left
+//   type   d x X o b c for integers, f e g (F E G) for floating point, s, p
+// floating point without a type or precision prints the shortest text that
+// reads back as the same value (Grisu3, printf's exact rounding for the few values
+// it can't settle), the rest goes through snprintf's rounding.
+// arguments are checked by type at compile time, the string is parsed in one pass
+// at run time. missing arguments print as '{}', extra ones are ignored.
+// long double prints as double
+
+struct FormatString
+{
+	const char* str;
+	size_t size;
+};
+
+
+namespace literals
+{
+	constexpr FormatString operator"" _fmt(const char* str, size_t size) { return FormatString { str, size }; }
+}
+
+
+// one type erased argument, made by the Format functions
+class FormatArg
+{
+public:
+	enum class Type : uint8_t { Bool, Char, Int, Uint, Float, Double, String, Pointer };
+
+	FormatArg(const bool value) : _type(Type::Bool) { _value.u = value; }
+	FormatArg(const char value) : _type(Type::Char) { _value.i = value; }
+	FormatArg(const signed char value) : _type(Type::Int) { _value.i = value; }
+	FormatArg(const short value) : _type(Type::Int) { _value.i = value; }
+	FormatArg(const int value) : _type(Type::Int) { _value.i = value; }
+	FormatArg(const long value) : _type(Type::Int) { _value.i = value; }
+	FormatArg(const long long value) : _type(Type::Int) { _value.i = value; }
+	FormatArg(const unsigned char value) : _type(Type::Uint) { _value.u = value; }
+	FormatArg(const unsigned short value) : _type(Type::Uint) { _value.u = value; }
+	FormatArg(const unsigned value) : _type(Type::Uint) { _value.u = value; }
+	FormatArg(const unsigned long value) : _type(Type::Uint) { _value.u = value; }
+	FormatArg(const unsigned long long value) : _type(Type::Uint) { _value.u = value; }
+	FormatArg(const float value) : _type(Type::Float) { _value.f = value; }
+	FormatArg(const double value) : _type(Type::Double) { _value.d = value; }
+	FormatArg(const long double value) : _type(Type::Double) { _value.d = static_cast<double>(value); }
+	FormatArg(const char* const value) : _type(Type::String) { _value.s = value; _size = value ? strlen(value) : 0; }
+	FormatArg(const std::string& value) : _type(Type::String) { _value.s = value.data(); _size = value.size(); }
+
+	template<class T>
+	FormatArg(const T* const value) : _type(Type::Pointer) { _value.p = value; }
+
+	Type GetType() const { return _type; }
+	bool GetBool() const { return _value.u != 0; }
+	int64_t GetInt() const { return _value.i; }
+	uint64_t GetUint() const { return _value.u; }
+	float GetFloat() const { return _value.f; }
+	double GetDouble() const { return _value.d; }
+	const char* GetString() const { return _value.s ? _value.s : "(null)"; }
+	size_t GetStringSize() const { return _value.s ? _size : 6; }
+	const void* GetPointer() const { return _value.p; }
+
+private:
+	union
+	{
+		int64_t i;
+		uint64_t u;
+		float f;
+		double d;
+		const char* s;
+		const void* p;
+	} _value;
+	size_t _size = 0;
+	Type _type;
+};
+
+
+// snprintf-like: writes at most size - 1 chars and a '\0', returns the full length
+extern size_t format_args(char* buffer, const size_t size, const FormatString fmt, 
+                          const FormatArg* args, const size_t count) noexcept;
+
+// shortest round trip text of value, no '\0'. returns the length, at most FloatCharsMax
+constexpr size_t FloatCharsMax = 32;
+extern size_t format_shortest(char* buffer, const double value) noexcept;
+extern size_t format_shortest(char* buffer, const float value) noexcept;
+
+
+
+
+template<class ...Args>
+inline size_t FormatTo(char* const buffer, const size_t size, const FormatString fmt, const Args& ...args) noexcept
+{
+	const FormatArg argArray[sizeof...(Args) + 1] = { FormatArg(args)..., FormatArg(0) };
+	return format_args(buffer, size, fmt, argArray, sizeof...(Args));
+}
+
+
+template<size_t N, class ...Args>
+inline size_t FormatTo(char(&buffer)[N], const FormatString fmt, const Args& ...args) noexcept
+{
+	return FormatTo(buffer, N, fmt, args...);
+}
+
+
+// appends to out, false if it can't grow
+template<class ALLOC, class GROWTH, class ...Args>
+inline bool FormatTo(Vector<char, ALLOC, GROWTH>& out, const FormatString fmt, const Args& ...args)
+{
+	const FormatArg argArray[sizeof...(Args) + 1] = { FormatArg(args)..., FormatArg(0) };
+	const size_t used = out.size();
+	const size_t room = out.capacity() - used;
+	const size_t len = format_args(out.end(), room, fmt, argArray, sizeof...(Args));
+
+	if( len >= room ) {
+		if( !out.reserve(used + len + 1) )
+			return false;
+		format_args(out.end(), len + 1, fmt, argArray, sizeof...(Args));
+	}
+
+	return out.resize_uninitialized(used + len);
+}
+
+
+template<class ...Args>
+inline std::string Format(const FormatString fmt, const Args& ...args)
+{
+	const FormatArg argArray[sizeof...(Args) + 1] = { FormatArg(args)..., FormatArg(0) };
+	char stackBuffer[256];
+	const size_t len = format_args(stackBuffer, sizeof(stackBuffer), fmt, argArray, sizeof...(Args));
+	if( len < sizeof(stackBuffer) )
+		return std::string(stackBuffer, len);
+
+	std::string result(len + 1, '\0');
+	format_args(&result[0], len + 1, fmt, argArray, sizeof...(Args));
+	result.resize(len);
+	return result;
+}
+
+
+}
+
+#endif // UTIX_FORMAT_H_
@@ -0,0 +1,60 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_FUTEX_H_
+#define UTIX_FUTEX_H_
+#include <atomic>
+#include "Ints.h"
+
+
+namespace utix {
+
+
+// tells the cpu this is a spin-wait loop
+inline void cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+
+// sleeps while *word == expected, until a wake on the same word.
+// may return early for no reason, callers recheck their condition.
+// linux: futex, windows: WaitOnAddress, apple: __ulock_wait,
+// elsewhere a condition variable shared by the words hashing to its bucket.
+extern void futex_wait(std::atomic<uint32_t>* word, const uint32_t expected);
+
+// futex_wait that also returns after about timeoutUs microseconds
+extern void futex_wait_for(std::atomic<uint32_t>* word, const uint32_t expected, const uint32_t timeoutUs);
+
+// wakes up to 'count' threads waiting on word
+extern void futex_wake(std::atomic<uint32_t>* word, const int count);
+extern void futex_wake_all(std::atomic<uint32_t>* word);
+
+
+}
+
+#endif // UTIX_FUTEX_H_
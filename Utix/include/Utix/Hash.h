@@ -0,0 +1,97 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_HASH_H_
+#define UTIX_HASH_H_
+#include <string.h>
+#include <functional>
+#include <string>
+#include "Ints.h"
+
+
+namespace utix {
+
+
+// fast non-cryptographic hash of a byte range, 8 bytes per step
+inline size_t hash_bytes(const void* data, const size_t len)
+{
+	constexpr uint64_t mul = 0x9E3779B97F4A7C15ull;
+	const auto* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = len * mul;
+	size_t left = len;
+
+	for( ; left >= 8; left -= 8, bytes += 8) 
+	{
+		uint64_t word;
+		memcpy(&word, bytes, 8);
+		hash = (hash ^ word) * mul;
+		hash ^= hash >> 29;
+	}
+
+	if( left ) 
+	{
+		uint64_t word = 0;
+		memcpy(&word, bytes, left);
+		hash = (hash ^ word) * mul;
+	}
+
+	hash ^= hash >> 32;
+	hash *= mul;
+	hash ^= hash >> 29;
+	return static_cast<size_t>(hash);
+}
+
+
+
+
+// default HASH for utix's hash containers. 
+// HashMap and HashSet mix the result, so identity hashes are fine.
+template<class T>
+struct Hash
+{
+	size_t operator()(const T& value) const { return std::hash<T>()(value); }
+};
+
+
+// strings can be looked up by std::string or by C string without a copy
+template<>
+struct Hash<std::string>
+{
+	size_t operator()(const std::string& str) const { return hash_bytes(str.data(), str.size()); }
+	size_t operator()(const char* const str) const { return hash_bytes(str, strlen(str)); }
+};
+
+
+
+
+// default EQUAL, compares any two types that have operator==
+struct EqualTo
+{
+	template<class A, class B>
+	bool operator()(const A& a, const B& b) const { return a == b; }
+};
+
+
+}
+
+#endif // UTIX_HASH_H_
@@ -0,0 +1,250 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_HASH_MAP_H_
+#define UTIX_HASH_MAP_H_
+#include "HashTable.h"
+
+
+namespace utix {
+
+
+template<class KEY, class VALUE>
+struct HashMapEntry
+{
+	KEY key;
+	VALUE value;
+};
+
+
+
+
+// flat hash map over a single alloc_arr block. (see HashTable)
+// lookups take any key type HASH and EQUAL accept, e.g. a const char* for std::string keys.
+// inserts and erases invalidate pointers to entries. ready to use after construction.
+template<class KEY, class VALUE, class HASH = Hash<KEY>, class EQUAL = EqualTo>
+class HashMap
+{
+public:
+	using Entry = HashMapEntry<KEY, VALUE>;
+
+private:
+	struct KeyOf { static const KEY& get(const Entry& entry) { return entry.key; } };
+	using Table = HashTable<Entry, KeyOf, HASH, EQUAL>;
+
+public:
+	// iteration is const like FlatMap's, values change through find
+	using Iterator = typename Table::ConstIterator;
+	using ConstIterator = Iterator;
+
+	HashMap(const HashMap&) = delete;
+	HashMap& operator=(const HashMap&) = delete;
+
+	HashMap() = default;
+	HashMap(HashMap&&) = default;
+	HashMap& operator=(HashMap&&) = default;
+
+	bool empty() const;
+	size_t size() const;
+	size_t capacity() const;
+	bool reserve(const size_t count);
+	void clear();
+	void swap(HashMap& other) noexcept;
+	void free() noexcept;
+
+	Iterator begin() const;
+	Iterator end() const;
+
+	template<class Q>
+	VALUE* find(const Q& key);
+	template<class Q>
+	const VALUE* find(const Q& key) const;
+	template<class Q>
+	bool contains(const Q& key) const;
+
+	// these return the key's value, or nullptr if it could not be inserted
+	VALUE* insert(KEY key, VALUE value);
+	VALUE* insert_or_assign(KEY key, VALUE value);
+	VALUE* find_or_insert(KEY key);
+
+	template<class Q>
+	bool erase(const Q& key);
+
+private:
+	Table _table;
+};
+
+
+
+
+
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline bool HashMap<KEY, VALUE, HASH, EQUAL>::empty() const
+{
+	return _table.empty();
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline size_t HashMap<KEY, VALUE, HASH, EQUAL>::size() const
+{
+	return _table.size();
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline size_t HashMap<KEY, VALUE, HASH, EQUAL>::capacity() const
+{
+	return _table.capacity();
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline bool HashMap<KEY, VALUE, HASH, EQUAL>::reserve(const size_t count)
+{
+	return _table.reserve(count);
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline void HashMap<KEY, VALUE, HASH, EQUAL>::clear()
+{
+	_table.clear();
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline void HashMap<KEY, VALUE, HASH, EQUAL>::swap(HashMap& other) noexcept
+{
+	_table.swap(other._table);
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline void HashMap<KEY, VALUE, HASH, EQUAL>::free() noexcept
+{
+	_table.free();
+}
+
+
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline typename HashMap<KEY, VALUE, HASH, EQUAL>::Iterator HashMap<KEY, VALUE, HASH, EQUAL>::begin() const
+{
+	return _table.begin();
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline typename HashMap<KEY, VALUE, HASH, EQUAL>::Iterator HashMap<KEY, VALUE, HASH, EQUAL>::end() const
+{
+	return _table.end();
+}
+
+
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+template<class Q>
+inline VALUE* HashMap<KEY, VALUE, HASH, EQUAL>::find(const Q& key)
+{
+	Entry* const entry = _table.find(key);
+	return entry ? &entry->value : nullptr;
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+template<class Q>
+inline const VALUE* HashMap<KEY, VALUE, HASH, EQUAL>::find(const Q& key) const
+{
+	const Entry* const entry = _table.find(key);
+	return entry ? &entry->value : nullptr;
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+template<class Q>
+inline bool HashMap<KEY, VALUE, HASH, EQUAL>::contains(const Q& key) const
+{
+	return _table.find(key) != nullptr;
+}
+
+
+
+
+// an existing value is kept
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline VALUE* HashMap<KEY, VALUE, HASH, EQUAL>::insert(KEY key, VALUE value)
+{
+	Entry* entry = _table.find(key);
+
+	if( !entry )
+		entry = _table.insert_new(Entry{std::move(key), std::move(value)});
+
+	return entry ? &entry->value : nullptr;
+}
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline VALUE* HashMap<KEY, VALUE, HASH, EQUAL>::insert_or_assign(KEY key, VALUE value)
+{
+	Entry* entry = _table.find(key);
+
+	if( entry )
+		entry->value = std::move(value);
+	else
+		entry = _table.insert_new(Entry{std::move(key), std::move(value)});
+
+	return entry ? &entry->value : nullptr;
+}
+
+
+// a new value is value initialized
+template<class KEY, class VALUE, class HASH, class EQUAL>
+inline VALUE* HashMap<KEY, VALUE, HASH, EQUAL>::find_or_insert(KEY key)
+{
+	Entry* entry = _table.find(key);
+
+	if( !entry )
+		entry = _table.insert_new(Entry{std::move(key), VALUE()});
+
+	return entry ? &entry->value : nullptr;
+}
+
+
+
+
+template<class KEY, class VALUE, class HASH, class EQUAL>
+template<class Q>
+inline bool HashMap<KEY, VALUE, HASH, EQUAL>::erase(const Q& key)
+{
+	return _table.erase(key);
+}
+
+
+}
+
+#endif // UTIX_HASH_MAP_H_
@@ -0,0 +1,184 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_HASH_SET_H_
+#define UTIX_HASH_SET_H_
+#include "HashTable.h"
+
+
+namespace utix {
+
+
+// flat hash set, HashMap without values. (see HashMap)
+template<class KEY, class HASH = Hash<KEY>, class EQUAL = EqualTo>
+class HashSet
+{
+	struct KeyOf { static const KEY& get(const KEY& key) { return key; } };
+	using Table = HashTable<KEY, KeyOf, HASH, EQUAL>;
+
+public:
+	// keys never change in place, every iterator is const
+	using Iterator = typename Table::ConstIterator;
+	using ConstIterator = Iterator;
+
+	HashSet(const HashSet&) = delete;
+	HashSet& operator=(const HashSet&) = delete;
+
+	HashSet() = default;
+	HashSet(HashSet&&) = default;
+	HashSet& operator=(HashSet&&) = default;
+
+	bool empty() const;
+	size_t size() const;
+	size_t capacity() const;
+	bool reserve(const size_t count);
+	void clear();
+	void swap(HashSet& other) noexcept;
+	void free() noexcept;
+
+	Iterator begin() const;
+	Iterator end() const;
+
+	template<class Q>
+	const KEY* find(const Q& key) const;
+	template<class Q>
+	bool contains(const Q& key) const;
+
+	// returns the key in the set, or nullptr if it could not be inserted
+	const KEY* insert(KEY key);
+
+	template<class Q>
+	bool erase(const Q& key);
+
+private:
+	Table _table;
+};
+
+
+
+
+
+
+
+template<class KEY, class HASH, class EQUAL>
+inline bool HashSet<KEY, HASH, EQUAL>::empty() const
+{
+	return _table.empty();
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+inline size_t HashSet<KEY, HASH, EQUAL>::size() const
+{
+	return _table.size();
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+inline size_t HashSet<KEY, HASH, EQUAL>::capacity() const
+{
+	return _table.capacity();
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+inline bool HashSet<KEY, HASH, EQUAL>::reserve(const size_t count)
+{
+	return _table.reserve(count);
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+inline void HashSet<KEY, HASH, EQUAL>::clear()
+{
+	_table.clear();
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+inline void HashSet<KEY, HASH, EQUAL>::swap(HashSet& other) noexcept
+{
+	_table.swap(other._table);
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+inline void HashSet<KEY, HASH, EQUAL>::free() noexcept
+{
+	_table.free();
+}
+
+
+
+
+template<class KEY, class HASH, class EQUAL>
+inline typename HashSet<KEY, HASH, EQUAL>::Iterator HashSet<KEY, HASH, EQUAL>::begin() const
+{
+	return _table.begin();
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+inline typename HashSet<KEY, HASH, EQUAL>::Iterator HashSet<KEY, HASH, EQUAL>::end() const
+{
+	return _table.end();
+}
+
+
+
+
+template<class KEY, class HASH, class EQUAL>
+template<class Q>
+inline const KEY* HashSet<KEY, HASH, EQUAL>::find(const Q& key) const
+{
+	return _table.find(key);
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+template<class Q>
+inline bool HashSet<KEY, HASH, EQUAL>::contains(const Q& key) const
+{
+	return _table.find(key) != nullptr;
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+inline const KEY* HashSet<KEY, HASH, EQUAL>::insert(KEY key)
+{
+	const KEY* const found = _table.find(key);
+	return found ? found : _table.insert_new(std::move(key));
+}
+
+
+template<class KEY, class HASH, class EQUAL>
+template<class Q>
+inline bool HashSet<KEY, HASH, EQUAL>::erase(const Q& key)
+{
+	return _table.erase(key);
+}
+
+
+}
+
+#endif // UTIX_HASH_SET_H_
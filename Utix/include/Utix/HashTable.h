@@ -0,0 +1,469 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_HASH_TABLE_H_
+#define UTIX_HASH_TABLE_H_
+#include <string.h>
+#include <utility>
+#include "Ints.h"
+#include "Alloc.h"
+#include "Assert.h"
+#include "Log.h"
+#include "Hash.h"
+
+
+namespace utix {
+
+
+// open addressing table with Robin Hood probing, the storage behind HashMap and HashSet.
+// probe distances and entries share one alloc_arr block, slots are a power of two.
+// erase shifts the following entries back, so there are no tombstones.
+// KEY_OF::get(entry) gives an entry's key. HASH and EQUAL are default constructed 
+// on use and may take other key types, for heterogeneous lookup. (see Hash.h)
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+class HashTable
+{
+	using Dist = uint16_t;
+	static constexpr size_t Npos = ~size_t(0);
+	static constexpr size_t MinSlots = 8;
+	static constexpr size_t DistLimit = 0xFFF0;
+
+	// _alloc_arr blocks are only aligned for a size_t
+	static constexpr size_t EntryAlign = alignof(ENTRY);
+	static constexpr bool OverAligned = EntryAlign > alignof(size_t);
+
+public:
+	// iteration only hands out const entries, their keys place them
+	class ConstIterator
+	{
+	public:
+		ConstIterator(const HashTable* table, size_t slot) : _table(table), _slot(slot) { skip(); }
+		const ENTRY& operator*() const { return _table->_entries[_slot]; }
+		const ENTRY* operator->() const { return &_table->_entries[_slot]; }
+		ConstIterator& operator++() { ++_slot; skip(); return *this; }
+		bool operator==(const ConstIterator& other) const { return _slot == other._slot; }
+		bool operator!=(const ConstIterator& other) const { return _slot != other._slot; }
+
+	private:
+		void skip() { while( _slot < _table->_slots && _table->_dists[_slot] == 0 ) ++_slot; }
+		const HashTable* _table;
+		size_t _slot;
+	};
+
+
+	HashTable(const HashTable&) = delete;
+	HashTable& operator=(const HashTable&) = delete;
+
+	HashTable() = default;
+	HashTable(HashTable&& other) noexcept;
+	~HashTable();
+	HashTable& operator=(HashTable&& other) noexcept;
+
+	bool empty() const;
+	size_t size() const;
+	size_t capacity() const;
+	bool reserve(const size_t count);
+	void clear();
+	void swap(HashTable& other) noexcept;
+	void free() noexcept;
+
+	ConstIterator begin() const;
+	ConstIterator end() const;
+
+	// the entry's key must not change through the non-const pointer
+	template<class Q>
+	ENTRY* find(const Q& key);
+	template<class Q>
+	const ENTRY* find(const Q& key) const;
+
+	// entry's key must not be in the table yet, nullptr on failure
+	ENTRY* insert_new(ENTRY&& entry);
+
+	template<class Q>
+	bool erase(const Q& key);
+
+private:
+	size_t home(const size_t hash) const;
+	size_t next(const size_t slot) const;
+	bool probe_fits(size_t slot) const;
+	size_t place(ENTRY&& entry, size_t slot);
+	bool rehash(const size_t slots);
+	static void free_block(void* block);
+
+	ENTRY* _entries = nullptr;
+	Dist* _dists = nullptr;
+	size_t _size = 0;
+	size_t _slots = 0;
+	unsigned _shift = 0;
+};
+
+
+
+
+
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline HashTable<ENTRY, KEY_OF, HASH, EQUAL>::HashTable(HashTable&& other) noexcept
+{
+	this->swap(other);
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline HashTable<ENTRY, KEY_OF, HASH, EQUAL>::~HashTable()
+{
+	this->free();
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline HashTable<ENTRY, KEY_OF, HASH, EQUAL>& HashTable<ENTRY, KEY_OF, HASH, EQUAL>::operator=(HashTable&& other) noexcept
+{
+	this->swap(other);
+	return *this;
+}
+
+
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline bool HashTable<ENTRY, KEY_OF, HASH, EQUAL>::empty() const
+{
+	return _size == 0;
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline size_t HashTable<ENTRY, KEY_OF, HASH, EQUAL>::size() const
+{
+	return _size;
+}
+
+
+// entries that fit before the next rehash
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline size_t HashTable<ENTRY, KEY_OF, HASH, EQUAL>::capacity() const
+{
+	return _slots - (_slots / 8);
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+bool HashTable<ENTRY, KEY_OF, HASH, EQUAL>::reserve(const size_t count)
+{
+	size_t slots = _slots > MinSlots ? _slots : MinSlots;
+
+	while( slots - (slots / 8) < count )
+	{
+		if( slots > (Npos / 2) / sizeof(ENTRY) ) {
+			LogError("Can't reserve %zu entries in HashTable", count);
+			return false;
+		}
+
+		slots *= 2;
+	}
+
+	return slots == _slots || this->rehash(slots);
+}
+
+
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+void HashTable<ENTRY, KEY_OF, HASH, EQUAL>::clear()
+{
+	for(size_t i = 0; i < _slots; ++i)
+	{
+		if( _dists[i] ) {
+			_entries[i].~ENTRY();
+			_dists[i] = 0;
+		}
+	}
+
+	_size = 0;
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline void HashTable<ENTRY, KEY_OF, HASH, EQUAL>::swap(HashTable& other) noexcept
+{
+	std::swap(_entries, other._entries);
+	std::swap(_dists, other._dists);
+	std::swap(_size, other._size);
+	std::swap(_slots, other._slots);
+	std::swap(_shift, other._shift);
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline void HashTable<ENTRY, KEY_OF, HASH, EQUAL>::free() noexcept
+{
+	if( _entries )
+	{
+		this->clear();
+		free_block(_dists);
+		_entries = nullptr;
+		_dists = nullptr;
+		_slots = 0;
+		_shift = 0;
+	}
+}
+
+
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline typename HashTable<ENTRY, KEY_OF, HASH, EQUAL>::ConstIterator HashTable<ENTRY, KEY_OF, HASH, EQUAL>::begin() const
+{
+	return ConstIterator(this, 0);
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline typename HashTable<ENTRY, KEY_OF, HASH, EQUAL>::ConstIterator HashTable<ENTRY, KEY_OF, HASH, EQUAL>::end() const
+{
+	return ConstIterator(this, _slots);
+}
+
+
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+template<class Q>
+inline ENTRY* HashTable<ENTRY, KEY_OF, HASH, EQUAL>::find(const Q& key)
+{
+	return const_cast<ENTRY*>(static_cast<const HashTable*>(this)->find(key));
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+template<class Q>
+inline const ENTRY* HashTable<ENTRY, KEY_OF, HASH, EQUAL>::find(const Q& key) const
+{
+	if( _size == 0 )
+		return nullptr;
+
+	size_t slot = this->home(HASH()(key));
+
+	// a key's probe ends at the first entry closer to its own home
+	for(size_t dist = 1; _dists[slot] >= dist; ++dist)
+	{
+		if( _dists[slot] == dist && EQUAL()(KEY_OF::get(_entries[slot]), key) )
+			return &_entries[slot];
+
+		slot = this->next(slot);
+	}
+
+	return nullptr;
+}
+
+
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+ENTRY* HashTable<ENTRY, KEY_OF, HASH, EQUAL>::insert_new(ENTRY&& entry)
+{
+	if( (_size + 1) > this->capacity() )
+		if( !this->reserve(_size + 1) )
+			return nullptr;
+
+	const size_t hash = HASH()(KEY_OF::get(entry));
+
+	while( !this->probe_fits(this->home(hash)) )
+	{
+		// more slots don't help when the hashes themselves collide
+		if( _size < (_slots / 4) ) {
+			LogError("HashTable probe too long, HASH is colliding");
+			return nullptr;
+		}
+
+		if( !this->rehash(_slots * 2) )
+			return nullptr;
+	}
+
+	const size_t slot = this->place(std::move(entry), this->home(hash));
+	++_size;
+	return &_entries[slot];
+}
+
+
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+template<class Q>
+bool HashTable<ENTRY, KEY_OF, HASH, EQUAL>::erase(const Q& key)
+{
+	ENTRY* const entry = this->find(key);
+
+	if( !entry )
+		return false;
+
+	size_t slot = static_cast<size_t>(entry - _entries);
+	entry->~ENTRY();
+
+	// pull back the entries that were pushed away from their homes
+	for(size_t from = this->next(slot); _dists[from] > 1; from = this->next(from))
+	{
+		new(&_entries[slot]) ENTRY(std::move(_entries[from]));
+		_entries[from].~ENTRY();
+		_dists[slot] = static_cast<Dist>(_dists[from] - 1);
+		slot = from;
+	}
+
+	_dists[slot] = 0;
+	--_size;
+	return true;
+}
+
+
+
+
+// fibonacci hashing: the top bits of hash * 2^64/phi, so weak hashes still spread
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline size_t HashTable<ENTRY, KEY_OF, HASH, EQUAL>::home(const size_t hash) const
+{
+	return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> _shift);
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline size_t HashTable<ENTRY, KEY_OF, HASH, EQUAL>::next(const size_t slot) const
+{
+	return (slot + 1) & (_slots - 1);
+}
+
+
+
+
+// walks the displacement chain place() would do, without moving anything
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+bool HashTable<ENTRY, KEY_OF, HASH, EQUAL>::probe_fits(size_t slot) const
+{
+	for(size_t dist = 1; _dists[slot] != 0; slot = this->next(slot))
+	{
+		if( _dists[slot] < dist )
+			dist = _dists[slot];
+
+		if( ++dist >= DistLimit )
+			return false;
+	}
+
+	return true;
+}
+
+
+
+
+// Robin Hood: an entry takes the slot of any entry closer to its home,
+// which then carries on probing. starts at entry's home, returns where it ended up
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+size_t HashTable<ENTRY, KEY_OF, HASH, EQUAL>::place(ENTRY&& entry, size_t slot)
+{
+	size_t placed = Npos;
+	Dist dist = 1;
+	ENTRY carry(std::move(entry));
+
+	for(;;)
+	{
+		if( _dists[slot] == 0 )
+		{
+			new(&_entries[slot]) ENTRY(std::move(carry));
+			_dists[slot] = dist;
+			return placed != Npos ? placed : slot;
+		}
+
+		if( _dists[slot] < dist )
+		{
+			std::swap(carry, _entries[slot]);
+			std::swap(dist, _dists[slot]);
+			if( placed == Npos )
+				placed = slot;
+		}
+
+		slot = this->next(slot);
+		++dist;
+		ASSERT_MSG(dist < DistLimit, "HashTable probe distance overflow");
+	}
+}
+
+
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+bool HashTable<ENTRY, KEY_OF, HASH, EQUAL>::rehash(const size_t slots)
+{
+	ASSERT_MSG(slots >= MinSlots && (slots & (slots - 1)) == 0, "HashTable slots must be a power of two");
+
+	// distances first, padded so the entries after them keep ENTRY's alignment
+	const size_t distBytes = (sizeof(Dist) * slots + EntryAlign - 1) & ~(EntryAlign - 1);
+	const size_t blockBytes = distBytes + sizeof(ENTRY) * slots;
+	auto* const block = static_cast<uint8_t*>(OverAligned ? _alloc_arr_aligned(blockBytes, EntryAlign) 
+	                                                      : _alloc_arr(blockBytes));
+
+	if( !block ) {
+		LogError("Failed to allocate HashTable with %zu slots", slots);
+		return false;
+	}
+
+	ENTRY* const oldEntries = _entries;
+	Dist* const oldDists = _dists;
+	const size_t oldSlots = _slots;
+
+	_dists = reinterpret_cast<Dist*>(block);
+	_entries = reinterpret_cast<ENTRY*>(block + distBytes);
+	_slots = slots;
+	_shift = 64;
+	for(size_t s = slots; s > 1; s >>= 1)
+		--_shift;
+
+	memset(_dists, 0, sizeof(Dist) * slots);
+
+	for(size_t i = 0; i < oldSlots; ++i)
+	{
+		if( oldDists[i] ) {
+			this->place(std::move(oldEntries[i]), this->home(HASH()(KEY_OF::get(oldEntries[i]))));
+			oldEntries[i].~ENTRY();
+		}
+	}
+
+	if( oldDists )
+		free_block(oldDists);
+
+	return true;
+}
+
+
+template<class ENTRY, class KEY_OF, class HASH, class EQUAL>
+inline void HashTable<ENTRY, KEY_OF, HASH, EQUAL>::free_block(void* const block)
+{
+	if( OverAligned )
+		free_arr_aligned(block);
+	else
+		free_arr(block);
+}
+
+
+}
+
+#endif // UTIX_HASH_TABLE_H_
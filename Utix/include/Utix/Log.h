@@ -22,8 +22,18 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 #define UTIX_LOG_H_
 
 
+#include <atomic>
 #include <string>
 #include "Ints.h"
+#include "Format.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define UTIX_DEPRECATED_(msg) __attribute__((deprecated(msg)))
+#elif defined(_MSC_VER)
+#define UTIX_DEPRECATED_(msg) __declspec(deprecated(msg))
+#else
+#define UTIX_DEPRECATED_(msg)
+#endif
 
 namespace utix {
 
@@ -37,7 +47,126 @@ namespace literals
 
 extern void Log(const char* fmtString, ...) noexcept;
 extern void LogError(const char* fmtString, ...) noexcept;
-extern const std::string& GetLastLogError() noexcept;
+
+// to stderr like LogError, but leaves the last error and errno alone
+extern void LogWarning(const char* fmtString, ...) noexcept;
+
+// typed forms with the Format.h syntax, Log("{} of {}"_fmt, done, total).
+// the line is formatted in place and cut at LogRecordMax
+extern void log_args(const FormatString fmt, const FormatArg* args, const size_t count) noexcept;
+extern void log_error_args(const FormatString fmt, const FormatArg* args, const size_t count) noexcept;
+extern void log_warning_args(const FormatString fmt, const FormatArg* args, const size_t count) noexcept;
+
+template<class ...Args>
+inline void Log(const FormatString fmt, const Args& ...args) noexcept
+{
+	const FormatArg argArray[sizeof...(Args) + 1] = { FormatArg(args)..., FormatArg(0) };
+	log_args(fmt, argArray, sizeof...(Args));
+}
+
+template<class ...Args>
+inline void LogError(const FormatString fmt, const Args& ...args) noexcept
+{
+	const FormatArg argArray[sizeof...(Args) + 1] = { FormatArg(args)..., FormatArg(0) };
+	log_error_args(fmt, argArray, sizeof...(Args));
+}
+
+template<class ...Args>
+inline void LogWarning(const FormatString fmt, const Args& ...args) noexcept
+{
+	const FormatArg argArray[sizeof...(Args) + 1] = { FormatArg(args)..., FormatArg(0) };
+	log_warning_args(fmt, argArray, sizeof...(Args));
+}
+
+// the calling thread's last LogError message
+extern const char* GetLastLogError() noexcept;
+
+// GetLastLogError as it was before it went per thread: the same text, 
+// copied into a std::string the calling thread keeps
+UTIX_DEPRECATED_("allocates, use GetLastLogError") 
+extern const std::string& GetLastLogErrorString();
+
+
+
+
+// what async logging does when the calling thread's buffer is full
+enum class LogOverflow
+{
+	Drop,       // lose the line
+	Block,      // wait for the writer to make room
+	CountDrop   // lose the line, the writer later logs how many were lost
+};
+
+
+// async mode: Log and LogError format the line on the calling thread and copy it
+// into that thread's lock-free ring (bufferSize bytes, made on its first log),
+// a writer thread drains every ring with batched writev calls.
+// lines longer than LogRecordMax are cut. false if the writer can't start
+constexpr size_t LogRecordMax = 1024;
+extern bool StartAsyncLog(const size_t bufferSize = 64 * 1024, const LogOverflow overflow = LogOverflow::CountDrop) noexcept;
+
+// binary mode: the same rings and writer, but Log only stores the format pointer,
+// a timestamp and the argument bytes. the text is rendered later by the LogDecode
+// tool (BUILD_UTIX_TOOLS), the file layout is in BinaryLog.h.
+// formats must outlive the log, like string literals, pass others through "%s".
+// LogError, LogWarning, the typed forms and what can't be deferred (%n, %lc, %ls) are stored formatted
+extern bool StartBinaryLog(const char* path, const size_t bufferSize = 64 * 1024, const LogOverflow overflow = LogOverflow::CountDrop) noexcept;
+
+// writes what's buffered and goes back to synchronous logging.
+// the rings stay with their threads, a later StartAsyncLog reuses them
+extern void StopAsyncLog() noexcept;
+
+// returns once everything logged before the call is written, call it before exit
+extern void FlushLogs() noexcept;
+
+// lines lost to a full buffer since the process started
+extern uint64_t GetDroppedLogCount() noexcept;
+
+
+
+
+enum class LogLevel : uint8_t
+{
+	Trace, Debug, Info, Warn, Error, Off
+};
+
+
+// runtime level of the LogTrace ... LogErr macros, per category.
+// categories live in static storage, e.g. 'utix::LogCategory net_log("net");'
+struct LogCategory
+{
+	constexpr LogCategory(const char* const categoryName, const LogLevel minLevel = LogLevel::Info) noexcept
+		: name(categoryName), level(static_cast<uint8_t>(minLevel))
+	{
+	}
+
+	bool Enabled(const LogLevel msgLevel) const noexcept
+	{
+		return static_cast<uint8_t>(msgLevel) >= level.load(std::memory_order_relaxed);
+	}
+
+	void SetLevel(const LogLevel minLevel) noexcept
+	{
+		level.store(static_cast<uint8_t>(minLevel), std::memory_order_relaxed);
+	}
+
+	LogLevel GetLevel() const noexcept
+	{
+		return static_cast<LogLevel>(level.load(std::memory_order_relaxed));
+	}
+
+	const char* const name;
+	std::atomic<uint8_t> level;
+};
+
+
+// the category of the macros without 'In'
+extern LogCategory default_log_category;
+
+inline void SetLogLevel(const LogLevel minLevel) noexcept
+{
+	default_log_category.SetLevel(minLevel);
+}
 
 
 
@@ -60,4 +189,64 @@ extern const std::string& GetLastLogError() noexcept;
 
 
 
+
+// LogTrace, LogDebug and LogInfo print through Log, LogWarn through LogWarning
+// and LogErr through LogError. levels below UTIX_LOG_LEVEL (0 Trace ... 5 Off) are compiled out,
+// arguments and all. the rest check their category's level first, one relaxed
+// load, and only then evaluate the arguments and format.
+// the LogXIn(category, fmt, ...) forms take a LogCategory.
+// the LogWarning and LogError functions aren't filtered, the library reports through them
+#ifndef UTIX_LOG_LEVEL
+#ifdef _DEBUG
+#define UTIX_LOG_LEVEL 0
+#else
+#define UTIX_LOG_LEVEL 2
+#endif
+#endif
+
+// one parenthesized expression, it binds like a call inside a larger one
+#define UTIX_LOG_(category, msgLevel, logFunction, ...) \
+	((category).Enabled(msgLevel) ? static_cast<void>((logFunction)(__VA_ARGS__)) : static_cast<void>(0))
+
+#define UTIX_LOG_NONE_() static_cast<void>(0)
+
+
+#if UTIX_LOG_LEVEL <= 0
+#define LogTraceIn(category, ...) UTIX_LOG_(category, ::utix::LogLevel::Trace, ::utix::Log, __VA_ARGS__)
+#else
+#define LogTraceIn(category, ...) UTIX_LOG_NONE_()
+#endif
+
+#if UTIX_LOG_LEVEL <= 1
+#define LogDebugIn(category, ...) UTIX_LOG_(category, ::utix::LogLevel::Debug, ::utix::Log, __VA_ARGS__)
+#else
+#define LogDebugIn(category, ...) UTIX_LOG_NONE_()
+#endif
+
+#if UTIX_LOG_LEVEL <= 2
+#define LogInfoIn(category, ...) UTIX_LOG_(category, ::utix::LogLevel::Info, ::utix::Log, __VA_ARGS__)
+#else
+#define LogInfoIn(category, ...) UTIX_LOG_NONE_()
+#endif
+
+#if UTIX_LOG_LEVEL <= 3
+#define LogWarnIn(category, ...) UTIX_LOG_(category, ::utix::LogLevel::Warn, ::utix::LogWarning, __VA_ARGS__)
+#else
+#define LogWarnIn(category, ...) UTIX_LOG_NONE_()
+#endif
+
+#if UTIX_LOG_LEVEL <= 4
+#define LogErrIn(category, ...) UTIX_LOG_(category, ::utix::LogLevel::Error, ::utix::LogError, __VA_ARGS__)
+#else
+#define LogErrIn(category, ...) UTIX_LOG_NONE_()
+#endif
+
+#define LogTrace(...) LogTraceIn(::utix::default_log_category, __VA_ARGS__)
+#define LogDebug(...) LogDebugIn(::utix::default_log_category, __VA_ARGS__)
+#define LogInfo(...) LogInfoIn(::utix::default_log_category, __VA_ARGS__)
+#define LogWarn(...) LogWarnIn(::utix::default_log_category, __VA_ARGS__)
+#define LogErr(...) LogErrIn(::utix::default_log_category, __VA_ARGS__)
+
+
+
 #endif // UTIX_LOG_H_
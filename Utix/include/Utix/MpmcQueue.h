@@ -0,0 +1,358 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_MPMC_QUEUE_H_
+#define UTIX_MPMC_QUEUE_H_
+#include <atomic>
+#include <type_traits>
+#include <utility>
+#include "Alloc.h"
+#include "Assert.h"
+#include "Futex.h"
+#include "Log.h"
+
+
+namespace utix {
+
+
+// bounded lock-free queue for any number of producers and consumers (Dmitry Vyukov's).
+// each slot has a sequence number telling whose turn it is, so a push or pop 
+// is one CAS on its own index plus the slot. capacity is rounded up to a power of two,
+// the cells start on a cache line (or T's alignment, if bigger).
+// push / pop block on a futex once a short spin fails, try_push / try_pop never block.
+// as with Vector, call initialize() before use.
+template<class T>
+class MpmcQueue
+{
+	struct Cell
+	{
+		std::atomic<size_t> seq;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	};
+
+	static constexpr int SpinCount = 64;
+	static constexpr size_t CellAlign = alignof(Cell) > CacheLineSize ? alignof(Cell) : CacheLineSize;
+
+public:
+	MpmcQueue(const MpmcQueue&) = delete;
+	MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+	MpmcQueue() = default;
+	~MpmcQueue();
+
+	bool initialize(const size_t capacity);
+	void free() noexcept;
+
+	size_t capacity() const;
+	size_t size() const;
+	bool empty() const;
+
+	bool try_push(const T& item);
+	bool try_push(T&& item);
+	template<class ...Args>
+	bool try_emplace(Args&& ...args);
+	bool try_pop(T& out);
+
+	void push(const T& item);
+	void push(T&& item);
+	void pop(T& out);
+
+private:
+	template<class F>
+	void wait(F&& attempt, std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& waiters);
+	void notify(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& waiters);
+
+	// set by initialize, read only while in use
+	Cell* _cells = nullptr;
+	size_t _mask = 0;
+	uint8_t _pad0[CacheLineSize];
+
+	std::atomic<size_t> _enqueue{0};
+	uint8_t _pad1[CacheLineSize];
+
+	std::atomic<size_t> _dequeue{0};
+	uint8_t _pad2[CacheLineSize];
+
+	// bumped after a push or pop only when someone sleeps on them
+	std::atomic<uint32_t> _pushes{0};
+	std::atomic<uint32_t> _popWaiters{0};
+	std::atomic<uint32_t> _pops{0};
+	std::atomic<uint32_t> _pushWaiters{0};
+	uint8_t _pad3[CacheLineSize];
+};
+
+
+
+
+
+
+
+template<class T>
+inline MpmcQueue<T>::~MpmcQueue()
+{
+	this->free();
+}
+
+
+
+
+template<class T>
+bool MpmcQueue<T>::initialize(const size_t capacity)
+{
+	this->free();
+
+	size_t slots = 2;
+	while( slots < capacity )
+	{
+		if( slots > (~size_t(0) / 2) / sizeof(Cell) ) {
+			LogError("Can't make MpmcQueue with %zu slots", capacity);
+			return false;
+		}
+
+		slots *= 2;
+	}
+
+	_cells = alloc_arr_aligned<Cell>(slots, CellAlign);
+
+	if( !_cells ) {
+		LogError("Failed to allocate MpmcQueue with %zu slots", slots);
+		return false;
+	}
+
+	// slot i is free for the push at position i
+	for(size_t i = 0; i < slots; ++i)
+		new(&_cells[i].seq) std::atomic<size_t>(i);
+
+	_mask = slots - 1;
+	_enqueue.store(0, std::memory_order_relaxed);
+	_dequeue.store(0, std::memory_order_relaxed);
+	return true;
+}
+
+
+// no other thread may be using the queue
+template<class T>
+void MpmcQueue<T>::free() noexcept
+{
+	if( _cells )
+	{
+		const size_t end = _enqueue.load(std::memory_order_relaxed);
+		for(size_t pos = _dequeue.load(std::memory_order_relaxed); pos != end; ++pos)
+			reinterpret_cast<T*>(&_cells[pos & _mask].storage)->~T();
+
+		free_arr_aligned(_cells);
+		_cells = nullptr;
+		_mask = 0;
+	}
+}
+
+
+
+
+template<class T>
+inline size_t MpmcQueue<T>::capacity() const
+{
+	return _cells ? _mask + 1 : 0;
+}
+
+
+// a snapshot, other threads may change it right away
+template<class T>
+inline size_t MpmcQueue<T>::size() const
+{
+	const size_t dequeue = _dequeue.load(std::memory_order_acquire);
+	const size_t enqueue = _enqueue.load(std::memory_order_acquire);
+	return enqueue > dequeue ? enqueue - dequeue : 0;
+}
+
+
+template<class T>
+inline bool MpmcQueue<T>::empty() const
+{
+	return this->size() == 0;
+}
+
+
+
+
+template<class T>
+inline bool MpmcQueue<T>::try_push(const T& item)
+{
+	return this->try_emplace(item);
+}
+
+
+template<class T>
+inline bool MpmcQueue<T>::try_push(T&& item)
+{
+	return this->try_emplace(std::move(item));
+}
+
+
+template<class T>
+template<class ...Args>
+bool MpmcQueue<T>::try_emplace(Args&& ...args)
+{
+	ASSERT_MSG(_cells != nullptr, "MpmcQueue used before initialize");
+
+	size_t pos = _enqueue.load(std::memory_order_relaxed);
+	Cell* cell;
+
+	for(;;)
+	{
+		cell = &_cells[pos & _mask];
+		const size_t seq = cell->seq.load(std::memory_order_acquire);
+		const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+		if( diff == 0 ) {
+			if( _enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+				break;
+		}
+		else if( diff < 0 ) {
+			// the slot still holds the item from a lap ago: full
+			return false;
+		}
+		else {
+			pos = _enqueue.load(std::memory_order_relaxed);
+		}
+	}
+
+	new(&cell->storage) T(std::forward<Args>(args)...);
+	cell->seq.store(pos + 1, std::memory_order_release);
+	this->notify(_pushes, _popWaiters);
+	return true;
+}
+
+
+template<class T>
+bool MpmcQueue<T>::try_pop(T& out)
+{
+	ASSERT_MSG(_cells != nullptr, "MpmcQueue used before initialize");
+
+	size_t pos = _dequeue.load(std::memory_order_relaxed);
+	Cell* cell;
+
+	for(;;)
+	{
+		cell = &_cells[pos & _mask];
+		const size_t seq = cell->seq.load(std::memory_order_acquire);
+		const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+		if( diff == 0 ) {
+			if( _dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+				break;
+		}
+		else if( diff < 0 ) {
+			// nothing pushed here yet: empty
+			return false;
+		}
+		else {
+			pos = _dequeue.load(std::memory_order_relaxed);
+		}
+	}
+
+	T& item = *reinterpret_cast<T*>(&cell->storage);
+	out = std::move(item);
+	item.~T();
+
+	// free for the push one lap ahead
+	cell->seq.store(pos + _mask + 1, std::memory_order_release);
+	this->notify(_pops, _pushWaiters);
+	return true;
+}
+
+
+
+
+template<class T>
+inline void MpmcQueue<T>::push(const T& item)
+{
+	this->wait([this, &item] { return this->try_push(item); }, _pops, _pushWaiters);
+}
+
+
+template<class T>
+inline void MpmcQueue<T>::push(T&& item)
+{
+	// try_push only moves from item when it succeeds
+	this->wait([this, &item] { return this->try_push(std::move(item)); }, _pops, _pushWaiters);
+}
+
+
+template<class T>
+inline void MpmcQueue<T>::pop(T& out)
+{
+	this->wait([this, &out] { return this->try_pop(out); }, _pushes, _popWaiters);
+}
+
+
+
+
+// spins a little, then sleeps on 'epoch' until the other side bumps it.
+// the waiter count is raised before the last attempt, so a notify that
+// misses it happened before that attempt and the attempt sees its result
+template<class T>
+template<class F>
+void MpmcQueue<T>::wait(F&& attempt, std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& waiters)
+{
+	for(int spin = 0; spin < SpinCount; ++spin) 
+	{
+		if( attempt() )
+			return;
+
+		cpu_relax();
+	}
+
+	for(;;)
+	{
+		const uint32_t seen = epoch.load(std::memory_order_acquire);
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		const bool done = attempt();
+		if( !done )
+			futex_wait(&epoch, seen);
+
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+
+		if( done || attempt() )
+			return;
+	}
+}
+
+
+template<class T>
+inline void MpmcQueue<T>::notify(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& waiters)
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if( waiters.load(std::memory_order_relaxed) != 0 ) {
+		epoch.fetch_add(1, std::memory_order_release);
+		futex_wake(&epoch, 1);
+	}
+}
+
+
+}
+
+#endif // UTIX_MPMC_QUEUE_H_
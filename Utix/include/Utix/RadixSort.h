@@ -0,0 +1,287 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+#ifndef UTIX_RADIX_SORT_H_
+#define UTIX_RADIX_SORT_H_
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "Ints.h"
+#include "Alloc.h"
+#include "Log.h"
+#include "Traits.h"
+#include "Algorithm.h"
+#include "ThreadPool.h"
+#include "Vector.h"
+
+
+namespace utix {
+
+
+// RadixKey<T>::map turns a key into an unsigned integer with the same order,
+// so the sort can go through it a byte at a time
+template<class T, class = void>
+struct RadixKey;
+
+
+template<class T>
+struct RadixKey<T, enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value>>
+{
+	using type = T;
+	static type map(const T key) { return key; }
+};
+
+
+// signed: flip the sign bit, negatives then come first
+template<class T>
+struct RadixKey<T, enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value>>
+{
+	using type = typename std::make_unsigned<T>::type;
+	static type map(const T key) 
+	{ 
+		return static_cast<type>(static_cast<type>(key) ^ (type(1) << ((sizeof(T) * 8) - 1))); 
+	}
+};
+
+
+// ieee floats: negatives have all bits flipped, positives only the sign bit.
+// -0.0 sorts before 0.0 and NaNs go to the ends, by their sign
+template<class T>
+struct RadixKey<T, enable_if_t<std::is_floating_point<T>::value>>
+{
+	static_assert(sizeof(T) == 4 || sizeof(T) == 8, "radix_sort takes 32 and 64 bit floats");
+	using type = conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+	static type map(const T key)
+	{
+		type bits;
+		memcpy(&bits, &key, sizeof(T));
+		constexpr type sign = type(1) << ((sizeof(T) * 8) - 1);
+		return (bits & sign) ? static_cast<type>(~bits) : static_cast<type>(bits | sign);
+	}
+};
+
+
+
+
+// radix_sort internals
+
+// below this many elements std::stable_sort is faster than the histogram setup
+constexpr size_t RadixSortCutoff = 256;
+
+
+template<class T, class K>
+using radix_key_t = typename RadixKey<typename std::decay<decltype(std::declval<K&>()(std::declval<const T&>()))>::type>::type;
+
+
+template<size_t BYTES>
+struct RadixHistogram
+{
+	size_t counts[BYTES][256];
+};
+
+
+template<class T>
+struct RadixIdentity
+{
+	T operator()(const T& value) const { return value; }
+};
+
+
+// counts of every byte of the keys, for all passes in one go through the data
+template<class T, class K, size_t BYTES>
+void _radix_histogram(const T* const first, const T* const last, K& key, RadixHistogram<BYTES>& hist)
+{
+	using Key = radix_key_t<T, K>;
+	using Map = RadixKey<typename std::decay<decltype(key(*first))>::type>;
+
+	for(const T* itr = first; itr != last; ++itr) 
+	{
+		const Key mapped = Map::map(key(*itr));
+		for(size_t byte = 0; byte < BYTES; ++byte)
+			++hist.counts[byte][(mapped >> (byte * 8)) & 0xFF];
+	}
+}
+
+
+// one counting scatter per byte, least significant first, between the range
+// and the buffer. bytes that are the same in every key are skipped
+template<class T, class K, size_t BYTES>
+void _radix_scatter(T* const first, const size_t count, T* const buffer, K& key, const RadixHistogram<BYTES>& hist)
+{
+	using Map = RadixKey<typename std::decay<decltype(key(*first))>::type>;
+
+	T* src = first;
+	T* dst = buffer;
+
+	for(size_t byte = 0; byte < BYTES; ++byte) 
+	{
+		const size_t shift = byte * 8;
+		const size_t* const counts = hist.counts[byte];
+
+		if( counts[(Map::map(key(*src)) >> shift) & 0xFF] == count )
+			continue;
+
+		size_t offsets[256];
+		size_t sum = 0;
+		for(size_t i = 0; i < 256; ++i) {
+			offsets[i] = sum;
+			sum += counts[i];
+		}
+
+		for(size_t i = 0; i < count; ++i)
+			dst[offsets[(Map::map(key(src[i])) >> shift) & 0xFF]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	if( src != first )
+		memcpy(first, src, sizeof(T) * count);
+}
+
+
+// allocates the buffer. true when there's no need for one,
+// because the range was small or the allocation failed, and it got std::stable_sort instead
+template<class T, class K>
+bool _radix_sort_prepare(T* const first, T* const last, K& key, T*& buffer)
+{
+	static_assert(is_trivially_copyable<T>::value, "radix_sort moves elements with memcpy, T must be trivially copyable");
+
+	const size_t count = last - first;
+	using Map = RadixKey<typename std::decay<decltype(key(*first))>::type>;
+	const auto less = [&key](const T& a, const T& b) { return Map::map(key(a)) < Map::map(key(b)); };
+
+	if( count < RadixSortCutoff ) {
+		std::stable_sort(first, last, less);
+		return true;
+	}
+
+	buffer = alloc_arr<T>(count);
+
+	if( !buffer ) {
+		LogError("Failed to allocate radix_sort buffer of %zu elements", count);
+		std::stable_sort(first, last, less);
+		return true;
+	}
+
+	return false;
+}
+
+
+
+
+// stable LSD radix sort of [first, last) by key(const T&), which returns
+// an integer or a float. T must be trivially copyable, 
+// e.g. a key/value struct: radix_sort(first, last, [](const Pair& p) { return p.key; })
+template<class T, class K>
+void radix_sort(T* const first, T* const last, K&& key)
+{
+	T* buffer;
+	if( _radix_sort_prepare(first, last, key, buffer) )
+		return;
+
+	constexpr size_t bytes = sizeof(radix_key_t<T, K>);
+	RadixHistogram<bytes> hist{};
+	_radix_histogram(first, last, key, hist);
+	_radix_scatter(first, last - first, buffer, key, hist);
+	free_arr(buffer);
+}
+
+
+// the histogram pass runs on the pool, the scatter passes are serial
+template<class T, class K>
+void radix_sort(ThreadPool& pool, T* const first, T* const last, K&& key)
+{
+	const size_t count = last - first;
+
+	if( _parallel_serial(pool, count) ) {
+		radix_sort(first, last, key);
+		return;
+	}
+
+	T* buffer;
+	if( _radix_sort_prepare(first, last, key, buffer) )
+		return;
+
+	constexpr size_t bytes = sizeof(radix_key_t<T, K>);
+	using Histogram = RadixHistogram<bytes>;
+
+	const Histogram hist = parallel_reduce(pool, size_t(0), count, Histogram{}, 
+		[first, &key](const size_t begin, const size_t end, Histogram acc) {
+			_radix_histogram(first + begin, first + end, key, acc);
+			return acc;
+		},
+		[](Histogram left, const Histogram& right) {
+			for(size_t byte = 0; byte < bytes; ++byte)
+				for(size_t i = 0; i < 256; ++i)
+					left.counts[byte][i] += right.counts[byte][i];
+			return left;
+		}, _parallel_chunk<T>(pool, count));
+
+	_radix_scatter(first, count, buffer, key, hist);
+	free_arr(buffer);
+}
+
+
+template<class T>
+void radix_sort(T* const first, T* const last)
+{
+	radix_sort(first, last, RadixIdentity<T>());
+}
+
+
+template<class T>
+void radix_sort(ThreadPool& pool, T* const first, T* const last)
+{
+	radix_sort(pool, first, last, RadixIdentity<T>());
+}
+
+
+template<class T, class A, class G>
+void radix_sort(Vector<T, A, G>& vec)
+{
+	radix_sort(vec.data(), vec.data() + vec.size());
+}
+
+
+template<class T, class A, class G, class K>
+void radix_sort(Vector<T, A, G>& vec, K&& key)
+{
+	radix_sort(vec.data(), vec.data() + vec.size(), key);
+}
+
+
+template<class T, class A, class G>
+void radix_sort(ThreadPool& pool, Vector<T, A, G>& vec)
+{
+	radix_sort(pool, vec.data(), vec.data() + vec.size());
+}
+
+
+template<class T, class A, class G, class K>
+void radix_sort(ThreadPool& pool, Vector<T, A, G>& vec, K&& key)
+{
+	radix_sort(pool, vec.data(), vec.data() + vec.size(), key);
+}
+
+
+}
+
+#endif // UTIX_RADIX_SORT_H_
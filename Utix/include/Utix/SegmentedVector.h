@@ -0,0 +1,384 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_SEGMENTED_VECTOR_H_
+#define UTIX_SEGMENTED_VECTOR_H_
+#include <utility>
+#include "Exceptions.h"
+#include "Alloc.h"
+#include "Assert.h"
+#include "Log.h"
+
+
+namespace utix {
+
+
+// elements per chunk: about 4KB worth, rounded down to a power of two
+template<class T>
+constexpr size_t SegmentedChunkElems(const size_t elems = 4096 / sizeof(T), const size_t pow2 = 1)
+{
+	return (pow2 * 2) > elems ? pow2 : SegmentedChunkElems<T>(elems, pow2 * 2);
+}
+
+
+
+
+// vector made of fixed-size chunks from alloc_arr_aligned, on cache line
+// boundaries so per-chunk loops vectorize with aligned loads.
+// growing only adds chunks, so elements never move and their addresses
+// stay valid until they are removed. indexing is a shift and a mask.
+// each chunk is contiguous, see chunk_count / chunk_data / chunk_size.
+// like SmallVector it is ready to use after construction.
+template<class TYPE, size_t CHUNK = SegmentedChunkElems<TYPE>()>
+class SegmentedVector
+{
+	static_assert(CHUNK > 0 && (CHUNK & (CHUNK - 1)) == 0, "SegmentedVector CHUNK must be a power of two");
+
+	static constexpr size_t ChunkShift(const size_t chunk = CHUNK, const size_t shift = 0) {
+		return chunk == 1 ? shift : ChunkShift(chunk >> 1, shift + 1);
+	}
+
+	static constexpr size_t Shift = ChunkShift();
+	static constexpr size_t ChunkAlign = alignof(TYPE) > CacheLineSize ? alignof(TYPE) : CacheLineSize;
+	static constexpr size_t Mask = CHUNK - 1;
+
+public:
+	static constexpr size_t ChunkElems = CHUNK;
+
+	SegmentedVector(const SegmentedVector&) = delete;
+	SegmentedVector& operator=(const SegmentedVector&) = delete;
+
+	SegmentedVector() = default;
+	SegmentedVector(SegmentedVector&& other) noexcept;
+	~SegmentedVector();
+	SegmentedVector& operator=(SegmentedVector&& other) noexcept;
+
+	bool empty() const;
+	size_t size() const;
+	size_t capacity() const;
+
+	const TYPE& operator[](const size_t index) const;
+	TYPE& operator[](const size_t index);
+	const TYPE& back() const;
+	TYPE& back();
+
+	size_t chunk_count() const;
+	const TYPE* chunk_data(const size_t chunk) const;
+	TYPE* chunk_data(const size_t chunk);
+	size_t chunk_size(const size_t chunk) const;
+
+	// calls func(TYPE* data, size_t count) for each chunk in use
+	template<class F>
+	void for_each_chunk(F&& func);
+
+	bool push_back(const TYPE& type);
+	bool push_back(TYPE&& type);
+	template<class ...Args>
+	bool emplace_back(Args&& ...args);
+	void pop_back();
+	bool reserve(const size_t size);
+	void clear();
+
+	void swap(SegmentedVector& other) noexcept;
+	void free() noexcept;
+
+private:
+	bool add_chunk();
+
+	TYPE** _chunks = nullptr;
+	size_t _chunkCount = 0;
+	size_t _size = 0;
+};
+
+
+
+
+
+
+
+template<class TYPE, size_t CHUNK>
+inline SegmentedVector<TYPE, CHUNK>::SegmentedVector(SegmentedVector&& other) noexcept
+	: _chunks(other._chunks),
+	_chunkCount(other._chunkCount),
+	_size(other._size)
+{
+	other._chunks = nullptr;
+	other._chunkCount = 0;
+	other._size = 0;
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline SegmentedVector<TYPE, CHUNK>::~SegmentedVector()
+{
+	this->free();
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline SegmentedVector<TYPE, CHUNK>& SegmentedVector<TYPE, CHUNK>::operator=(SegmentedVector&& other) noexcept
+{
+	this->swap(other);
+	return *this;
+}
+
+
+
+
+template<class TYPE, size_t CHUNK>
+inline bool SegmentedVector<TYPE, CHUNK>::empty() const
+{
+	return _size == 0;
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline size_t SegmentedVector<TYPE, CHUNK>::size() const
+{
+	return _size;
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline size_t SegmentedVector<TYPE, CHUNK>::capacity() const
+{
+	return _chunkCount * CHUNK;
+}
+
+
+
+
+template<class TYPE, size_t CHUNK>
+inline const TYPE& SegmentedVector<TYPE, CHUNK>::operator[](const size_t index) const
+{
+	ASSERT_MSG(index < _size, "SegmentedVector index out of range");
+	return _chunks[index >> Shift][index & Mask];
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline TYPE& SegmentedVector<TYPE, CHUNK>::operator[](const size_t index)
+{
+	ASSERT_MSG(index < _size, "SegmentedVector index out of range");
+	return _chunks[index >> Shift][index & Mask];
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline const TYPE& SegmentedVector<TYPE, CHUNK>::back() const
+{
+	return (*this)[_size - 1];
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline TYPE& SegmentedVector<TYPE, CHUNK>::back()
+{
+	return (*this)[_size - 1];
+}
+
+
+
+
+// chunks holding elements, the last one might be partially filled
+template<class TYPE, size_t CHUNK>
+inline size_t SegmentedVector<TYPE, CHUNK>::chunk_count() const
+{
+	return (_size + Mask) >> Shift;
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline const TYPE* SegmentedVector<TYPE, CHUNK>::chunk_data(const size_t chunk) const
+{
+	ASSERT_MSG(chunk < _chunkCount, "SegmentedVector chunk out of range");
+	return _chunks[chunk];
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline TYPE* SegmentedVector<TYPE, CHUNK>::chunk_data(const size_t chunk)
+{
+	ASSERT_MSG(chunk < _chunkCount, "SegmentedVector chunk out of range");
+	return _chunks[chunk];
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline size_t SegmentedVector<TYPE, CHUNK>::chunk_size(const size_t chunk) const
+{
+	const size_t first = chunk << Shift;
+	if( first >= _size )
+		return 0;
+
+	return (_size - first) < CHUNK ? (_size - first) : CHUNK;
+}
+
+
+template<class TYPE, size_t CHUNK>
+template<class F>
+void SegmentedVector<TYPE, CHUNK>::for_each_chunk(F&& func)
+{
+	const size_t full = _size >> Shift;
+
+	for(size_t i = 0; i < full; ++i)
+		func(_chunks[i], CHUNK);
+
+	if( _size & Mask )
+		func(_chunks[full], _size & Mask);
+}
+
+
+
+
+template<class TYPE, size_t CHUNK>
+inline bool SegmentedVector<TYPE, CHUNK>::push_back(const TYPE& type)
+{
+	return this->emplace_back(type);
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline bool SegmentedVector<TYPE, CHUNK>::push_back(TYPE&& type)
+{
+	return this->emplace_back(std::move(type));
+}
+
+
+template<class TYPE, size_t CHUNK>
+template<class ...Args>
+inline bool SegmentedVector<TYPE, CHUNK>::emplace_back(Args&& ...args)
+{
+	if( _size == this->capacity() )
+		if( !this->add_chunk() )
+			return false;
+
+	new(&_chunks[_size >> Shift][_size & Mask]) TYPE(std::forward<Args>(args)...);
+	++_size;
+	return true;
+}
+
+
+template<class TYPE, size_t CHUNK>
+inline void SegmentedVector<TYPE, CHUNK>::pop_back()
+{
+	ASSERT_MSG(_size > 0, "pop_back on empty SegmentedVector");
+	this->back().~TYPE();
+	--_size;
+}
+
+
+
+
+template<class TYPE, size_t CHUNK>
+bool SegmentedVector<TYPE, CHUNK>::reserve(const size_t size)
+{
+	while( this->capacity() < size )
+		if( !this->add_chunk() )
+			return false;
+
+	return true;
+}
+
+
+
+
+// destroys the elements, chunks are kept for reuse
+template<class TYPE, size_t CHUNK>
+void SegmentedVector<TYPE, CHUNK>::clear()
+{
+	while( _size > 0 )
+		this->pop_back();
+}
+
+
+
+
+template<class TYPE, size_t CHUNK>
+inline void SegmentedVector<TYPE, CHUNK>::swap(SegmentedVector& other) noexcept
+{
+	std::swap(_chunks, other._chunks);
+	std::swap(_chunkCount, other._chunkCount);
+	std::swap(_size, other._size);
+}
+
+
+
+
+template<class TYPE, size_t CHUNK>
+void SegmentedVector<TYPE, CHUNK>::free() noexcept
+{
+	if( _chunks )
+	{
+		this->clear();
+
+		for(size_t i = 0; i < _chunkCount; ++i)
+			free_arr_aligned(_chunks[i]);
+
+		free_arr(_chunks);
+		_chunks = nullptr;
+		_chunkCount = 0;
+	}
+}
+
+
+
+
+// only the chunk table is ever reallocated, it holds pointers
+template<class TYPE, size_t CHUNK>
+bool SegmentedVector<TYPE, CHUNK>::add_chunk()
+{
+	const size_t tableCapacity = arr_size(_chunks);
+
+	if( _chunkCount == tableCapacity )
+	{
+		const size_t tableSize = _chunkCount > 0 ? _chunkCount * 2 : 8;
+		TYPE** const table = _chunks ? realloc_arr<TYPE*>(_chunks, tableSize) 
+		                             : alloc_arr<TYPE*>(tableSize);
+
+		if( !table ) {
+			LogError("Failed to grow SegmentedVector chunk table");
+			return false;
+		}
+
+		_chunks = table;
+	}
+
+	TYPE* const chunk = alloc_arr_aligned<TYPE>(CHUNK, ChunkAlign);
+
+	if( !chunk ) {
+		LogError("Failed to allocate SegmentedVector chunk of %zu elements", CHUNK);
+		return false;
+	}
+
+	_chunks[_chunkCount++] = chunk;
+	return true;
+}
+
+
+
+
+}
+
+
+#endif // UTIX_SEGMENTED_VECTOR_H_
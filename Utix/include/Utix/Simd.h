@@ -0,0 +1,155 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+#ifndef UTIX_SIMD_H_
+#define UTIX_SIMD_H_
+#include "Ints.h"
+#include "Assert.h"
+#include "Vector.h"
+
+
+namespace utix {
+
+
+// SIMD kernels over float, int32_t and uint8_t arrays.
+// on x86 the widest of SSE2, AVX2 (with FMA) and AVX-512 (F and BW) the cpu
+// and os support is picked on first use. other targets use the scalar loops.
+// float sums and dots add in a different order per ISA, 
+// so the last bits may differ between machines. NaNs give min / max unspecified results
+enum class SimdIsa
+{
+	Scalar,
+	Sse2,
+	Avx2,
+	Avx512
+};
+
+
+extern SimdIsa get_simd_isa();
+extern const char* get_simd_isa_name(const SimdIsa isa);
+
+// false if this cpu can't run 'isa'. for benchmarks and tests, not thread safe
+// against kernels running at the same time
+extern bool set_simd_isa(const SimdIsa isa);
+
+
+extern float simd_sum(const float* data, const size_t count);
+extern int64_t simd_sum(const int32_t* data, const size_t count);
+extern uint64_t simd_sum(const uint8_t* data, const size_t count);
+
+// count must be > 0
+extern float simd_min(const float* data, const size_t count);
+extern int32_t simd_min(const int32_t* data, const size_t count);
+extern uint8_t simd_min(const uint8_t* data, const size_t count);
+extern float simd_max(const float* data, const size_t count);
+extern int32_t simd_max(const int32_t* data, const size_t count);
+extern uint8_t simd_max(const uint8_t* data, const size_t count);
+
+extern float simd_dot(const float* a, const float* b, const size_t count);
+
+// y[i] += a * x[i]
+extern void simd_axpy(const float a, const float* x, float* y, const size_t count);
+// data[i] *= a
+extern void simd_scale(float* data, const size_t count, const float a);
+
+extern void simd_fill(float* data, const size_t count, const float value);
+extern void simd_fill(int32_t* data, const size_t count, const int32_t value);
+extern void simd_fill(uint8_t* data, const size_t count, const uint8_t value);
+
+// how many elements equal value
+extern size_t simd_count(const int32_t* data, const size_t count, const int32_t value);
+extern size_t simd_count(const uint8_t* data, const size_t count, const uint8_t value);
+
+// index of the first element equal to value, or count
+extern size_t simd_find(const int32_t* data, const size_t count, const int32_t value);
+extern size_t simd_find(const uint8_t* data, const size_t count, const uint8_t value);
+
+
+
+
+// Vector overloads
+
+template<class T, class A, class G>
+auto simd_sum(const Vector<T, A, G>& vec) -> decltype(simd_sum(vec.data(), vec.size()))
+{
+	return simd_sum(vec.data(), vec.size());
+}
+
+
+template<class T, class A, class G>
+T simd_min(const Vector<T, A, G>& vec)
+{
+	return simd_min(vec.data(), vec.size());
+}
+
+
+template<class T, class A, class G>
+T simd_max(const Vector<T, A, G>& vec)
+{
+	return simd_max(vec.data(), vec.size());
+}
+
+
+template<class A, class G, class BA, class BG>
+float simd_dot(const Vector<float, A, G>& a, const Vector<float, BA, BG>& b)
+{
+	ASSERT_MSG(a.size() == b.size(), "simd_dot on Vectors of different sizes");
+	return simd_dot(a.data(), b.data(), a.size());
+}
+
+
+template<class XA, class XG, class YA, class YG>
+void simd_axpy(const float a, const Vector<float, XA, XG>& x, Vector<float, YA, YG>& y)
+{
+	ASSERT_MSG(x.size() == y.size(), "simd_axpy on Vectors of different sizes");
+	simd_axpy(a, x.data(), y.data(), x.size());
+}
+
+
+template<class A, class G>
+void simd_scale(Vector<float, A, G>& vec, const float a)
+{
+	simd_scale(vec.data(), vec.size(), a);
+}
+
+
+template<class T, class A, class G>
+void simd_fill(Vector<T, A, G>& vec, const T value)
+{
+	simd_fill(vec.data(), vec.size(), value);
+}
+
+
+template<class T, class A, class G>
+size_t simd_count(const Vector<T, A, G>& vec, const T value)
+{
+	return simd_count(vec.data(), vec.size(), value);
+}
+
+
+template<class T, class A, class G>
+size_t simd_find(const Vector<T, A, G>& vec, const T value)
+{
+	return simd_find(vec.data(), vec.size(), value);
+}
+
+
+}
+
+#endif // UTIX_SIMD_H_
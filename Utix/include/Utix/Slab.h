@@ -0,0 +1,65 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#ifndef UTIX_SLAB_H_
+#define UTIX_SLAB_H_
+#include "Ints.h"
+
+
+namespace utix {
+
+
+// size-class slab allocator.
+// each thread keeps a free list per size class and refills / returns
+// them in batches from a central pool, so the common path takes no lock.
+// once a thread's cache is destroyed, its later calls use the central pool directly.
+// slabs are never given back to the system.
+// build with UTIX_SLAB_ALLOC to make it the backend of alloc_arr.
+
+constexpr size_t SlabMaxBlockSize = 1024;
+
+// bytes must not be greater than SlabMaxBlockSize
+extern void* slab_alloc(const size_t bytes) noexcept;
+
+// bytes must be the same size given to slab_alloc
+extern void slab_free(void* block, const size_t bytes) noexcept;
+
+// the real size of a block of 'bytes', blocks with the same size share a class
+extern size_t slab_block_size(const size_t bytes) noexcept;
+
+
+
+// array allocator for Vector and friends that takes small blocks from the slab
+// allocator whether or not alloc_arr is built with UTIX_SLAB_ALLOC.
+// bigger blocks go to malloc.
+struct SlabArrAlloc
+{
+	void* allocate(const size_t bytes) noexcept;
+	void* reallocate(void* from, const size_t bytes) noexcept;
+	void deallocate(const void* block) noexcept;
+};
+
+
+
+
+}
+
+
+#endif // UTIX_SLAB_H_
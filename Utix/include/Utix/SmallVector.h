@@ -0,0 +1,260 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#ifndef UTIX_SMALL_VECTOR_H_
+#define UTIX_SMALL_VECTOR_H_
+#include "Vector.h"
+
+
+namespace utix {
+
+
+// array allocator with room for N elements of T inside itself.
+// the inline block is handed out while it is free and big enough,
+// everything else goes to alloc_arr. copies start with an empty buffer.
+template<class T, size_t N>
+class InlineArrAlloc
+{
+	static_assert(N > 0, "InlineArrAlloc needs room for at least 1 element");
+	static constexpr size_t HeaderSpace = alignof(T) > sizeof(size_t) ? alignof(T) : sizeof(size_t);
+	static constexpr size_t StorageAlign = alignof(T) > alignof(size_t) ? alignof(T) : alignof(size_t);
+
+public:
+	static constexpr size_t InlineBytes = N * sizeof(T);
+
+	InlineArrAlloc() noexcept = default;
+	InlineArrAlloc(const InlineArrAlloc&) noexcept {}
+	InlineArrAlloc& operator=(const InlineArrAlloc&) noexcept { return *this; }
+
+	void* allocate(const size_t bytes);
+	void* reallocate(void* from, const size_t bytes);
+	void deallocate(const void* block);
+
+	const void* inline_data() const noexcept { return _storage + HeaderSpace; }
+
+private:
+	void* inline_block(const size_t bytes) noexcept;
+
+	alignas(StorageAlign) uint8_t _storage[HeaderSpace + InlineBytes];
+	bool _inUse = false;
+};
+
+
+
+
+// Vector that keeps up to N elements inside itself and only
+// moves to alloc_arr storage when it outgrows them.
+// unlike Vector it is ready to use after construction.
+template<class TYPE, size_t N>
+class SmallVector : public Vector<TYPE, InlineArrAlloc<TYPE, N>>
+{
+	using Base = Vector<TYPE, InlineArrAlloc<TYPE, N>>;
+
+public:
+	SmallVector(const SmallVector&) = delete;
+	SmallVector& operator=(const SmallVector&) = delete;
+
+	SmallVector();
+	SmallVector(SmallVector&& other);
+	SmallVector& operator=(SmallVector&& other);
+
+	// Vector's forms that copy elements in. its rvalue form swaps raw pointers,
+	// which can't carry an inline buffer, so only SmallVector's own is here
+	bool initialize(const size_t size = 0);
+	bool initialize(std::initializer_list<TYPE> list);
+	template<class T1, class T2>
+	bool initialize(const T1* begin, const T2* end);
+	void initialize(SmallVector&& other);
+
+	bool is_inline() const noexcept;
+	void swap(SmallVector& other);
+
+private:
+	void move_from(SmallVector& other);
+};
+
+
+
+
+
+
+
+template<class T, size_t N>
+inline void* InlineArrAlloc<T, N>::inline_block(const size_t bytes) noexcept
+{
+	auto* const header = reinterpret_cast<size_t*>(_storage + HeaderSpace) - 1;
+	*header = bytes;
+	_inUse = true;
+	return header + 1;
+}
+
+
+template<class T, size_t N>
+inline void* InlineArrAlloc<T, N>::allocate(const size_t bytes)
+{
+	if( !_inUse && bytes <= InlineBytes )
+		return inline_block(bytes);
+
+	return _alloc_arr(bytes);
+}
+
+
+template<class T, size_t N>
+inline void* InlineArrAlloc<T, N>::reallocate(void* from, const size_t bytes)
+{
+	if( from != inline_data() )
+		return _realloc_arr(from, bytes);
+
+	if( bytes <= InlineBytes )
+		return inline_block(bytes);
+
+	// spill to the heap
+	void* const block = _alloc_arr(bytes);
+	if( block ) 
+	{
+		memcpy(block, from, arr_size(static_cast<uint8_t*>(from)));
+		_inUse = false;
+	}
+
+	return block;
+}
+
+
+template<class T, size_t N>
+inline void InlineArrAlloc<T, N>::deallocate(const void* block)
+{
+	if( block == inline_data() )
+		_inUse = false;
+	else
+		free_arr(block);
+}
+
+
+
+
+
+
+template<class TYPE, size_t N>
+inline SmallVector<TYPE, N>::SmallVector()
+{
+	this->initialize(N);
+}
+
+
+template<class TYPE, size_t N>
+inline SmallVector<TYPE, N>::SmallVector(SmallVector&& other)
+{
+	this->move_from(other);
+}
+
+
+template<class TYPE, size_t N>
+inline SmallVector<TYPE, N>& SmallVector<TYPE, N>::operator=(SmallVector&& other)
+{
+	this->swap(other);
+	return *this;
+}
+
+
+template<class TYPE, size_t N>
+inline bool SmallVector<TYPE, N>::initialize(const size_t size)
+{
+	// Vector would start with 10 elements
+	return Base::initialize(size != 0 ? size : N);
+}
+
+
+template<class TYPE, size_t N>
+inline bool SmallVector<TYPE, N>::initialize(std::initializer_list<TYPE> list)
+{
+	return Base::initialize(list);
+}
+
+
+template<class TYPE, size_t N>
+template<class T1, class T2>
+inline bool SmallVector<TYPE, N>::initialize(const T1* begin, const T2* end)
+{
+	return Base::initialize(begin, end);
+}
+
+
+template<class TYPE, size_t N>
+inline void SmallVector<TYPE, N>::initialize(SmallVector&& other)
+{
+	if( this != &other )
+		this->move_from(other);
+}
+
+
+template<class TYPE, size_t N>
+inline bool SmallVector<TYPE, N>::is_inline() const noexcept
+{
+	return this->data() != nullptr && this->data() == this->get_allocator().inline_data();
+}
+
+
+template<class TYPE, size_t N>
+void SmallVector<TYPE, N>::swap(SmallVector& other)
+{
+	if( this == &other )
+		return;
+
+	// heap blocks just trade places
+	if( !this->is_inline() && !other.is_inline() ) 
+	{
+		Base::swap(other);
+		return;
+	}
+
+	SmallVector tmp;
+	tmp.move_from(*this);
+	this->move_from(other);
+	other.move_from(tmp);
+}
+
+
+// takes other's elements, other is left freed like a moved from Vector
+template<class TYPE, size_t N>
+void SmallVector<TYPE, N>::move_from(SmallVector& other)
+{
+	this->free();
+
+	if( !other.is_inline() ) 
+	{
+		Base::swap(other);
+		return;
+	}
+
+	Base::initialize(N);
+	for( auto& elem : other )
+		this->emplace_back(std::move(elem));
+
+	other.free();
+}
+
+
+
+
+
+}
+
+
+#endif // UTIX_SMALL_VECTOR_H_
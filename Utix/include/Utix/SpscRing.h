@@ -0,0 +1,478 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_SPSC_RING_H_
+#define UTIX_SPSC_RING_H_
+#include <string.h>
+#include <atomic>
+#include <utility>
+#include "Traits.h"
+#include "Alloc.h"
+#include "Assert.h"
+#include "Log.h"
+
+
+namespace utix {
+
+
+// lock-free ring for one producer thread and one consumer thread.
+// capacity is rounded up to a power of two, storage comes from alloc_arr_aligned
+// on a cache line of its own (or T's alignment, if bigger).
+// producer and consumer state sit a cache line apart, each side keeps a 
+// cached copy of the other's index and only reloads it when it looks full/empty.
+// as with Vector, call initialize() before use.
+template<class T>
+class SpscRing
+{
+	static constexpr size_t SlotAlign = alignof(T) > CacheLineSize ? alignof(T) : CacheLineSize;
+
+public:
+	// contiguous run of slots, see write_reserve / read_peek
+	struct Span
+	{
+		T* data;
+		size_t size;
+	};
+
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	SpscRing() = default;
+	~SpscRing();
+
+	bool initialize(const size_t capacity);
+	void free() noexcept;
+
+	size_t capacity() const;
+	size_t size() const;
+	bool empty() const;
+
+
+	// producer side
+	bool push(const T& item);
+	bool push(T&& item);
+	template<class ...Args>
+	bool emplace(Args&& ...args);
+
+	// pushes as many as fit, returns how many
+	size_t push_n(const T* items, const size_t count);
+
+	// pushes all of them or none, the consumer sees them all at once
+	bool push_all(const T* items, const size_t count);
+
+	// up to 'count' free slots to construct in place, then commit the ones written.
+	// the span stops at the end of the storage, reserve again for the rest
+	Span write_reserve(const size_t count);
+	void write_commit(const size_t count);
+
+
+	// consumer side
+	bool pop(T& out);
+
+	// pops up to 'count' into out, returns how many
+	size_t pop_n(T* out, const size_t count);
+
+	// up to 'count' filled slots to read in place, then release the ones used
+	Span read_peek(const size_t count);
+	void read_release(const size_t count);
+
+private:
+	size_t writable();
+	size_t readable();
+
+	template<class U = T>
+	static enable_if_t<is_trivially_copyable<U>::value == true>
+	copy_in(T* dest, const T* src, const size_t count);
+
+	template<class U = T>
+	static enable_if_t<is_trivially_copyable<U>::value == false>
+	copy_in(T* dest, const T* src, const size_t count);
+
+	template<class U = T>
+	static enable_if_t<is_trivially_copyable<U>::value == true>
+	move_out(T* dest, T* src, const size_t count);
+
+	template<class U = T>
+	static enable_if_t<is_trivially_copyable<U>::value == false>
+	move_out(T* dest, T* src, const size_t count);
+
+
+	// set by initialize, read only while in use
+	T* _slots = nullptr;
+	size_t _mask = 0;
+	uint8_t _pad0[CacheLineSize];
+
+	// written by the producer
+	std::atomic<size_t> _tail{0};
+	size_t _headCache = 0;
+	uint8_t _pad1[CacheLineSize];
+
+	// written by the consumer
+	std::atomic<size_t> _head{0};
+	size_t _tailCache = 0;
+	uint8_t _pad2[CacheLineSize];
+};
+
+
+
+
+
+
+
+template<class T>
+inline SpscRing<T>::~SpscRing()
+{
+	this->free();
+}
+
+
+
+
+template<class T>
+bool SpscRing<T>::initialize(const size_t capacity)
+{
+	this->free();
+
+	size_t slots = 1;
+	while( slots < capacity ) 
+	{
+		if( slots > (~size_t(0) / 2) / sizeof(T) ) {
+			LogError("Can't make SpscRing with %zu slots", capacity);
+			return false;
+		}
+
+		slots *= 2;
+	}
+
+	_slots = alloc_arr_aligned<T>(slots, SlotAlign);
+
+	if( !_slots ) {
+		LogError("Failed to allocate SpscRing with %zu slots", slots);
+		return false;
+	}
+
+	_mask = slots - 1;
+	_head.store(0, std::memory_order_relaxed);
+	_tail.store(0, std::memory_order_relaxed);
+	_headCache = 0;
+	_tailCache = 0;
+	return true;
+}
+
+
+// neither side may be running
+template<class T>
+void SpscRing<T>::free() noexcept
+{
+	if( _slots )
+	{
+		const size_t tail = _tail.load(std::memory_order_relaxed);
+		for(size_t i = _head.load(std::memory_order_relaxed); i != tail; ++i)
+			_slots[i & _mask].~T();
+
+		free_arr_aligned(_slots);
+		_slots = nullptr;
+		_mask = 0;
+	}
+}
+
+
+
+
+template<class T>
+inline size_t SpscRing<T>::capacity() const
+{
+	return _slots ? _mask + 1 : 0;
+}
+
+
+// only exact when called from one of the two sides
+template<class T>
+inline size_t SpscRing<T>::size() const
+{
+	return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+}
+
+
+template<class T>
+inline bool SpscRing<T>::empty() const
+{
+	return this->size() == 0;
+}
+
+
+
+
+template<class T>
+inline bool SpscRing<T>::push(const T& item)
+{
+	return this->emplace(item);
+}
+
+
+template<class T>
+inline bool SpscRing<T>::push(T&& item)
+{
+	return this->emplace(std::move(item));
+}
+
+
+template<class T>
+template<class ...Args>
+inline bool SpscRing<T>::emplace(Args&& ...args)
+{
+	const size_t tail = _tail.load(std::memory_order_relaxed);
+
+	if( tail - _headCache > _mask ) 
+	{
+		_headCache = _head.load(std::memory_order_acquire);
+		if( tail - _headCache > _mask )
+			return false;
+	}
+
+	new(&_slots[tail & _mask]) T(std::forward<Args>(args)...);
+	_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+
+template<class T>
+size_t SpscRing<T>::push_n(const T* items, const size_t count)
+{
+	size_t pushed = 0;
+
+	// at most two runs, before and after the wrap
+	while( pushed < count )
+	{
+		const Span span = this->write_reserve(count - pushed);
+		if( span.size == 0 )
+			break;
+
+		copy_in(span.data, items + pushed, span.size);
+		this->write_commit(span.size);
+		pushed += span.size;
+	}
+
+	return pushed;
+}
+
+
+template<class T>
+bool SpscRing<T>::push_all(const T* const items, const size_t count)
+{
+	const size_t tail = _tail.load(std::memory_order_relaxed);
+	const size_t capacity = _mask + 1;
+
+	if( capacity - (tail - _headCache) < count )
+	{
+		_headCache = _head.load(std::memory_order_acquire);
+		if( capacity - (tail - _headCache) < count )
+			return false;
+	}
+
+	const size_t start = tail & _mask;
+	const size_t untilEnd = capacity - start;
+	const size_t first = count < untilEnd ? count : untilEnd;
+
+	copy_in(&_slots[start], items, first);
+	copy_in(&_slots[0], items + first, count - first);
+	_tail.store(tail + count, std::memory_order_release);
+	return true;
+}
+
+
+template<class T>
+typename SpscRing<T>::Span SpscRing<T>::write_reserve(const size_t count)
+{
+	const size_t tail = _tail.load(std::memory_order_relaxed);
+	size_t avail = this->writable();
+	const size_t untilEnd = (_mask + 1) - (tail & _mask);
+
+	if( avail > untilEnd )
+		avail = untilEnd;
+	if( avail > count )
+		avail = count;
+
+	return Span { &_slots[tail & _mask], avail };
+}
+
+
+template<class T>
+inline void SpscRing<T>::write_commit(const size_t count)
+{
+	const size_t tail = _tail.load(std::memory_order_relaxed);
+	ASSERT_MSG(count <= (_mask + 1) - (tail - _headCache), "SpscRing commit past the reserved span");
+	_tail.store(tail + count, std::memory_order_release);
+}
+
+
+
+
+template<class T>
+inline bool SpscRing<T>::pop(T& out)
+{
+	const size_t head = _head.load(std::memory_order_relaxed);
+
+	if( head == _tailCache ) 
+	{
+		_tailCache = _tail.load(std::memory_order_acquire);
+		if( head == _tailCache )
+			return false;
+	}
+
+	T& slot = _slots[head & _mask];
+	out = std::move(slot);
+	slot.~T();
+	_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+
+template<class T>
+size_t SpscRing<T>::pop_n(T* out, const size_t count)
+{
+	size_t popped = 0;
+
+	while( popped < count )
+	{
+		const Span span = this->read_peek(count - popped);
+		if( span.size == 0 )
+			break;
+
+		move_out(out + popped, span.data, span.size);
+		_head.store(_head.load(std::memory_order_relaxed) + span.size, std::memory_order_release);
+		popped += span.size;
+	}
+
+	return popped;
+}
+
+
+template<class T>
+typename SpscRing<T>::Span SpscRing<T>::read_peek(const size_t count)
+{
+	const size_t head = _head.load(std::memory_order_relaxed);
+	size_t avail = this->readable();
+	const size_t untilEnd = (_mask + 1) - (head & _mask);
+
+	if( avail > untilEnd )
+		avail = untilEnd;
+	if( avail > count )
+		avail = count;
+
+	return Span { &_slots[head & _mask], avail };
+}
+
+
+// destroys the released elements
+template<class T>
+void SpscRing<T>::read_release(const size_t count)
+{
+	const size_t head = _head.load(std::memory_order_relaxed);
+	ASSERT_MSG(count <= _tailCache - head, "SpscRing release past the peeked span");
+
+	for(size_t i = 0; i < count; ++i)
+		_slots[(head + i) & _mask].~T();
+
+	_head.store(head + count, std::memory_order_release);
+}
+
+
+
+
+template<class T>
+inline size_t SpscRing<T>::writable()
+{
+	const size_t tail = _tail.load(std::memory_order_relaxed);
+	size_t avail = (_mask + 1) - (tail - _headCache);
+
+	if( avail == 0 ) {
+		_headCache = _head.load(std::memory_order_acquire);
+		avail = (_mask + 1) - (tail - _headCache);
+	}
+
+	return avail;
+}
+
+
+template<class T>
+inline size_t SpscRing<T>::readable()
+{
+	const size_t head = _head.load(std::memory_order_relaxed);
+	size_t avail = _tailCache - head;
+
+	if( avail == 0 ) {
+		_tailCache = _tail.load(std::memory_order_acquire);
+		avail = _tailCache - head;
+	}
+
+	return avail;
+}
+
+
+
+
+template<class T>
+template<class U>
+inline enable_if_t<is_trivially_copyable<U>::value == true>
+SpscRing<T>::copy_in(T* const dest, const T* const src, const size_t count)
+{
+	memcpy(dest, src, sizeof(T) * count);
+}
+
+
+template<class T>
+template<class U>
+inline enable_if_t<is_trivially_copyable<U>::value == false>
+SpscRing<T>::copy_in(T* const dest, const T* const src, const size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+		new(&dest[i]) T(src[i]);
+}
+
+
+template<class T>
+template<class U>
+inline enable_if_t<is_trivially_copyable<U>::value == true>
+SpscRing<T>::move_out(T* const dest, T* const src, const size_t count)
+{
+	memcpy(dest, src, sizeof(T) * count);
+}
+
+
+template<class T>
+template<class U>
+inline enable_if_t<is_trivially_copyable<U>::value == false>
+SpscRing<T>::move_out(T* const dest, T* const src, const size_t count)
+{
+	for(size_t i = 0; i < count; ++i) {
+		dest[i] = std::move(src[i]);
+		src[i].~T();
+	}
+}
+
+
+}
+
+#endif // UTIX_SPSC_RING_H_
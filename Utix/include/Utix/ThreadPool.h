@@ -0,0 +1,280 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+
+
+#ifndef UTIX_THREAD_POOL_H_
+#define UTIX_THREAD_POOL_H_
+#include <atomic>
+#include <utility>
+#include "Ints.h"
+#include "Alloc.h"
+#include "BaseTraits.h"
+#include "MpmcQueue.h"
+#include "Vector.h"
+
+
+namespace utix {
+
+
+class TaskGroup;
+
+
+// a unit of work: func(data). the memory stays the submitter's,
+// it must outlive the task, e.g. on the stack of whoever waits on the group
+struct Task
+{
+	void (*func)(void* data);
+	void* data;
+	TaskGroup* group;
+};
+
+
+// counts the tasks submitted to it that haven't finished
+class TaskGroup
+{
+public:
+	bool IsDone() const noexcept { return _pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class ThreadPool;
+	std::atomic<size_t> _pending{0};
+};
+
+
+
+
+// ThreadPool: workers with Chase-Lev deques and work stealing.
+// tasks submitted by a worker go to the bottom of its own deque, idle workers
+// steal from the top of the others. tasks from other threads go through a 
+// shared MpmcQueue. idle workers sleep on a futex.
+// Wait() runs tasks while it waits, so waiting inside a task doesn't deadlock.
+class ThreadPool
+{
+	struct Worker;
+
+public:
+	struct WorkerStats
+	{
+		uint64_t tasks;
+		uint64_t steals;
+		uint64_t sleeps;
+		uint64_t busyNs;
+		uint64_t uptimeNs;
+
+		// share of the time spent running tasks
+		double Utilization() const { return uptimeNs ? double(busyNs) / double(uptimeNs) : 0.0; }
+	};
+
+	static constexpr size_t DequeSize = 4096;
+	static constexpr size_t InjectSize = 4096;
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	ThreadPool() noexcept = default;
+	~ThreadPool();
+
+	// workers = 0 uses one per hardware thread. 
+	// pin binds worker i to cpu i, where the platform allows it
+	bool Start(unsigned workers = 0, const bool pin = false);
+
+	// pending tasks are dropped, Wait on them first
+	void Stop();
+
+	bool IsRunning() const noexcept;
+	unsigned GetWorkerCount() const noexcept;
+
+	// runs the task inline if the pool isn't running or its queue is full
+	void Submit(Task& task);
+	void Wait(TaskGroup& group);
+
+	WorkerStats GetWorkerStats(const unsigned worker) const;
+	void ResetStats();
+
+private:
+	Worker* CurrentWorker() const noexcept;
+	Task* FindTask(Worker* self);
+	void Run(Task* task, Worker* self);
+	void WorkerLoop(Worker* self);
+	void Notify();
+
+	Worker* _workers = nullptr;
+	unsigned _workerCount = 0;
+	MpmcQueue<Task*> _inject;
+	std::atomic<bool> _stop{false};
+	std::atomic<uint32_t> _wakeEpoch{0};
+	std::atomic<uint32_t> _sleepers{0};
+};
+
+
+
+
+// parallel_for / parallel_reduce internals
+
+template<class F>
+struct ParallelForRange
+{
+	ThreadPool* pool;
+	F* body;
+	size_t first;
+	size_t last;
+	size_t grain;
+};
+
+
+extern size_t _parallel_grain(const ThreadPool& pool, const size_t count);
+
+
+// split in halves down to 'grain': the right half goes to the pool, 
+// the left half runs here, then this thread helps until the right one is done
+template<class F>
+void _parallel_for_range(ThreadPool& pool, F& body, const size_t first, const size_t last, const size_t grain)
+{
+	if( last - first <= grain ) {
+		body(first, last);
+		return;
+	}
+
+	const size_t mid = first + ((last - first) / 2);
+	ParallelForRange<F> right { &pool, &body, mid, last, grain };
+	TaskGroup group;
+	Task task { [](void* data) {
+		auto& range = *static_cast<ParallelForRange<F>*>(data);
+		_parallel_for_range(*range.pool, *range.body, range.first, range.last, range.grain);
+	}, &right, &group };
+
+	pool.Submit(task);
+	_parallel_for_range(pool, body, first, mid, grain);
+	pool.Wait(group);
+}
+
+
+template<class R, class F, class J>
+struct ParallelReduceRange
+{
+	ThreadPool* pool;
+	F* reduce;
+	J* join;
+	size_t first;
+	size_t last;
+	size_t grain;
+	R result;
+};
+
+
+template<class R, class F, class J>
+R _parallel_reduce_range(ThreadPool& pool, F& reduce, J& join, const size_t first, const size_t last, const size_t grain, R identity)
+{
+	if( last - first <= grain )
+		return reduce(first, last, std::move(identity));
+
+	const size_t mid = first + ((last - first) / 2);
+	ParallelReduceRange<R, F, J> right { &pool, &reduce, &join, mid, last, grain, identity };
+	TaskGroup group;
+	Task task { [](void* data) {
+		auto& range = *static_cast<ParallelReduceRange<R, F, J>*>(data);
+		range.result = _parallel_reduce_range(*range.pool, *range.reduce, *range.join, 
+		                                      range.first, range.last, range.grain, std::move(range.result));
+	}, &right, &group };
+
+	pool.Submit(task);
+	R left = _parallel_reduce_range(pool, reduce, join, first, mid, grain, std::move(identity));
+	pool.Wait(group);
+	return join(std::move(left), std::move(right.result));
+}
+
+
+
+
+// runs left() here and right() on the pool, returns when both are done
+template<class L, class R>
+void parallel_invoke(ThreadPool& pool, L&& left, R&& right)
+{
+	TaskGroup group;
+	Task task { [](void* data) { (*static_cast<remove_reference_t<R>*>(data))(); }, &right, &group };
+	pool.Submit(task);
+	left();
+	pool.Wait(group);
+}
+
+
+
+
+// body(size_t first, size_t last) over chunks of [first, last) of at most 'grain'.
+// grain 0 picks about 8 chunks per worker
+template<class F>
+void parallel_for(ThreadPool& pool, const size_t first, const size_t last, F&& body, size_t grain = 0)
+{
+	if( first >= last )
+		return;
+
+	if( grain == 0 )
+		grain = _parallel_grain(pool, last - first);
+
+	_parallel_for_range(pool, body, first, last, grain);
+}
+
+
+// body(T* first, T* last) over chunks of the Vector
+template<class T, class A, class G, class F>
+void parallel_for(ThreadPool& pool, Vector<T, A, G>& vec, F&& body, const size_t grain = 0)
+{
+	T* const data = vec.data();
+	parallel_for(pool, 0, vec.size(), [data, &body](const size_t first, const size_t last) {
+		body(data + first, data + last);
+	}, grain);
+}
+
+
+
+
+// reduce(size_t first, size_t last, R acc) -> R folds a chunk into acc,
+// join(R, R) -> R merges two neighbour results, left one first.
+// each chunk starts from a copy of 'identity'
+template<class R, class F, class J>
+R parallel_reduce(ThreadPool& pool, const size_t first, const size_t last, R identity, F&& reduce, J&& join, size_t grain = 0)
+{
+	if( first >= last )
+		return identity;
+
+	if( grain == 0 )
+		grain = _parallel_grain(pool, last - first);
+
+	return _parallel_reduce_range(pool, reduce, join, first, last, grain, std::move(identity));
+}
+
+
+// reduce(const T* first, const T* last, R acc) -> R over chunks of the Vector
+template<class T, class A, class G, class R, class F, class J>
+R parallel_reduce(ThreadPool& pool, const Vector<T, A, G>& vec, R identity, F&& reduce, J&& join, const size_t grain = 0)
+{
+	const T* const data = vec.data();
+	return parallel_reduce(pool, 0, vec.size(), std::move(identity), 
+		[data, &reduce](const size_t first, const size_t last, R acc) {
+			return reduce(data + first, data + last, std::move(acc));
+		}, join, grain);
+}
+
+
+}
+
+#endif // UTIX_THREAD_POOL_H_
@@ -20,6 +20,7 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 
 #ifndef UTIX_TRAITS_H_
 #define UTIX_TRAITS_H_
+#include <memory>
 #include <type_traits>
 #include "BaseTraits.h"
 
@@ -35,6 +36,44 @@ constexpr underlying_type_t<T> toUtype(T t) noexcept
 }
 
 
+
+
+// is trivially copyable
+// libstdc++ before gcc 5 (e.g. Android's gnustl 4.9) lacks std::is_trivially_copyable.
+// __GLIBCXX__ is a date, and 4.9.3 / 4.9.4 came after 5.1, so go by version:
+// _GLIBCXX_RELEASE is there from gcc 7, and clang always says __GNUC__ 4,
+// so clang on a libstdc++ older than 7 takes the builtins too
+#if defined(__GLIBCXX__) && !defined(_GLIBCXX_RELEASE) && (defined(__clang__) || __GNUC__ < 5)
+template<class T>
+struct is_trivially_copyable 
+	: std::integral_constant<bool, __has_trivial_copy(T) && __has_trivial_assign(T) && __has_trivial_destructor(T)> {};
+#else
+template<class T>
+struct is_trivially_copyable : std::is_trivially_copyable<T> {};
+#endif
+
+
+
+// is trivially relocatable: moving to a new address and forgetting the old one
+// is the same as copying the bytes, so containers may grow with realloc.
+// specialize it for types that only point to what they own. (e.g. std::unique_ptr)
+// a specialization must be seen wherever its type is, next to the type's definition
+template<class T>
+struct is_trivially_relocatable : is_trivially_copyable<T> {};
+
+// unique_ptr only holds a pointer, Vector can realloc it
+template<class T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : true_type {};
+
+
+
+// is memcpyable: an array of FROM can be copied into an array of TO with memcpy
+template<class FROM, class TO>
+struct is_memcpyable 
+	: std::integral_constant<bool, is_trivially_copyable<TO>::value 
+	                               && is_same<remove_cv_t<FROM>, remove_cv_t<TO>>::value> {};
+
+
 }
 
 
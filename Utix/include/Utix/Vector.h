@@ -36,14 +36,64 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 namespace utix {
 
 
-template<class TYPE>
-class Vector
+// growth policies pick Vector's capacities, in elements:
+//   static size_t initial(size_t elemSize);                first block when no size is given
+//   static size_t next(size_t capacity, size_t elemSize);  new capacity when full, must be bigger
+
+// 2x, starting at 10 elements
+struct GrowDouble
+{
+	static constexpr size_t initial(const size_t) { return 10; }
+	static constexpr size_t next(const size_t capacity, const size_t) { return capacity > 0 ? capacity * 2 : 1; }
+};
+
+
+// 1.5x, lets freed blocks be reused by later growth
+struct GrowHalf
+{
+	static constexpr size_t initial(const size_t) { return 10; }
+	static constexpr size_t next(const size_t capacity, const size_t) { return capacity > 1 ? capacity + (capacity / 2) : capacity + 1; }
+};
+
+
+// STEP elements at a time, for sizes known to stay close to a bound
+template<size_t STEP>
+struct GrowStep
+{
+	static_assert(STEP > 0, "GrowStep needs a step greater than 0");
+	static constexpr size_t initial(const size_t) { return STEP; }
+	static constexpr size_t next(const size_t capacity, const size_t) { return capacity + STEP; }
+};
+
+
+// 2x, with blocks (header included) rounded up to whole pages
+struct GrowPage
+{
+	static constexpr size_t PageSize = 4096;
+	static constexpr size_t initial(const size_t elemSize) { return fit(elemSize, elemSize); }
+	static constexpr size_t next(const size_t capacity, const size_t elemSize) { return fit((capacity > 0 ? capacity * 2 : 1) * elemSize, elemSize); }
+
+private:
+	// elements that fit in the smallest whole-page block holding 'bytes'
+	static constexpr size_t fit(const size_t bytes, const size_t elemSize) {
+		return (((bytes + sizeof(size_t) + (PageSize - 1)) & ~(PageSize - 1)) - sizeof(size_t)) / elemSize;
+	}
+};
+
+
+
+
+// ALLOC: where the storage comes from. (see DefaultArrAlloc in Alloc.h)
+// GROWTH: how the capacity grows. (see GrowDouble)
+template<class TYPE, class ALLOC = DefaultArrAlloc, class GROWTH = GrowDouble>
+class Vector : private ALLOC
 {
 public:
 	Vector(const Vector&) = delete;
 	Vector& operator=(const Vector&) = delete;
 
 	Vector() = default;
+	explicit Vector(const ALLOC& alloc);
 	Vector(Vector&& other) noexcept;
 	~Vector();
 	Vector& operator=(Vector&& other) noexcept;
@@ -83,7 +133,25 @@ public:
 	bool emplace_back(Args&& ...args);
 	void clear();
 	bool resize(const size_t size);
+	bool resize(const size_t size, const TYPE& value);
+	bool resize_uninitialized(const size_t size);
 	bool reserve(const size_t size);
+	bool shrink_to_fit();
+
+	// range operations reallocate at most once
+	template<class T>
+	bool append(const T* first, const T* last);
+	template<class T>
+	bool insert(const TYPE* pos, const T* first, const T* last);
+	bool insert(const TYPE* pos, const size_t count, const TYPE& value);
+	bool insert(const TYPE* pos, TYPE&& value);
+	TYPE* erase(const TYPE* first, const TYPE* last);
+	TYPE* erase(const TYPE* pos);
+
+	template<class T>
+	bool assign(const T* first, const T* last);
+	bool assign(const size_t count, const TYPE& value);
+	bool assign(std::initializer_list<TYPE> list);
 
 	TYPE* begin();
 	TYPE* end();
@@ -93,68 +161,85 @@ public:
 	void swap(Vector& other) noexcept;
 	void free() noexcept;
 
+	const ALLOC& get_allocator() const noexcept;
+
 private:
 	bool reserve_init(size_t requested_size);
 	bool check_capacity();
 
-	// pod functions
-	template<class U = TYPE, class ...Args>
-	enable_if_t<std::is_pod<U>::value == true,
-	bool> _insert_back(Args&& ...args);
-
-	template<class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == true> 
-	_clear();
+	template<class ...Args>
+	bool _insert_back(Args&& ...args);
 
-	template<class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == true, 
-	bool> _reserve(size_t requested_size = 0);
+	bool _owns(const void* ptr) const;
+	size_t _next_capacity(const size_t required) const;
+	bool _grow_for(const size_t count);
+	void _fill_value(const TYPE& value, const size_t count, TYPE* dest);
 
+	// trivially copyable: no destructors to call, copies are memcpy
 	template<class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == true, 
-	bool> _resize(const size_t requested_size);
-
+	enable_if_t<is_trivially_copyable<U>::value == true> 
+	_clear();
 
 	template<class T, class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == true>
+	enable_if_t<is_memcpyable<T, U>::value == true>
 	_fill(const T* src, const size_t size, TYPE* dest);
 
-
 	template<class T, class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == true> 
+	enable_if_t<is_memcpyable<T, U>::value == true> 
 	_fill_move(T* src, const size_t size, TYPE* dest);
-	
 
-	// Non-Pod functions
-
-	template<class U = TYPE, class ...Args>
-	enable_if_t<std::is_pod<U>::value == false,
-	bool>_insert_back(Args&& ...args);
+	// trivially relocatable: grows with reallocate
+	template<class U = TYPE>
+	enable_if_t<is_trivially_relocatable<U>::value == true, 
+	bool> _reserve(size_t requested_size = 0);
 
+	// opens 'count' unconstructed slots at 'offset', returns them or nullptr
 	template<class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == false> 
-	_clear();
+	enable_if_t<is_trivially_relocatable<U>::value == true, 
+	TYPE*> _open_gap(const size_t offset, const size_t count);
 
+	// closes 'count' unconstructed slots at 'offset'
 	template<class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == false, 
-	bool> _reserve(size_t requested_size = 0);
+	enable_if_t<is_trivially_relocatable<U>::value == true> 
+	_close_gap(const size_t offset, const size_t count) noexcept;
 
+	// trivial: new elements are left uninitialized
 	template<class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == false, 
+	enable_if_t<std::is_trivial<U>::value == true, 
 	bool> _resize(const size_t requested_size);
+	
+
+	// Non-Trivial functions
+
+	template<class U = TYPE>
+	enable_if_t<is_trivially_copyable<U>::value == false> 
+	_clear();
 
 	template<class T, class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == false> 
+	enable_if_t<is_memcpyable<T, U>::value == false> 
 	_fill(const T* src, const size_t size, TYPE* dest);
 
-
 	template<class T, class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == false> 
+	enable_if_t<is_memcpyable<T, U>::value == false> 
 	_fill_move(T* src, const size_t size, TYPE* dest);
 
 	template<class U = TYPE>
-	enable_if_t<std::is_pod<U>::value == false,
-	void> _call_destructors(TYPE* const begin, TYPE* end) noexcept;
+	enable_if_t<is_trivially_relocatable<U>::value == false, 
+	bool> _reserve(size_t requested_size = 0);
+
+	template<class U = TYPE>
+	enable_if_t<is_trivially_relocatable<U>::value == false, 
+	TYPE*> _open_gap(const size_t offset, const size_t count);
+
+	template<class U = TYPE>
+	enable_if_t<is_trivially_relocatable<U>::value == false> 
+	_close_gap(const size_t offset, const size_t count) noexcept;
+
+	template<class U = TYPE>
+	enable_if_t<std::is_trivial<U>::value == false, 
+	bool> _resize(const size_t requested_size);
+
+	void _call_destructors(TYPE* const begin, TYPE* end) noexcept;
 
 
 
@@ -169,9 +254,18 @@ private:
 
 
 
-template<class TYPE>
-inline Vector<TYPE>::Vector(Vector&& other) noexcept
-	: _data(other._data),
+template<class TYPE, class ALLOC, class GROWTH>
+inline Vector<TYPE, ALLOC, GROWTH>::Vector(const ALLOC& alloc)
+	: ALLOC(alloc)
+{
+
+}
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+inline Vector<TYPE, ALLOC, GROWTH>::Vector(Vector&& other) noexcept
+	: ALLOC(static_cast<ALLOC&&>(other)),
+	_data(other._data),
 	_size(other._size)
 {
 	other._data = nullptr;
@@ -179,15 +273,15 @@ inline Vector<TYPE>::Vector(Vector&& other) noexcept
 }
 
 
-template<class TYPE>
-inline Vector<TYPE>::~Vector()
+template<class TYPE, class ALLOC, class GROWTH>
+inline Vector<TYPE, ALLOC, GROWTH>::~Vector()
 {
 	this->free();
 }
 
 
-template<class TYPE>
-inline Vector<TYPE>& Vector<TYPE>::operator=(Vector&& other) noexcept
+template<class TYPE, class ALLOC, class GROWTH>
+inline Vector<TYPE, ALLOC, GROWTH>& Vector<TYPE, ALLOC, GROWTH>::operator=(Vector&& other) noexcept
 {
 	this->swap(other);
 	return *this;
@@ -196,37 +290,37 @@ inline Vector<TYPE>& Vector<TYPE>::operator=(Vector&& other) noexcept
 
 
 
-template<class TYPE>
-inline bool Vector<TYPE>::empty() const
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::empty() const
 {
 	return _size == 0;
 }
 
 
-template<class TYPE>
-inline size_t Vector<TYPE>::size() const
+template<class TYPE, class ALLOC, class GROWTH>
+inline size_t Vector<TYPE, ALLOC, GROWTH>::size() const
 {
 	return _size;
 }
 
 
-template<class TYPE>
-inline size_t Vector<TYPE>::capacity() const
+template<class TYPE, class ALLOC, class GROWTH>
+inline size_t Vector<TYPE, ALLOC, GROWTH>::capacity() const
 {
 	return arr_size(_data);
 }
 
 
 
-template<class TYPE>
-inline const TYPE* Vector<TYPE>::cbegin() const
+template<class TYPE, class ALLOC, class GROWTH>
+inline const TYPE* Vector<TYPE, ALLOC, GROWTH>::cbegin() const
 {
 	return _data;
 }
 
 
-template<class TYPE>
-inline const TYPE* Vector<TYPE>::cend() const
+template<class TYPE, class ALLOC, class GROWTH>
+inline const TYPE* Vector<TYPE, ALLOC, GROWTH>::cend() const
 {
 	return _data + this->size();
 }
@@ -234,32 +328,32 @@ inline const TYPE* Vector<TYPE>::cend() const
 
 
 
-template<class TYPE>
-inline const TYPE* Vector<TYPE>::begin() const
+template<class TYPE, class ALLOC, class GROWTH>
+inline const TYPE* Vector<TYPE, ALLOC, GROWTH>::begin() const
 {
 	return _data;
 }
 
 
 
-template<class TYPE>
-inline const TYPE* Vector<TYPE>::end() const
+template<class TYPE, class ALLOC, class GROWTH>
+inline const TYPE* Vector<TYPE, ALLOC, GROWTH>::end() const
 {
 	return _data + this->size();
 }
 
 
 
-template<class TYPE>
-inline const TYPE* Vector<TYPE>::data() const
+template<class TYPE, class ALLOC, class GROWTH>
+inline const TYPE* Vector<TYPE, ALLOC, GROWTH>::data() const
 {
 	return _data;
 }
 
 
 
-template<class TYPE>
-inline const TYPE& Vector<TYPE>::operator[](const size_t offset) const
+template<class TYPE, class ALLOC, class GROWTH>
+inline const TYPE& Vector<TYPE, ALLOC, GROWTH>::operator[](const size_t offset) const
 {
 	ASSERT_MSG( _data != nullptr && offset < arr_size(_data), 
 		"offset overflow or not initialized Vector");
@@ -270,8 +364,8 @@ inline const TYPE& Vector<TYPE>::operator[](const size_t offset) const
 
 
 
-template<class TYPE>
-inline bool Vector<TYPE>::initialize(const size_t vectorSize)
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::initialize(const size_t vectorSize)
 {
 	this->free();
 	return reserve_init(vectorSize);
@@ -281,9 +375,9 @@ inline bool Vector<TYPE>::initialize(const size_t vectorSize)
 
 
 
-template<class TYPE>
+template<class TYPE, class ALLOC, class GROWTH>
 template<class T>
-bool Vector<TYPE>::initialize(const T* array, const size_t arraySize)
+bool Vector<TYPE, ALLOC, GROWTH>::initialize(const T* array, const size_t arraySize)
 {
 	if(this->initialize(arraySize))
 	{
@@ -298,8 +392,8 @@ bool Vector<TYPE>::initialize(const T* array, const size_t arraySize)
 
 
 
-template<class TYPE>
-bool Vector<TYPE>::initialize(const Vector& other)
+template<class TYPE, class ALLOC, class GROWTH>
+bool Vector<TYPE, ALLOC, GROWTH>::initialize(const Vector& other)
 {
 	const auto otherCap = other.capacity();
 
@@ -315,42 +409,42 @@ bool Vector<TYPE>::initialize(const Vector& other)
 
 
 
-template<class TYPE>
-inline void Vector<TYPE>::initialize(Vector&& other)
+template<class TYPE, class ALLOC, class GROWTH>
+inline void Vector<TYPE, ALLOC, GROWTH>::initialize(Vector&& other)
 {
 	this->swap(other);
 }
 
 
 
-template<class TYPE>
+template<class TYPE, class ALLOC, class GROWTH>
 template<class T1, class T2>
-inline bool Vector<TYPE>::initialize(const T1* begin, const T2* end)
+inline bool Vector<TYPE, ALLOC, GROWTH>::initialize(const T1* begin, const T2* end)
 {
 	return this->initialize(begin, static_cast<size_t>(end - begin));
 }
 
 
 
-template<class TYPE>
-inline bool Vector<TYPE>::initialize(std::initializer_list<TYPE> list)
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::initialize(std::initializer_list<TYPE> list)
 {
 	return this->initialize(list.begin(), list.size());
 }
 
 
 
-template<class TYPE>
+template<class TYPE, class ALLOC, class GROWTH>
 template<size_t sz>
-inline bool Vector<TYPE>::initialize(const TYPE(&array)[sz])
+inline bool Vector<TYPE, ALLOC, GROWTH>::initialize(const TYPE(&array)[sz])
 {
 	return this->initialize(array, sz);
 }
 
 
-template<class TYPE>
+template<class TYPE, class ALLOC, class GROWTH>
 template<size_t sz>
-inline bool Vector<TYPE>::initialize(TYPE(&&array)[sz])
+inline bool Vector<TYPE, ALLOC, GROWTH>::initialize(TYPE(&&array)[sz])
 {
 	if( this->initialize(sz) )
 	{
@@ -366,8 +460,8 @@ inline bool Vector<TYPE>::initialize(TYPE(&&array)[sz])
 
 
 
-template<class TYPE>
-inline TYPE* Vector<TYPE>::begin()
+template<class TYPE, class ALLOC, class GROWTH>
+inline TYPE* Vector<TYPE, ALLOC, GROWTH>::begin()
 {
 	return _data;
 }
@@ -375,24 +469,24 @@ inline TYPE* Vector<TYPE>::begin()
 
 
 
-template<class TYPE>
-inline TYPE* Vector<TYPE>::end()
+template<class TYPE, class ALLOC, class GROWTH>
+inline TYPE* Vector<TYPE, ALLOC, GROWTH>::end()
 {
 	return _data + this->size();
 }
 
 
 
-template<class TYPE>
-inline TYPE* Vector<TYPE>::data()
+template<class TYPE, class ALLOC, class GROWTH>
+inline TYPE* Vector<TYPE, ALLOC, GROWTH>::data()
 {
 	return _data;
 }
 
 
 
-template<class TYPE>
-inline TYPE& Vector<TYPE>::operator[]( const size_t offset )
+template<class TYPE, class ALLOC, class GROWTH>
+inline TYPE& Vector<TYPE, ALLOC, GROWTH>::operator[]( const size_t offset )
 {
 	ASSERT_MSG( _data != nullptr && offset < arr_size(_data), 
 		"offset overflow or not initialized Vector");
@@ -404,16 +498,16 @@ inline TYPE& Vector<TYPE>::operator[]( const size_t offset )
 
 
 
-template<class TYPE>
-inline bool Vector<TYPE>::push_back(const TYPE& type)
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::push_back(const TYPE& type)
 {
 	return this->_insert_back(type);
 }
 
 
 
-template<class TYPE>
-inline bool Vector<TYPE>::push_back(TYPE&& type)
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::push_back(TYPE&& type)
 {
 	return this->_insert_back(std::move(type));
 }
@@ -421,9 +515,9 @@ inline bool Vector<TYPE>::push_back(TYPE&& type)
 
 
 
-template<class TYPE>
+template<class TYPE, class ALLOC, class GROWTH>
 template<class ...Args>
-inline bool Vector<TYPE>::emplace_back(Args&& ...args)
+inline bool Vector<TYPE, ALLOC, GROWTH>::emplace_back(Args&& ...args)
 {
 	return this->_insert_back(std::forward<Args>(args)...);
 }
@@ -431,8 +525,8 @@ inline bool Vector<TYPE>::emplace_back(Args&& ...args)
 
 
 
-template<class TYPE>
-inline void Vector<TYPE>::clear()
+template<class TYPE, class ALLOC, class GROWTH>
+inline void Vector<TYPE, ALLOC, GROWTH>::clear()
 {
 	this->_clear();
 }
@@ -440,27 +534,273 @@ inline void Vector<TYPE>::clear()
 
 
 
-template<class TYPE>
-inline bool Vector<TYPE>::reserve(const size_t size)
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::reserve(const size_t size)
 {
 	return _reserve(size);
 }
 
 
 
-template<class TYPE>
-inline bool Vector<TYPE>::resize(const size_t requested_size)
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::resize(const size_t requested_size)
 {
 	return _resize(requested_size);
 }
 
 
 
+// new elements are copies of value, resize(size, 0) zeroes a trivial TYPE
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::resize(const size_t requested_size, const TYPE& value)
+{
+	if( requested_size <= _size )
+		return _resize(requested_size);
+
+	return this->insert(this->end(), requested_size - _size, value);
+}
+
+
+
+// new elements are left for the caller to write (e.g. read() into the tail), only for a trivial TYPE
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::resize_uninitialized(const size_t requested_size)
+{
+	static_assert(std::is_trivial<TYPE>::value, "resize_uninitialized needs a trivial TYPE");
+
+	if( requested_size > this->capacity() )
+		if( !this->reserve(requested_size) )
+			return false;
+
+	_size = requested_size;
+	return true;
+}
+
+
+
+// gives back the capacity beyond size(), keeps at least 1 element
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::shrink_to_fit()
+{
+	const size_t fit = _size > 0 ? _size : 1;
+
+	if( _data == nullptr || this->capacity() <= fit )
+		return true;
+
+	return _reserve(fit);
+}
+
+
+
+
+// the range may come from this Vector
+template<class TYPE, class ALLOC, class GROWTH>
+template<class T>
+bool Vector<TYPE, ALLOC, GROWTH>::append(const T* first, const T* last)
+{
+	ASSERT_MSG(first <= last, "append called with an invalid range");
+
+	const size_t count = static_cast<size_t>(last - first);
+	const bool owned = this->_owns(first);
+	const size_t firstOffset = owned ? static_cast<size_t>(reinterpret_cast<const TYPE*>(first) - _data) : 0;
+
+	if( !this->_grow_for(count) )
+		return false;
+
+	if( owned )
+		first = reinterpret_cast<const T*>(_data + firstOffset);
+
+	this->_fill(first, count, _data + _size);
+	_size += count;
+	return true;
+}
+
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+template<class T>
+bool Vector<TYPE, ALLOC, GROWTH>::insert(const TYPE* pos, const T* first, const T* last)
+{
+	ASSERT_MSG(pos >= _data && pos <= _data + _size, "insert position out of range");
+	ASSERT_MSG(first <= last, "insert called with an invalid range");
+	ASSERT_MSG(!this->_owns(first), "insert range can't come from the same Vector");
+
+	const size_t offset = static_cast<size_t>(pos - _data);
+	const size_t count = static_cast<size_t>(last - first);
+
+	TYPE* const gap = this->_open_gap(offset, count);
+
+	if( !gap )
+		return false;
+
+	UTIX_TRY_(
+		this->_fill(first, count, gap);
+	)
+	UTIX_CATCH_(...,
+		this->_close_gap(offset, count);
+		throw;
+	)
+
+	return true;
+}
+
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+bool Vector<TYPE, ALLOC, GROWTH>::insert(const TYPE* pos, const size_t count, const TYPE& value)
+{
+	ASSERT_MSG(pos >= _data && pos <= _data + _size, "insert position out of range");
+
+	// value might live in this Vector and move with the gap
+	const TYPE copy(value);
+	const size_t offset = static_cast<size_t>(pos - _data);
+
+	TYPE* const gap = this->_open_gap(offset, count);
+
+	if( !gap )
+		return false;
+
+	UTIX_TRY_(
+		this->_fill_value(copy, count, gap);
+	)
+	UTIX_CATCH_(...,
+		this->_close_gap(offset, count);
+		throw;
+	)
+
+	return true;
+}
+
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+bool Vector<TYPE, ALLOC, GROWTH>::insert(const TYPE* pos, TYPE&& value)
+{
+	ASSERT_MSG(pos >= _data && pos <= _data + _size, "insert position out of range");
+	ASSERT_MSG(!this->_owns(&value), "insert can't move from the same Vector");
+
+	const size_t offset = static_cast<size_t>(pos - _data);
+
+	TYPE* const gap = this->_open_gap(offset, 1);
+
+	if( !gap )
+		return false;
+
+	UTIX_TRY_(
+		new(gap) TYPE(std::move(value));
+	)
+	UTIX_CATCH_(...,
+		this->_close_gap(offset, 1);
+		throw;
+	)
+
+	return true;
+}
+
+
+
 
+template<class TYPE, class ALLOC, class GROWTH>
+TYPE* Vector<TYPE, ALLOC, GROWTH>::erase(const TYPE* first, const TYPE* last)
+{
+	ASSERT_MSG(first >= _data && first <= last && last <= _data + _size, "erase range out of range");
 
+	const size_t offset = static_cast<size_t>(first - _data);
+	const size_t count = static_cast<size_t>(last - first);
 
-template<class TYPE>
-inline void Vector<TYPE>::swap(Vector& other) noexcept
+	if( count )
+	{
+		this->_call_destructors(_data + offset, _data + offset + count);
+		this->_close_gap(offset, count);
+	}
+
+	return _data + offset;
+}
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+inline TYPE* Vector<TYPE, ALLOC, GROWTH>::erase(const TYPE* pos)
+{
+	return this->erase(pos, pos + 1);
+}
+
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+template<class T>
+bool Vector<TYPE, ALLOC, GROWTH>::assign(const T* first, const T* last)
+{
+	ASSERT_MSG(first <= last, "assign called with an invalid range");
+	ASSERT_MSG(!this->_owns(first), "assign range can't come from the same Vector");
+
+	const size_t count = static_cast<size_t>(last - first);
+
+	this->clear();
+
+	// nothing to keep, so a fresh block beats copying the old one
+	if( _data == nullptr || count > this->capacity() )
+	{
+		this->free();
+		if( !this->reserve_init(count) )
+			return false;
+	}
+
+	this->_fill(first, count, _data);
+	_size = count;
+	return true;
+}
+
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+bool Vector<TYPE, ALLOC, GROWTH>::assign(const size_t count, const TYPE& value)
+{
+	const TYPE copy(value);
+
+	this->clear();
+
+	if( _data == nullptr || count > this->capacity() )
+	{
+		this->free();
+		if( !this->reserve_init(count) )
+			return false;
+	}
+
+	this->_fill_value(copy, count, _data);
+	_size = count;
+	return true;
+}
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::assign(std::initializer_list<TYPE> list)
+{
+	return this->assign(list.begin(), list.end());
+}
+
+
+
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+inline const ALLOC& Vector<TYPE, ALLOC, GROWTH>::get_allocator() const noexcept
+{
+	return *this;
+}
+
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+inline void Vector<TYPE, ALLOC, GROWTH>::swap(Vector& other) noexcept
 {
 	if( this != &other )
 	{
@@ -470,6 +810,13 @@ inline void Vector<TYPE>::swap(Vector& other) noexcept
 		this->_size = other._size;
 		other._data = dataAux;
 		other._size = sizeAux;
+
+		// blocks belong to the allocator they came from
+		ALLOC& thisAlloc = *this;
+		ALLOC& otherAlloc = other;
+		ALLOC allocAux(static_cast<ALLOC&&>(thisAlloc));
+		thisAlloc = static_cast<ALLOC&&>(otherAlloc);
+		otherAlloc = static_cast<ALLOC&&>(allocAux);
 	}
 }
 
@@ -478,13 +825,13 @@ inline void Vector<TYPE>::swap(Vector& other) noexcept
 
 
 
-template<class TYPE>
-inline bool Vector<TYPE>::reserve_init(size_t requested_size)
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::reserve_init(size_t requested_size)
 {
 	if( _data == nullptr )
 	{
 		if( requested_size == 0 )
-			requested_size = 10;
+			requested_size = GROWTH::initial(sizeof(TYPE));
 
 		const size_t bytes_to_allocate = sizeof(TYPE) * requested_size;
 
@@ -494,31 +841,31 @@ inline bool Vector<TYPE>::reserve_init(size_t requested_size)
 		}
 
 
-		_data = alloc_arr<TYPE>(bytes_to_allocate);
+		_data = static_cast<TYPE*>(this->allocate(bytes_to_allocate));
 		return _data != nullptr;
 	}
 
 	return true;
 }
 
-template<class TYPE>
-inline bool Vector<TYPE>::check_capacity()
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::check_capacity()
 {
 	if( this->capacity() > _size )
 		return true;
 
-	return this->_reserve( _size * 2 );
+	return this->_reserve( GROWTH::next(this->capacity(), sizeof(TYPE)) );
 }
 
 
 
-template<class TYPE>
-inline void Vector<TYPE>::free() noexcept
+template<class TYPE, class ALLOC, class GROWTH>
+inline void Vector<TYPE, ALLOC, GROWTH>::free() noexcept
 {
 	if(_data)
 	{
 		this->clear();
-		free_arr(_data);
+		this->deallocate(_data);
 		_data = nullptr;
 	}
 }
@@ -526,15 +873,13 @@ inline void Vector<TYPE>::free() noexcept
 
 
 
-// Pod functions
-
-template<class TYPE>
-template<class U, class ...Args>
-inline enable_if_t<std::is_pod<U>::value == true,
-bool> Vector<TYPE>::_insert_back(Args&& ...args)
+template<class TYPE, class ALLOC, class GROWTH>
+template<class ...Args>
+inline bool Vector<TYPE, ALLOC, GROWTH>::_insert_back(Args&& ...args)
 {
 	if( check_capacity() ) {
-		_data[_size++] = TYPE(std::forward<Args>(args)...);
+		new(_data + _size) TYPE(std::forward<Args>(args)...);
+		++_size;
 		return true;
 	}
 
@@ -543,19 +888,110 @@ bool> Vector<TYPE>::_insert_back(Args&& ...args)
 
 
 
-template<class TYPE>
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+inline bool Vector<TYPE, ALLOC, GROWTH>::_owns(const void* ptr) const
+{
+	const void* const end = _data + _size;
+	return _data != nullptr && ptr >= _data && ptr < end;
+}
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+inline size_t Vector<TYPE, ALLOC, GROWTH>::_next_capacity(const size_t required) const
+{
+	const size_t next = GROWTH::next(this->capacity(), sizeof(TYPE));
+	return next > required ? next : required;
+}
+
+
+
+// makes room for 'count' more elements with a single reallocation
+template<class TYPE, class ALLOC, class GROWTH>
+bool Vector<TYPE, ALLOC, GROWTH>::_grow_for(const size_t count)
+{
+	const size_t required = _size + count;
+
+	if( required < _size ) {
+		LogError("Can't grow Vector by %zu elements", count);
+		return false;
+	}
+
+	if( _data == nullptr )
+		return this->reserve_init(required);
+
+	if( required <= this->capacity() )
+		return true;
+
+	return this->_reserve( this->_next_capacity(required) );
+}
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+void Vector<TYPE, ALLOC, GROWTH>::_fill_value(const TYPE& value, const size_t count, TYPE* dest)
+{
+	auto destItr = dest;
+	const auto destEnd = dest + count;
+
+	UTIX_TRY_(
+		for( ; destItr != destEnd; ++destItr)
+			new(destItr) TYPE(value);
+	)
+	UTIX_CATCH_(...,
+		_call_destructors(dest, destItr);
+		throw;
+	)
+}
+
+
+
+
+
+// Trivially copyable functions
+
+
+template<class TYPE, class ALLOC, class GROWTH>
 template<class U>
-inline enable_if_t<std::is_pod<U>::value == true> 
-Vector<TYPE>::_clear()
+inline enable_if_t<is_trivially_copyable<U>::value == true> 
+Vector<TYPE, ALLOC, GROWTH>::_clear()
 {
 	_size = 0;
 }
 
 
-template<class TYPE>
+
+template<class TYPE, class ALLOC, class GROWTH>
+template<class T, class U>
+inline enable_if_t<is_memcpyable<T, U>::value == true> 
+Vector<TYPE, ALLOC, GROWTH>::_fill(const T* src, const size_t size, TYPE* dest)
+{
+	if( size )
+		memcpy(dest, src, sizeof(TYPE) * size);
+}
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+template<class T, class U>
+inline enable_if_t<is_memcpyable<T, U>::value == true> 
+Vector<TYPE, ALLOC, GROWTH>::_fill_move(T* src, const size_t size, TYPE* dest)
+{
+	// trivially copyable types don't care about moving
+	this->_fill(src, size, dest);
+}
+
+
+
+// Trivially relocatable functions
+
+
+template<class TYPE, class ALLOC, class GROWTH>
 template<class U>
-enable_if_t<std::is_pod<U>::value == true, 
-bool> Vector<TYPE>::_reserve(size_t requested_size)
+enable_if_t<is_trivially_relocatable<U>::value == true, 
+bool> Vector<TYPE, ALLOC, GROWTH>::_reserve(size_t requested_size)
 {
 	ASSERT_MSG(_data != nullptr, "_reserve called before reserve_init");
 
@@ -566,7 +1002,8 @@ bool> Vector<TYPE>::_reserve(size_t requested_size)
 		return false;
 	}
 
-	TYPE* const buff = realloc_arr<TYPE>(_data, bytes_to_allocate);
+	// elements can change address bit by bit, let the allocator grow in place
+	TYPE* const buff = static_cast<TYPE*>(this->reallocate(_data, bytes_to_allocate));
 
 	if(buff)
 	{
@@ -579,10 +1016,51 @@ bool> Vector<TYPE>::_reserve(size_t requested_size)
 }
 
 
-template<class TYPE>
+
+template<class TYPE, class ALLOC, class GROWTH>
+template<class U>
+enable_if_t<is_trivially_relocatable<U>::value == true, 
+TYPE*> Vector<TYPE, ALLOC, GROWTH>::_open_gap(const size_t offset, const size_t count)
+{
+	if( !this->_grow_for(count) )
+		return nullptr;
+
+	// bytes are the whole state, shift the tail with one memmove
+	TYPE* const gap = _data + offset;
+	const size_t tail = _size - offset;
+
+	if( count && tail )
+		memmove(static_cast<void*>(gap + count), static_cast<const void*>(gap), sizeof(TYPE) * tail);
+
+	_size += count;
+	return gap;
+}
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
 template<class U>
-inline enable_if_t<std::is_pod<U>::value == true, 
-bool> Vector<TYPE>::_resize(const size_t requested_size)
+inline enable_if_t<is_trivially_relocatable<U>::value == true> 
+Vector<TYPE, ALLOC, GROWTH>::_close_gap(const size_t offset, const size_t count) noexcept
+{
+	TYPE* const gap = _data + offset;
+	const size_t tail = _size - offset - count;
+
+	if( count && tail )
+		memmove(static_cast<void*>(gap), static_cast<const void*>(gap + count), sizeof(TYPE) * tail);
+
+	_size -= count;
+}
+
+
+
+// Trivial functions
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+template<class U>
+inline enable_if_t<std::is_trivial<U>::value == true, 
+bool> Vector<TYPE, ALLOC, GROWTH>::_resize(const size_t requested_size)
 {
 	if(_size < requested_size)
 	{
@@ -600,71 +1078,81 @@ bool> Vector<TYPE>::_resize(const size_t requested_size)
 
 
 
-template<class TYPE>
-template<class T, class U>
-inline enable_if_t<std::is_pod<U>::value == true> 
-Vector<TYPE>::_fill(const T* src, const size_t size, TYPE* dest)
-{
-	const auto end = dest + size;
-	while(dest != end) 
-	{
-		*dest = *src;
-		++dest;
-		++src;
-	}
-}
 
 
+// Non-Trivially copyable functions
 
-template<class TYPE>
-template<class T, class U>
-inline enable_if_t<std::is_pod<U>::value == true> 
-Vector<TYPE>::_fill_move(T* src, const size_t size, TYPE* dest)
+
+template<class TYPE, class ALLOC, class GROWTH>
+template<class U>
+inline enable_if_t<is_trivially_copyable<U>::value == false> 
+Vector<TYPE, ALLOC, GROWTH>::_clear()
 {
-	// pod types don't care about moving
-	this->_fill(src, size, dest);
+	_call_destructors(this->begin(), this->end());
+	_size = 0;
 }
 
 
 
 
-
-
-
-// Non-Pod functions
-
-
-template<class TYPE>
-template<class U, class ...Args>
-inline enable_if_t<std::is_pod<U>::value == false,
-bool> Vector<TYPE>::_insert_back(Args&& ...args)
+template<class TYPE, class ALLOC, class GROWTH>
+template<class T, class U>
+inline enable_if_t<is_memcpyable<T, U>::value == false> 
+Vector<TYPE, ALLOC, GROWTH>::_fill(const T* src, const size_t size, TYPE* dest)
 {
-	if( check_capacity() ) {
-		new(_data + _size) TYPE(std::forward<Args>(args)...);
-		++_size;
-		return true;
-	}
+	auto destItr = dest;
+	const auto destEnd = dest + size;
 
-	return false;
+	UTIX_TRY_(
+		while(destItr != destEnd) 
+		{
+			new(destItr) TYPE((*src));
+			++destItr;
+			++src;
+		}
+	)
+	UTIX_CATCH_(...,
+		// exception was thrown, destroy the data
+		// that has been copied.
+		_call_destructors(dest, destItr);
+		throw;
+	)
 }
 
 
 
-template<class TYPE>
-template<class U>
-inline enable_if_t<std::is_pod<U>::value == false> 
-Vector<TYPE>::_clear()
+template<class TYPE, class ALLOC, class GROWTH>
+template<class T, class U>
+inline enable_if_t<is_memcpyable<T, U>::value == false> 
+Vector<TYPE, ALLOC, GROWTH>::_fill_move(T* src, const size_t size, TYPE* dest)
 {
-	_call_destructors(this->begin(), this->end());
-	_size = 0;
+	auto destItr = dest;
+	const auto destEnd = dest + size;
+	UTIX_TRY_(
+		while(destItr != destEnd) 
+		{
+			new(destItr) TYPE(std::move_if_noexcept(*src));
+			++destItr;
+			++src;
+		}
+	)
+	UTIX_CATCH_(...,
+		// exception was thrown, destroy the data
+		// that has been copied.
+		_call_destructors(dest, destItr);
+		throw;
+	)
 }
 
 
 
-template<class TYPE>
+// Non-Trivially relocatable functions
+
+
+template<class TYPE, class ALLOC, class GROWTH>
 template<class U>
-enable_if_t<std::is_pod<U>::value == false, 
-bool> Vector<TYPE>::_reserve(size_t requested_size)
+enable_if_t<is_trivially_relocatable<U>::value == false, 
+bool> Vector<TYPE, ALLOC, GROWTH>::_reserve(size_t requested_size)
 {
 	ASSERT_MSG(_data != nullptr, "_reserve called before reserve_init");
 
@@ -676,7 +1164,7 @@ bool> Vector<TYPE>::_reserve(size_t requested_size)
 		return false;
 	}
 
-	TYPE* const buff = alloc_arr<TYPE>( bytes_to_allocate );
+	TYPE* const buff = static_cast<TYPE*>(this->allocate(bytes_to_allocate));
 
 	if(!buff) 
 	{
@@ -691,13 +1179,13 @@ bool> Vector<TYPE>::_reserve(size_t requested_size)
 	UTIX_CATCH_(...,
 		// if exception is thrown, keeps the old _data
 		// and free buff
-		free_arr(buff);
+		this->deallocate(buff);
 		throw;
 	)
 
 	// if success then erase the old _data
 	_call_destructors(this->begin(), this->end());
-	free_arr(_data);
+	this->deallocate(_data);
 
 	_data = buff;
 	return true;	
@@ -705,11 +1193,100 @@ bool> Vector<TYPE>::_reserve(size_t requested_size)
 
 
 
+// element moves are expected not to throw here
+template<class TYPE, class ALLOC, class GROWTH>
+template<class U>
+enable_if_t<is_trivially_relocatable<U>::value == false, 
+TYPE*> Vector<TYPE, ALLOC, GROWTH>::_open_gap(const size_t offset, const size_t count)
+{
+	const size_t required = _size + count;
+
+	if( required < _size ) {
+		LogError("Can't grow Vector by %zu elements", count);
+		return nullptr;
+	}
+
+	if( _data == nullptr )
+	{
+		if( !this->reserve_init(required) )
+			return nullptr;
+	}
+	else if( required > this->capacity() )
+	{
+		// moving to a new block: prefix and tail go straight to their places
+		const size_t newCapacity = this->_next_capacity(required);
+		const size_t bytes_to_allocate = sizeof(TYPE) * newCapacity;
+
+		if( (bytes_to_allocate / sizeof(TYPE)) < newCapacity ) {
+			LogError("Can't allocate %zu elements of TYPE with size %zu", newCapacity, sizeof(TYPE));
+			return nullptr;
+		}
+
+		TYPE* const buff = static_cast<TYPE*>(this->allocate(bytes_to_allocate));
+
+		if( !buff ) {
+			LogError("Failed to reserve memory for Vector");
+			return nullptr;
+		}
+
+		this->_fill_move(_data, offset, buff);
+		this->_fill_move(_data + offset, _size - offset, buff + offset + count);
+		_call_destructors(this->begin(), this->end());
+		this->deallocate(_data);
+		_data = buff;
+		_size += count;
+		return _data + offset;
+	}
+
+	// same block: walk the tail up from the back
+	TYPE* const gap = _data + offset;
+	TYPE* src = _data + _size;
+	TYPE* dest = src + count;
 
-template<class TYPE>
+	while( count && src != gap )
+	{
+		--src;
+		--dest;
+		new(dest) TYPE(std::move(*src));
+		src->~TYPE();
+	}
+
+	_size += count;
+	return gap;
+}
+
+
+
+template<class TYPE, class ALLOC, class GROWTH>
+template<class U>
+enable_if_t<is_trivially_relocatable<U>::value == false> 
+Vector<TYPE, ALLOC, GROWTH>::_close_gap(const size_t offset, const size_t count) noexcept
+{
+	TYPE* dest = _data + offset;
+	TYPE* src = dest + count;
+	TYPE* const end = _data + _size;
+
+	if( !count )
+		return;
+
+	for( ; src != end; ++src, ++dest)
+	{
+		new(dest) TYPE(std::move(*src));
+		src->~TYPE();
+	}
+
+	_size -= count;
+}
+
+
+
+// Non-Trivial functions
+
+
+template<class TYPE, class ALLOC, class GROWTH>
 template<class U>
-enable_if_t<std::is_pod<U>::value == false, 
-bool> Vector<TYPE>::_resize(const size_t requested_size)
+enable_if_t<std::is_trivial<U>::value == false, 
+bool> Vector<TYPE, ALLOC, GROWTH>::_resize(const size_t requested_size)
 {
 	if( _size < requested_size )
 	{
@@ -729,7 +1306,7 @@ bool> Vector<TYPE>::_resize(const size_t requested_size)
 		UTIX_CATCH_(...,
 			// if exceptions is thrown
 			// preserve the ones who construct successful
-			_size = reinterpret_cast<size_t>(itr - _data);
+			_size = static_cast<size_t>(itr - _data);
 			throw;
 		)
 	}
@@ -746,61 +1323,14 @@ bool> Vector<TYPE>::_resize(const size_t requested_size)
 
 
 
-template<class TYPE>
-template<class T, class U>
-inline enable_if_t<std::is_pod<U>::value == false> 
-Vector<TYPE>::_fill(const T* src, const size_t size, TYPE* dest)
-{
-	auto destItr = dest;
-	const auto destEnd = dest + size;
-
-	UTIX_TRY_(
-		while(destItr != destEnd) 
-		{
-			new(destItr) TYPE((*src));
-			++destItr;
-			++src;
-		}
-	)
-	UTIX_CATCH_(...,
-		// exception was thrown, destroy the data
-		// that has been copied.
-		_call_destructors(dest, destItr);
-		throw;
-	)
-}
-
-
-
-
-
-
-
-
-
-
-
-template<class TYPE>
-template<class T, class U>
-inline enable_if_t<std::is_pod<U>::value == false> 
-Vector<TYPE>::_fill_move(T* src, const size_t size, TYPE* dest)
+template<class TYPE, class ALLOC, class GROWTH>
+inline void Vector<TYPE, ALLOC, GROWTH>::_call_destructors(TYPE* const begin, TYPE* end) noexcept
 {
-	auto destItr = dest;
-	const auto destEnd = dest + size;
-	UTIX_TRY_(
-		while(destItr != destEnd) 
-		{
-			new(destItr) TYPE(std::move_if_noexcept(*src));
-			++destItr;
-			++src;
-		}
-	)
-	UTIX_CATCH_(...,
-		// exception was thrown, destroy the data
-		// that has been copied.
-		_call_destructors(dest, destItr);
-		throw;
-	)
+	while(end != begin) 
+	{
+		--end;
+		end->~TYPE();
+	}
 }
 
 
@@ -809,23 +1339,13 @@ Vector<TYPE>::_fill_move(T* src, const size_t size, TYPE* dest)
 
 
 
+// stateless allocators must not make Vector any bigger
+static_assert(sizeof(Vector<int>) == sizeof(int*) + sizeof(size_t), "Vector<int> size changed");
 
 
-
-template<class TYPE>
-template<class U>
-inline enable_if_t<std::is_pod<U>::value == false,
-void> Vector<TYPE>::_call_destructors(TYPE* const begin, TYPE* end) noexcept
-{
-	while(end != begin) 
-	{
-		--end;
-		end->~TYPE();
-	}
-}
-
-
-
+// Vector with storage aligned to ALIGNMENT bytes
+template<class TYPE, size_t ALIGNMENT>
+using AlignedVector = Vector<TYPE, AlignedArrAlloc<ALIGNMENT>>;
 
 
 
@@ -0,0 +1,123 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// Algorithm.h scaling at 1, 2, 4, 8 and 16 threads. the calling thread
+// helps in Wait, so N threads is a pool of N - 1 workers. 1 thread is the
+// stopped pool, where every algorithm falls back to its serial std version.
+
+#include <stdio.h>
+#include <random>
+#include <Utix/Algorithm.h>
+#include <Utix/Vector.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t elements = 8 * 1000 * 1000;
+constexpr unsigned threadCounts[] = { 1, 2, 4, 8, 16 };
+constexpr int repeats = 3;
+
+
+// best of 'repeats', setup() runs untimed before each one
+template<class S, class F>
+double best_ms(S&& setup, F&& body)
+{
+	double best = 0;
+	for(int i = 0; i < repeats; ++i) {
+		setup();
+		const double ms = time_ms(body);
+		if( i == 0 || ms < best )
+			best = ms;
+	}
+	return best;
+}
+
+
+void report(const char* const name, const unsigned threads, const double ms, const double serial)
+{
+	printf("%-10s %2u threads %9.2f ms  (%5.2fx)\n", name, threads, ms, serial / ms);
+}
+
+
+}
+
+
+
+int main()
+{
+	Vector<uint32_t> input;
+	input.initialize(elements);
+
+	std::mt19937 rng(1234);
+	for(size_t i = 0; i < elements; ++i)
+		input.push_back(rng());
+
+	Vector<uint32_t> data;
+	data.initialize(input);
+
+	Vector<double> out;
+	out.initialize(elements);
+
+	// a value near the end, so find has to go through most of the range
+	const uint32_t needle = input[elements - (elements / 16)];
+	const auto nop = [] {};
+
+	double serial[4] = { 0, 0, 0, 0 };
+
+	for(const unsigned threads : threadCounts)
+	{
+		ThreadPool pool;
+		if( threads > 1 && !pool.Start(threads - 1) )
+			return 1;
+
+		const double sort = best_ms([&] { data.assign(input.begin(), input.end()); }, 
+		                            [&] { parallel_sort(pool, data); });
+
+		const double transform = best_ms(nop, [&] {
+			parallel_transform(pool, input, out, [](const uint32_t x) { return x * 0.5 + 1.0; });
+		});
+
+		uint64_t sum = 0;
+		const double reduce = best_ms(nop, [&] {
+			sum = parallel_reduce(pool, input, uint64_t(0), [](const uint64_t a, const uint64_t b) { return a + b; });
+		});
+
+		const uint32_t* found = nullptr;
+		const double find = best_ms(nop, [&] { found = parallel_find(pool, input, needle); });
+
+		if( threads == 1 ) {
+			serial[0] = sort;
+			serial[1] = transform;
+			serial[2] = reduce;
+			serial[3] = find;
+		}
+
+		report("sort", threads, sort, serial[0]);
+		report("transform", threads, transform, serial[1]);
+		report("reduce", threads, reduce, serial[2]);
+		report("find", threads, find, serial[3]);
+		printf("  (sum %llu, found at %zu)\n", static_cast<unsigned long long>(sum), 
+		       static_cast<size_t>(found - input.begin()));
+	}
+
+	return 0;
+}
@@ -0,0 +1,54 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#ifndef UTIX_BENCH_TIMER_H_
+#define UTIX_BENCH_TIMER_H_
+#include <chrono>
+
+
+// timing shared by the benchmarks
+
+// steady clock nanoseconds, for the benchmarks that take their own points in time
+inline double now_ns()
+{
+	using namespace std::chrono;
+	return duration<double, std::nano>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+// the average wall time of one of 'repeats' runs of body
+template<class F>
+inline double time_ns(F&& body, const int repeats = 1)
+{
+	const double begin = now_ns();
+	for(int i = 0; i < repeats; ++i)
+		body();
+	return (now_ns() - begin) / repeats;
+}
+
+
+template<class F>
+inline double time_ms(F&& body, const int repeats = 1)
+{
+	return time_ns(body, repeats) / 1e6;
+}
+
+
+#endif // UTIX_BENCH_TIMER_H_
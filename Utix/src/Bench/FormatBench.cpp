@@ -0,0 +1,114 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// FormatTo against snprintf into the same stack buffer:
+//   int      one int per call
+//   int x4   four ints with separators
+//   double   shortest round trip ({}) against %.17g, which also round trips
+//   %g       {:g} against %g, both through snprintf's rounding
+//   string   a short string with padding
+//   mixed    a typical log line
+
+#include <stdio.h>
+#include <random>
+#include <Utix/Format.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+using namespace utix::literals;
+
+namespace {
+
+constexpr size_t values = 1 << 16;
+constexpr int repeats = 20;
+
+int ints[values];
+double doubles[values];
+size_t sink = 0;
+
+
+// one call per value, body returns a length so the calls aren't optimized out
+template<class F>
+double per_call_ns(F&& body)
+{
+	return time_ns([&body] {
+		for(size_t i = 0; i < values; ++i)
+			sink += body(i);
+	}, repeats) / values;
+}
+
+
+void report(const char* const name, const double libc, const double format)
+{
+	printf("%-8s snprintf %7.1f ns  FormatTo %7.1f ns  (%5.1fx)\n", name, libc, format, libc / format);
+}
+
+
+}
+
+
+
+int main()
+{
+	std::mt19937_64 rng(1);
+	std::uniform_real_distribution<double> real(-1e6, 1e6);
+	for(size_t i = 0; i < values; ++i) {
+		ints[i] = static_cast<int>(rng());
+		doubles[i] = real(rng);
+	}
+
+	char buffer[256];
+
+	report("int",
+		per_call_ns([&buffer](size_t i) { return size_t(snprintf(buffer, sizeof(buffer), "%d", ints[i])); }),
+		per_call_ns([&buffer](size_t i) { return FormatTo(buffer, "{}"_fmt, ints[i]); }));
+
+	report("int x4",
+		per_call_ns([&buffer](size_t i) { 
+			return size_t(snprintf(buffer, sizeof(buffer), "%d, %d, %d, %d", 
+			              ints[i], ints[i ^ 1], ints[i ^ 2], ints[i ^ 3])); 
+		}),
+		per_call_ns([&buffer](size_t i) { 
+			return FormatTo(buffer, "{}, {}, {}, {}"_fmt, ints[i], ints[i ^ 1], ints[i ^ 2], ints[i ^ 3]); 
+		}));
+
+	report("double",
+		per_call_ns([&buffer](size_t i) { return size_t(snprintf(buffer, sizeof(buffer), "%.17g", doubles[i])); }),
+		per_call_ns([&buffer](size_t i) { return FormatTo(buffer, "{}"_fmt, doubles[i]); }));
+
+	report("%g",
+		per_call_ns([&buffer](size_t i) { return size_t(snprintf(buffer, sizeof(buffer), "%g", doubles[i])); }),
+		per_call_ns([&buffer](size_t i) { return FormatTo(buffer, "{:g}"_fmt, doubles[i]); }));
+
+	report("string",
+		per_call_ns([&buffer](size_t i) { return size_t(snprintf(buffer, sizeof(buffer), "[%-12s]", i & 1 ? "utix" : "format")); }),
+		per_call_ns([&buffer](size_t i) { return FormatTo(buffer, "[{:12}]"_fmt, i & 1 ? "utix" : "format"); }));
+
+	report("mixed",
+		per_call_ns([&buffer](size_t i) { 
+			return size_t(snprintf(buffer, sizeof(buffer), "frame %zu: %s took %.17g ms, %d draws", 
+			              i, "render", doubles[i], ints[i])); 
+		}),
+		per_call_ns([&buffer](size_t i) { 
+			return FormatTo(buffer, "frame {}: {} took {} ms, {} draws"_fmt, i, "render", doubles[i], ints[i]); 
+		}));
+
+	return sink == 0;
+}
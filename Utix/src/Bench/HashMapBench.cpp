@@ -0,0 +1,140 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// HashMap against std::unordered_map, ns per operation:
+//   insert   N distinct keys into an empty map
+//   hit      lookups of keys that are in the map
+//   miss     lookups of keys that are not
+//   erase    every key, in insertion order
+
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <Utix/HashMap.h>
+#include <Utix/Vector.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t elements = 1000 * 1000;
+volatile size_t sink;
+
+
+uint64_t next_key(uint64_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+
+struct UtixMap
+{
+	template<class K, class V>
+	struct Map
+	{
+		HashMap<K, V> map;
+		void insert(const K& key, V value) { map.insert(key, value); }
+		bool find(const K& key) const { return map.find(key) != nullptr; }
+		void erase(const K& key) { map.erase(key); }
+	};
+};
+
+
+struct StdMap
+{
+	template<class K, class V>
+	struct Map
+	{
+		std::unordered_map<K, V> map;
+		void insert(const K& key, V value) { map.emplace(key, value); }
+		bool find(const K& key) const { return map.find(key) != map.end(); }
+		void erase(const K& key) { map.erase(key); }
+	};
+};
+
+
+template<class IMPL, class K>
+void run(const char* const name, const Vector<K>& keys, const Vector<K>& missing)
+{
+	typename IMPL::template Map<K, size_t> map;
+
+	const double insert = time_ns([&] {
+		for(size_t i = 0; i < elements; ++i)
+			map.insert(keys[i], i);
+	}) / elements;
+
+	const double hit = time_ns([&] {
+		size_t found = 0;
+		for(size_t i = 0; i < elements; ++i)
+			found += map.find(keys[i]);
+		sink = found;
+	}) / elements;
+
+	const double miss = time_ns([&] {
+		size_t found = 0;
+		for(size_t i = 0; i < elements; ++i)
+			found += map.find(missing[i]);
+		sink = found;
+	}) / elements;
+
+	const double erase = time_ns([&] {
+		for(size_t i = 0; i < elements; ++i)
+			map.erase(keys[i]);
+	}) / elements;
+
+	printf("%-28s insert %6.1f  hit %6.1f  miss %6.1f  erase %6.1f ns/op\n", 
+	       name, insert, hit, miss, erase);
+}
+
+
+}
+
+
+
+int main()
+{
+	Vector<uint64_t> intKeys, intMissing;
+	Vector<std::string> strKeys, strMissing;
+	intKeys.initialize(elements);
+	intMissing.initialize(elements);
+	strKeys.initialize(elements);
+	strMissing.initialize(elements);
+
+	// odd keys are in the map, even keys miss
+	uint64_t state = 0x2545F4914F6CDD1Dull;
+	for(size_t i = 0; i < elements; ++i) 
+	{
+		const uint64_t key = next_key(state);
+		intKeys.push_back(key | 1);
+		intMissing.push_back(key & ~uint64_t(1));
+		strKeys.push_back("key_" + std::to_string(key | 1));
+		strMissing.push_back("key_" + std::to_string(key & ~uint64_t(1)));
+	}
+
+	run<UtixMap>("HashMap<uint64_t>", intKeys, intMissing);
+	run<StdMap>("unordered_map<uint64_t>", intKeys, intMissing);
+	run<UtixMap>("HashMap<std::string>", strKeys, strMissing);
+	run<StdMap>("unordered_map<std::string>", strKeys, strMissing);
+	return 0;
+}
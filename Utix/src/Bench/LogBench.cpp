@@ -0,0 +1,82 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// cost of a Log call on the calling thread, and with the writer's work included:
+//   sync     vfprintf to stdout
+//   async    vsnprintf into the thread's ring (StartAsyncLog)
+//   binary   format pointer, time and arguments only (StartBinaryLog)
+// stdout goes to /dev/null. LogBench [binary log path]
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <Utix/Log.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr int lines = 500 * 1000;
+constexpr size_t bufferSize = 8 * 1024 * 1024;
+
+
+void run(const char* const name)
+{
+	const double begin = now_ns();
+	for(int i = 0; i < lines; ++i)
+		Log("request %d from %s took %.3f ms, status %u", i, "10.0.0.1", i * 0.25, 200u);
+	const double logged = now_ns();
+	FlushLogs();
+	const double flushed = now_ns();
+
+	fprintf(stderr, "%-8s %7.1f ns per call  %7.1f ns per line written\n", name,
+	        (logged - begin) / lines, (flushed - begin) / lines);
+}
+
+
+}
+
+
+
+int main(int argc, char** argv)
+{
+	const char* const path = argc > 1 ? argv[1] : "/tmp/utix_log_bench.bin";
+
+	const int null = open("/dev/null", O_WRONLY);
+	if( null < 0 || dup2(null, 1) < 0 ) {
+		perror("/dev/null");
+		return 1;
+	}
+
+	run("sync");
+
+	if( !StartAsyncLog(bufferSize, LogOverflow::Block) )
+		return 1;
+	run("async");
+	StopAsyncLog();
+
+	if( !StartBinaryLog(path, bufferSize, LogOverflow::Block) )
+		return 1;
+	run("binary");
+	StopAsyncLog();
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// grows a big byte buffer by doubling, touching every new byte,
+// with plain malloc/realloc and with alloc_arr/realloc_arr.
+// reports time, minor page faults and resident memory of each.
+// usage: MmapBench [size in MB]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Utix/Alloc.h>
+#include "BenchTimer.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+using namespace utix;
+
+namespace {
+
+#if defined(__linux__)
+
+long minor_faults()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_minflt;
+}
+
+
+size_t resident_bytes()
+{
+	long pages = 0;
+	FILE* const statm = fopen("/proc/self/statm", "r");
+	if(statm) {
+		if(fscanf(statm, "%*s %ld", &pages) != 1)
+			pages = 0;
+		fclose(statm);
+	}
+
+	return static_cast<size_t>(pages) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+
+
+struct MallocPolicy
+{
+	static const char* name() { return "malloc"; }
+	static void* alloc(const size_t bytes) { return malloc(bytes); }
+	static void* realloc(void* from, const size_t bytes) { return ::realloc(from, bytes); }
+	static void free(void* block) { ::free(block); }
+};
+
+
+struct AllocArrPolicy
+{
+	static const char* name() { return "alloc_arr"; }
+	static void* alloc(const size_t bytes) { return alloc_arr(bytes); }
+	static void* realloc(void* from, const size_t bytes) { return realloc_arr(from, bytes); }
+	static void free(void* block) { free_arr(block); }
+};
+
+
+
+template<class Policy>
+void run(const size_t target)
+{
+	const long faultsBegin = minor_faults();
+	const double begin = now_ns();
+
+	size_t size = 1024 * 1024;
+	auto* buffer = static_cast<uint8_t*>(Policy::alloc(size));
+	memset(buffer, 1, size);
+
+	while(buffer && size < target)
+	{
+		const size_t newSize = size * 2;
+		buffer = static_cast<uint8_t*>(Policy::realloc(buffer, newSize));
+		if(buffer)
+			memset(buffer + size, 1, newSize - size);
+		size = newSize;
+	}
+
+	if(!buffer) {
+		printf("%-10s allocation failed\n", Policy::name());
+		return;
+	}
+
+	const double msecs = (now_ns() - begin) / 1e6;
+	const long faults = minor_faults() - faultsBegin;
+	const size_t rss = resident_bytes();
+
+	printf("%-10s %6zu MB  %9.2f ms  %8ld minor faults  %6zu MB resident\n",
+	       Policy::name(), size >> 20, msecs, faults, rss >> 20);
+
+	Policy::free(buffer);
+}
+
+#endif
+
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+#if defined(__linux__)
+	const size_t megas = argc > 1 ? strtoul(argv[1], nullptr, 10) : 256;
+	if( UTIX_MMAP_THRESHOLD == 0 )
+		printf("mmap threshold: off, configure with -DUTIX_MMAP_THRESHOLD=<bytes>\n");
+	else
+		printf("mmap threshold: %zu bytes\n", static_cast<size_t>(UTIX_MMAP_THRESHOLD));
+	run<MallocPolicy>(megas * 1024 * 1024);
+	run<AllocArrPolicy>(megas * 1024 * 1024);
+#else
+	((void)argc);
+	((void)argv);
+	printf("MmapBench needs Linux\n");
+#endif
+	return 0;
+}
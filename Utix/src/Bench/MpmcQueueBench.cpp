@@ -0,0 +1,110 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// MpmcQueue throughput over a producers x consumers matrix, in M items/s.
+// everyone uses the blocking push / pop, so oversubscribed runs show
+// the futex sleeps rather than burning the cores.
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <Utix/MpmcQueue.h>
+#include <Utix/Vector.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t items = 4 * 1000 * 1000;
+constexpr size_t queueSize = 1024;
+constexpr int counts[] = { 1, 2, 4, 8 };
+
+
+double run(const int producers, const int consumers)
+{
+	MpmcQueue<uint64_t> queue;
+	queue.initialize(queueSize);
+
+	std::atomic<uint64_t> sum{0};
+	Vector<std::thread> threads;
+	threads.initialize(static_cast<size_t>(producers + consumers));
+
+	const double begin = now_ns();
+
+	// items are split evenly, the first threads take the remainder
+	for(int p = 0; p < producers; ++p)
+	{
+		const size_t share = (items / producers) + (static_cast<size_t>(p) < items % producers);
+		const size_t first = p * (items / producers) + std::min<size_t>(p, items % producers);
+		threads.emplace_back([&queue, share, first] {
+			for(size_t i = 0; i < share; ++i)
+				queue.push(first + i);
+		});
+	}
+
+	for(int c = 0; c < consumers; ++c)
+	{
+		const size_t share = (items / consumers) + (static_cast<size_t>(c) < items % consumers);
+		threads.emplace_back([&queue, &sum, share] {
+			uint64_t local = 0, value;
+			for(size_t i = 0; i < share; ++i) {
+				queue.pop(value);
+				local += value;
+			}
+			sum += local;
+		});
+	}
+
+	for(auto& thread : threads)
+		thread.join();
+
+	const double secs = (now_ns() - begin) / 1e9;
+
+	if( sum != (uint64_t(items) * (items - 1)) / 2 )
+		printf("checksum mismatch at %d x %d\n", producers, consumers);
+
+	return (items / secs) / 1e6;
+}
+
+
+}
+
+
+
+int main()
+{
+	printf("%u hardware threads\n", std::thread::hardware_concurrency());
+	printf("prod\\cons");
+	for(const int consumers : counts)
+		printf(" %7d", consumers);
+	printf("\n");
+
+	for(const int producers : counts)
+	{
+		printf("%9d", producers);
+		for(const int consumers : counts)
+			printf(" %7.1f", run(producers, consumers));
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// radix_sort against std::sort, 1K to 100M elements, for uint32_t, uint64_t
+// and 16 byte key/value pairs. the parallel column runs the histogram on a
+// ThreadPool with a worker per hardware thread.
+// usage: RadixSortBench [max elements], 100M needs about 5GB for the pairs
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <Utix/RadixSort.h>
+#include <Utix/ThreadPool.h>
+#include <Utix/Vector.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+struct Pair
+{
+	uint64_t key;
+	uint64_t value;
+};
+
+
+template<class T, class K, class Gen>
+bool run(ThreadPool& pool, const char* const name, const size_t count, K key, Gen gen)
+{
+	Vector<T> input, data;
+	if( !input.initialize(count) || !data.initialize(count) )
+		return false;
+
+	for(size_t i = 0; i < count; ++i)
+		input.push_back(gen());
+
+	const auto less = [&key](const T& a, const T& b) { return key(a) < key(b); };
+
+	data.assign(input.begin(), input.end());
+	const double stdsort = time_ms([&] { std::sort(data.begin(), data.end(), less); });
+
+	data.assign(input.begin(), input.end());
+	const double radix = time_ms([&] { radix_sort(data, key); });
+
+	data.assign(input.begin(), input.end());
+	const double parallel = time_ms([&] { radix_sort(pool, data, key); });
+
+	printf("%-9s %10zu  std::sort %10.3f ms  radix %10.3f ms (%5.1fx)  parallel histogram %10.3f ms (%5.1fx)\n",
+	       name, count, stdsort, radix, stdsort / radix, parallel, stdsort / parallel);
+	return true;
+}
+
+
+}
+
+
+
+int main(int argc, char** argv)
+{
+	const size_t max = argc > 1 ? strtoull(argv[1], nullptr, 10) : size_t(100) * 1000 * 1000;
+
+	ThreadPool pool;
+	if( !pool.Start() )
+		return EXIT_FAILURE;
+
+	std::mt19937_64 rng(99);
+
+	for(size_t count = 1000; count <= max; count *= 10)
+	{
+		const bool ok = run<uint32_t>(pool, "uint32_t", count, [](const uint32_t x) { return x; }, 
+		                              [&rng] { return static_cast<uint32_t>(rng()); })
+		             && run<uint64_t>(pool, "uint64_t", count, [](const uint64_t x) { return x; }, 
+		                              [&rng] { return rng(); })
+		             && run<Pair>(pool, "pair", count, [](const Pair& p) { return p.key; }, 
+		                          [&rng] { return Pair { rng(), rng() }; });
+		if( !ok )
+			return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
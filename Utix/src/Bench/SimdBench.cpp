@@ -0,0 +1,125 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// Simd.h kernels in GB/s, for every ISA this cpu runs, on a buffer that
+// stays in L2 and on one that streams from memory.
+// the bytes counted are the ones each kernel reads and writes
+
+#include <stdio.h>
+#include <Utix/Simd.h>
+#include <Utix/Vector.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t sizes[] = { 64 * 1024, 64 * 1024 * 1024 };
+constexpr double minSeconds = 0.2;
+
+volatile uint64_t sink;
+
+
+// repeats body until minSeconds went by
+template<class F>
+double gb_per_s(const size_t bytes, F&& body)
+{
+	const double begin = now_ns();
+	size_t rounds = 0;
+	double seconds;
+	do {
+		body();
+		++rounds;
+		seconds = (now_ns() - begin) / 1e9;
+	} while( seconds < minSeconds );
+	return (double(bytes) * rounds) / seconds / 1e9;
+}
+
+
+void run(const size_t bytes)
+{
+	const size_t floats = bytes / sizeof(float);
+	Vector<float> x, y;
+	Vector<int32_t> ints;
+	Vector<uint8_t> chars;
+	x.initialize();
+	y.initialize();
+	ints.initialize();
+	chars.initialize();
+	if( !x.resize(floats) || !y.resize(floats) || !ints.resize(floats) || !chars.resize(bytes) )
+		return;
+
+	for(size_t i = 0; i < floats; ++i) {
+		x[i] = float(i % 1000) * 0.001f;
+		y[i] = 1.0f;
+		ints[i] = int32_t(i % 1000);
+	}
+	for(size_t i = 0; i < bytes; ++i)
+		chars[i] = uint8_t(i % 200);
+
+	printf("\n%zu KiB buffers\n%-10s", bytes / 1024, "kernel");
+	for(int isa = 0; isa <= static_cast<int>(SimdIsa::Avx512); ++isa)
+		if( set_simd_isa(static_cast<SimdIsa>(isa)) )
+			printf("%10s", get_simd_isa_name(static_cast<SimdIsa>(isa)));
+	printf("\n");
+
+	struct Kernel { const char* name; size_t bytes; void (*body)(Vector<float>&, Vector<float>&, Vector<int32_t>&, Vector<uint8_t>&); };
+	const Kernel kernels[] = {
+		{ "sum f32", bytes, [](Vector<float>& x, Vector<float>&, Vector<int32_t>&, Vector<uint8_t>&) { sink = uint64_t(simd_sum(x)); } },
+		{ "sum i32", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>& i, Vector<uint8_t>&) { sink = uint64_t(simd_sum(i)); } },
+		{ "sum u8", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>&, Vector<uint8_t>& c) { sink = simd_sum(c); } },
+		{ "min f32", bytes, [](Vector<float>& x, Vector<float>&, Vector<int32_t>&, Vector<uint8_t>&) { sink = uint64_t(simd_min(x)); } },
+		{ "max i32", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>& i, Vector<uint8_t>&) { sink = uint64_t(simd_max(i)); } },
+		{ "max u8", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>&, Vector<uint8_t>& c) { sink = simd_max(c); } },
+		{ "dot f32", bytes * 2, [](Vector<float>& x, Vector<float>& y, Vector<int32_t>&, Vector<uint8_t>&) { sink = uint64_t(simd_dot(x, y)); } },
+		{ "axpy f32", bytes * 3, [](Vector<float>& x, Vector<float>& y, Vector<int32_t>&, Vector<uint8_t>&) { simd_axpy(1e-9f, x, y); } },
+		{ "scale f32", bytes * 2, [](Vector<float>&, Vector<float>& y, Vector<int32_t>&, Vector<uint8_t>&) { simd_scale(y, 1.0f); } },
+		{ "fill f32", bytes, [](Vector<float>&, Vector<float>& y, Vector<int32_t>&, Vector<uint8_t>&) { simd_fill(y, 1.0f); } },
+		{ "fill i32", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>& i, Vector<uint8_t>&) { simd_fill(i, int32_t(3)); } },
+		{ "count i32", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>& i, Vector<uint8_t>&) { sink = simd_count(i, int32_t(3)); } },
+		{ "count u8", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>&, Vector<uint8_t>& c) { sink = simd_count(c, uint8_t(7)); } },
+		{ "find i32", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>& i, Vector<uint8_t>&) { sink = simd_find(i, int32_t(-1)); } },
+		{ "find u8", bytes, [](Vector<float>&, Vector<float>&, Vector<int32_t>&, Vector<uint8_t>& c) { sink = simd_find(c, uint8_t(255)); } },
+	};
+
+	for(const Kernel& kernel : kernels)
+	{
+		printf("%-10s", kernel.name);
+		for(int isa = 0; isa <= static_cast<int>(SimdIsa::Avx512); ++isa) {
+			if( !set_simd_isa(static_cast<SimdIsa>(isa)) )
+				continue;
+			printf("%10.1f", gb_per_s(kernel.bytes, [&] { kernel.body(x, y, ints, chars); }));
+		}
+		printf("\n");
+	}
+}
+
+
+}
+
+
+
+int main()
+{
+	printf("best ISA: %s\n", get_simd_isa_name(get_simd_isa()));
+	for(const size_t bytes : sizes)
+		run(bytes);
+	return 0;
+}
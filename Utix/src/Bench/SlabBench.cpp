@@ -0,0 +1,125 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// compares the slab allocator with plain malloc
+// across 1, 4 and N threads doing small mixed-size alloc / free churn.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+#include <Utix/Alloc.h>
+#include <Utix/Slab.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t ops_per_thread = 4 * 1000 * 1000;
+constexpr size_t live_blocks = 1024;
+
+
+struct MallocPolicy
+{
+	static const char* name() { return "malloc"; }
+	static void* alloc(const size_t bytes) { return malloc(bytes); }
+	static void free(void* block, const size_t) { ::free(block); }
+};
+
+
+struct SlabPolicy
+{
+	static const char* name() { return "slab"; }
+	static void* alloc(const size_t bytes) { return slab_alloc(bytes); }
+	static void free(void* block, const size_t bytes) { slab_free(block, bytes); }
+};
+
+
+struct AllocArrPolicy
+{
+	static const char* name() { return "alloc_arr"; }
+	static void* alloc(const size_t bytes) { return alloc_arr(bytes); }
+	static void free(void* block, const size_t) { free_arr(block); }
+};
+
+
+
+template<class Policy>
+void churn(unsigned seed)
+{
+	void* blocks[live_blocks] = { };
+	size_t sizes[live_blocks] = { };
+
+	for(size_t i = 0; i < ops_per_thread; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		const size_t slot = (seed >> 8) % live_blocks;
+		if(blocks[slot])
+			Policy::free(blocks[slot], sizes[slot]);
+
+		sizes[slot] = 8 + ((seed >> 16) % (SlabMaxBlockSize - 16));
+		blocks[slot] = Policy::alloc(sizes[slot]);
+		static_cast<volatile uint8_t*>(blocks[slot])[0] = 1;
+	}
+
+	for(size_t i = 0; i < live_blocks; ++i)
+		if(blocks[i])
+			Policy::free(blocks[i], sizes[i]);
+}
+
+
+
+template<class Policy>
+void run(const unsigned threads)
+{
+	const double secs = time_ns([threads] {
+		std::vector<std::thread> workers;
+		for(unsigned i = 0; i < threads; ++i)
+			workers.emplace_back(churn<Policy>, i + 1);
+
+		for(auto& worker : workers)
+			worker.join();
+	}) / 1e9;
+	const double ops = static_cast<double>(ops_per_thread) * threads;
+	printf("%-10s threads: %2u  %8.2f Mops/s  %6.2f ns/op\n", 
+	       Policy::name(), threads, (ops / secs) / 1e6, (secs * 1e9) / ops);
+}
+
+
+}
+
+
+
+
+int main()
+{
+	const unsigned hw = std::thread::hardware_concurrency();
+	const unsigned counts[] = { 1, 4, hw ? hw : 1 };
+
+	for(const auto threads : counts) 
+	{
+		run<MallocPolicy>(threads);
+		run<SlabPolicy>(threads);
+		run<AllocArrPolicy>(threads);
+	}
+
+	return 0;
+}
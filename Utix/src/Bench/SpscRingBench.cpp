@@ -0,0 +1,204 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// SpscRing between two threads pinned to different cores, when there are two:
+//   single    push / pop one message at a time
+//   batched   push_n / pop_n of 64 messages
+//   spans     write_reserve / read_peek, no copies
+//   latency   ping-pong over two rings, half the round trip
+
+#include <stdio.h>
+#include <thread>
+#include <Utix/SpscRing.h>
+#include "BenchTimer.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t messages = 20 * 1000 * 1000;
+constexpr size_t pings = 200 * 1000;
+constexpr size_t ringSize = 4096;
+constexpr size_t batch = 64;
+
+
+void pin(const unsigned cpu)
+{
+#ifdef __linux__
+	if( std::thread::hardware_concurrency() < 2 )
+		return;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	((void)cpu);
+#endif
+}
+
+
+// waiting side backs off to the scheduler, with one core both sides must get to run
+inline void relax()
+{
+	std::this_thread::yield();
+}
+
+
+template<class PRODUCER, class CONSUMER>
+void throughput(const char* const name, PRODUCER&& produce, CONSUMER&& consume)
+{
+	SpscRing<uint64_t> ring;
+	ring.initialize(ringSize);
+
+	uint64_t sum = 0;
+	const double secs = time_ns([&] {
+		std::thread producer([&] { pin(1); produce(ring); });
+		pin(0);
+		sum = consume(ring);
+		producer.join();
+	}) / 1e9;
+
+	const bool ok = sum == (uint64_t(messages) * (messages - 1)) / 2;
+	printf("%-8s %8.1f M msgs/s %s\n", name, (messages / secs) / 1e6, ok ? "" : "(CHECKSUM MISMATCH)");
+}
+
+
+void latency()
+{
+	SpscRing<uint64_t> ping, pong;
+	ping.initialize(16);
+	pong.initialize(16);
+
+	std::thread echo([&] {
+		pin(1);
+		uint64_t value;
+		for(size_t i = 0; i < pings; ++i) {
+			while( !ping.pop(value) )
+				relax();
+			while( !pong.push(value) )
+				relax();
+		}
+	});
+
+	pin(0);
+	const double ns = time_ns([&ping, &pong] {
+		uint64_t value;
+		for(size_t i = 0; i < pings; ++i) {
+			ping.push(i);
+			while( !pong.pop(value) )
+				relax();
+		}
+	});
+	echo.join();
+	printf("%-8s %8.1f ns one way\n", "latency", ns / pings / 2);
+}
+
+
+}
+
+
+
+int main()
+{
+	if( std::thread::hardware_concurrency() < 2 )
+		printf("single cpu: threads are not pinned, numbers show scheduling cost\n");
+
+	throughput("single", 
+		[](SpscRing<uint64_t>& ring) {
+			for(uint64_t i = 0; i < messages; ++i)
+				while( !ring.push(i) )
+					relax();
+		},
+		[](SpscRing<uint64_t>& ring) {
+			uint64_t sum = 0, value;
+			for(size_t i = 0; i < messages; ++i) {
+				while( !ring.pop(value) )
+					relax();
+				sum += value;
+			}
+			return sum;
+		});
+
+	throughput("batched",
+		[](SpscRing<uint64_t>& ring) {
+			uint64_t items[batch];
+			for(uint64_t i = 0; i < messages; ) {
+				size_t count = 0;
+				for( ; count < batch && i + count < messages; ++count)
+					items[count] = i + count;
+
+				for(size_t pushed = 0; pushed < count; ) {
+					const size_t n = ring.push_n(items + pushed, count - pushed);
+					if( n == 0 )
+						relax();
+					pushed += n;
+				}
+
+				i += count;
+			}
+		},
+		[](SpscRing<uint64_t>& ring) {
+			uint64_t sum = 0, items[batch];
+			for(size_t i = 0; i < messages; ) {
+				const size_t n = ring.pop_n(items, batch);
+				if( n == 0 )
+					relax();
+				for(size_t j = 0; j < n; ++j)
+					sum += items[j];
+				i += n;
+			}
+			return sum;
+		});
+
+	throughput("spans",
+		[](SpscRing<uint64_t>& ring) {
+			for(uint64_t i = 0; i < messages; ) {
+				const auto span = ring.write_reserve(messages - i);
+				if( span.size == 0 )
+					relax();
+				for(size_t j = 0; j < span.size; ++j)
+					span.data[j] = i + j;
+				ring.write_commit(span.size);
+				i += span.size;
+			}
+		},
+		[](SpscRing<uint64_t>& ring) {
+			uint64_t sum = 0;
+			for(size_t i = 0; i < messages; ) {
+				const auto span = ring.read_peek(messages - i);
+				if( span.size == 0 )
+					relax();
+				for(size_t j = 0; j < span.size; ++j)
+					sum += span.data[j];
+				ring.read_release(span.size);
+				i += span.size;
+			}
+			return sum;
+		});
+
+	latency();
+	return 0;
+}
@@ -0,0 +1,92 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// builds and drops many short-lived Vectors with each array allocator,
+// the scratch vector pattern that custom allocators are meant for.
+
+#include <stdio.h>
+#include <Utix/Vector.h>
+#include <Utix/Arena.h>
+#include <Utix/Slab.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t rounds = 200 * 1000;
+constexpr size_t elements = 48;
+
+
+template<class ALLOC>
+size_t build(const ALLOC& alloc, const size_t round)
+{
+	Vector<int, ALLOC> vec(alloc);
+	vec.initialize(8);
+
+	for(size_t i = 0; i < elements; ++i)
+		vec.push_back(static_cast<int>(i + round));
+
+	return static_cast<size_t>(vec[elements - 1]);
+}
+
+
+template<class F>
+void run(const char* const name, F&& body)
+{
+	size_t sink = 0;
+	const double nsecs = time_ns([&sink, &body] {
+		for(size_t round = 0; round < rounds; ++round)
+			sink += body(round);
+	});
+	printf("%-16s %8.2f ns/vector  (%zu)\n", name, nsecs / rounds, sink);
+}
+
+
+}
+
+
+
+
+int main()
+{
+	run("DefaultArrAlloc", [](size_t round) { 
+		return build(DefaultArrAlloc(), round); 
+	});
+
+	run("SlabArrAlloc", [](size_t round) { 
+		return build(SlabArrAlloc(), round); 
+	});
+
+	Arena arena;
+	run("ArenaArrAlloc", [&arena](size_t round) {
+		ArenaScope scope(arena);
+		return build(ArenaArrAlloc(arena), round);
+	});
+
+	alignas(16) uint8_t buffer[4096];
+	Arena stackArena(buffer, sizeof(buffer));
+	run("stack buffer", [&stackArena](size_t round) {
+		ArenaScope scope(stackArena);
+		return build(ArenaArrAlloc(stackArena), round);
+	});
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// Vector growth and copy throughput per type category:
+//   int          trivial: realloc growth, memcpy copies
+//   Color        trivially copyable: realloc growth, memcpy copies
+//   unique_ptr   trivially relocatable: realloc growth
+//   std::string  none of the above: element by element
+
+#include <stdio.h>
+#include <memory>
+#include <string>
+#include <Utix/Vector.h>
+#include <Utix/Memory.h>
+#include <Utix/Color.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t elements = 4 * 1000 * 1000;
+constexpr int repeats = 5;
+
+
+template<class T, class Make>
+void grow(const char* const name, Make&& make)
+{
+	const double ns = time_ns([&make] {
+		Vector<T> vec;
+		vec.initialize();
+		for(size_t i = 0; i < elements; ++i)
+			vec.push_back(make(i));
+	}, repeats);
+
+	printf("%-12s growth  %7.2f ns/elem\n", name, ns / elements);
+}
+
+
+template<class T, class Make>
+void copy(const char* const name, Make&& make)
+{
+	Vector<T> src;
+	src.initialize(elements);
+	for(size_t i = 0; i < elements; ++i)
+		src.push_back(make(i));
+
+	const double ns = time_ns([&src] {
+		Vector<T> dest;
+		dest.initialize(src);
+	}, repeats);
+
+	printf("%-12s copy    %7.2f ns/elem  %7.2f GB/s\n", name, ns / elements, 
+	       static_cast<double>(sizeof(T) * elements) / ns);
+}
+
+
+}
+
+
+
+int main()
+{
+	const auto makeInt = [](size_t i) { return static_cast<int>(i); };
+	const auto makeColor = [](size_t i) { return Color(i & 0xff, (i >> 8) & 0xff, 0); };
+	const auto makePtr = [](size_t) { return std::unique_ptr<int>(); };
+	const auto makeString = [](size_t) { return std::string("utix"); };
+
+	grow<int>("int", makeInt);
+	copy<int>("int", makeInt);
+	grow<Color>("Color", makeColor);
+	copy<Color>("Color", makeColor);
+	grow<std::unique_ptr<int>>("unique_ptr", makePtr);
+	grow<std::string>("std::string", makeString);
+	copy<std::string>("std::string", makeString);
+	return 0;
+}
@@ -0,0 +1,161 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// Vector range operations against the push_back loops they replace:
+//   append   bulk load into an empty Vector
+//   insert   blocks inserted in the middle
+//   erase    blocks erased from the middle
+//   assign   reload of a Vector that already has the capacity
+
+#include <stdio.h>
+#include <string>
+#include <Utix/Vector.h>
+#include "BenchTimer.h"
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t elements = 1000 * 1000;
+constexpr size_t block = 64;
+constexpr size_t edits = 2000;
+constexpr int repeats = 5;
+
+
+void report(const char* const name, const char* const op, const double loop, const double range)
+{
+	printf("%-12s %-7s push_back loop %10.0f us  range %10.0f us  (%5.1fx)\n",
+	       name, op, loop / 1000, range / 1000, loop / range);
+}
+
+
+// the loop versions rebuild the Vector around the edit, as callers had to
+template<class T>
+void run(const char* const name, const Vector<T>& src)
+{
+	const T* const first = src.begin();
+	const T* const last = src.end();
+
+	double loop = time_ns([first, last] {
+		Vector<T> vec;
+		vec.initialize();
+		for(const T* itr = first; itr != last; ++itr)
+			vec.push_back(*itr);
+	}, repeats);
+
+	double range = time_ns([first, last] {
+		Vector<T> vec;
+		vec.initialize();
+		vec.append(first, last);
+	}, repeats);
+
+	report(name, "append", loop, range);
+
+
+	Vector<T> base;
+	base.initialize(src.begin(), src.begin() + (elements / 10));
+	const size_t mid = base.size() / 2;
+
+	loop = time_ns([&base, first, mid] {
+		Vector<T> vec;
+		vec.initialize(base);
+		for(size_t e = 0; e < edits / 100; ++e) {
+			Vector<T> rebuilt;
+			rebuilt.initialize(vec.size() + block);
+			for(size_t i = 0; i < mid; ++i)
+				rebuilt.push_back(vec[i]);
+			for(size_t i = 0; i < block; ++i)
+				rebuilt.push_back(first[i]);
+			for(size_t i = mid; i < vec.size(); ++i)
+				rebuilt.push_back(vec[i]);
+			vec.swap(rebuilt);
+		}
+	}, repeats);
+
+	range = time_ns([&base, first, mid] {
+		Vector<T> vec;
+		vec.initialize(base);
+		for(size_t e = 0; e < edits / 100; ++e)
+			vec.insert(vec.begin() + mid, first, first + block);
+	}, repeats);
+
+	report(name, "insert", loop, range);
+
+
+	loop = time_ns([&base, mid] {
+		Vector<T> vec;
+		vec.initialize(base);
+		for(size_t e = 0; e < edits / 100; ++e) {
+			Vector<T> rebuilt;
+			rebuilt.initialize(vec.size());
+			for(size_t i = 0; i < vec.size(); ++i)
+				if(i < mid || i >= mid + block)
+					rebuilt.push_back(vec[i]);
+			vec.swap(rebuilt);
+		}
+	}, repeats);
+
+	range = time_ns([&base, mid] {
+		Vector<T> vec;
+		vec.initialize(base);
+		for(size_t e = 0; e < edits / 100; ++e)
+			vec.erase(vec.begin() + mid, vec.begin() + mid + block);
+	}, repeats);
+
+	report(name, "erase", loop, range);
+
+
+	Vector<T> dest;
+	dest.initialize(elements);
+
+	loop = time_ns([&dest, first, last] {
+		dest.clear();
+		for(const T* itr = first; itr != last; ++itr)
+			dest.push_back(*itr);
+	}, repeats);
+
+	range = time_ns([&dest, first, last] {
+		dest.assign(first, last);
+	}, repeats);
+
+	report(name, "assign", loop, range);
+}
+
+
+}
+
+
+
+int main()
+{
+	Vector<int> ints;
+	ints.initialize(elements);
+	for(size_t i = 0; i < elements; ++i)
+		ints.push_back(static_cast<int>(i));
+
+	Vector<std::string> strings;
+	strings.initialize(elements);
+	for(size_t i = 0; i < elements; ++i)
+		strings.push_back(std::string("utix"));
+
+	run("int", ints);
+	run("std::string", strings);
+	return 0;
+}
@@ -0,0 +1,77 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+#include <stdint.h>
+#include <Utix/Algorithm.h>
+#include <Utix/ThreadPool.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+TEST(parallel_transform_reduce)
+{
+	ThreadPool pool;
+	CHECK(pool.Start(4));
+
+	// sizes on both sides of the serial cutoff
+	for(const size_t count : { size_t(100), size_t(200003) })
+	{
+		Vector<uint32_t> src;
+		CHECK(src.initialize(count));
+		for(size_t i = 0; i < count; ++i)
+			src.push_back(static_cast<uint32_t>(i));
+
+		Vector<uint64_t> dst;
+		CHECK(dst.initialize());
+		CHECK(parallel_transform(pool, src, dst, [](const uint32_t value) { return uint64_t(value) * 3; }));
+		CHECK(dst.size() == count && dst[0] == 0 && dst[count - 1] == uint64_t(count - 1) * 3);
+
+		parallel_transform(pool, src, [](const uint32_t value) { return value + 1; });
+		CHECK(src[0] == 1 && src[count - 1] == count);
+
+		const uint64_t sum = parallel_reduce(pool, dst, uint64_t(0), [](const uint64_t acc, const uint64_t value) { return acc + value; });
+		CHECK(sum == uint64_t(count) * (count - 1) / 2 * 3);
+	}
+
+	pool.Stop();
+}
+
+
+TEST(parallel_find)
+{
+	ThreadPool pool;
+	CHECK(pool.Start(4));
+
+	Vector<int> values;
+	CHECK(values.initialize(300000));
+	for(int i = 0; i < 300000; ++i)
+		values.push_back(i % 100000);
+
+	// the first match wins, even when a later chunk finds one first
+	CHECK(parallel_find(pool, values, 99999) == values.begin() + 99999);
+	CHECK(parallel_find_if(pool, values, [](const int value) { return value >= 50000; }) == values.begin() + 50000);
+	CHECK(parallel_find(pool, values, -1) == values.end());
+	CHECK(parallel_find(pool, values.begin(), values.begin(), 0) == values.begin());
+
+	pool.Stop();
+}
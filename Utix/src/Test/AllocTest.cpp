@@ -0,0 +1,127 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <Utix/Alloc.h>
+#include <Utix/AllocStats.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+static bool is_aligned(const void* const block, const size_t alignment)
+{
+	return reinterpret_cast<uintptr_t>(block) % alignment == 0;
+}
+
+
+TEST(alloc_aligned)
+{
+	for(const size_t alignment : { size_t(8), size_t(16), CacheLineSize, size_t(4096) })
+	{
+		float* const block = alloc_arr_aligned<float>(100, alignment);
+		CHECK(block != nullptr && is_aligned(block, alignment));
+		CHECK(arr_size(block) == 100);
+		for(int i = 0; i < 100; ++i)
+			block[i] = static_cast<float>(i);
+
+		// growing keeps the alignment and the contents
+		float* const grown = realloc_arr_aligned<float>(block, 5000, alignment);
+		CHECK(grown != nullptr && is_aligned(grown, alignment));
+		CHECK(arr_size(grown) == 5000);
+		bool same = true;
+		for(int i = 0; i < 100; ++i)
+			same = same && grown[i] == static_cast<float>(i);
+		CHECK(same);
+		free_arr_aligned(grown);
+	}
+
+	AlignedVector<float, 32> vec;
+	CHECK(vec.initialize(3));
+	for(int i = 0; i < 1000; ++i) {
+		CHECK(vec.push_back(static_cast<float>(i)));
+		CHECK(is_aligned(vec.data(), 32));
+	}
+	CHECK(vec.size() == 1000 && vec[999] == 999.0f);
+}
+
+
+TEST(alloc_large)
+{
+	// across the mmap threshold and back, the contents come along
+	constexpr size_t large = UTIX_MMAP_THRESHOLD > 0 ? UTIX_MMAP_THRESHOLD : 32 * 1024 * 1024;
+	uint8_t* block = alloc_arr(1000);
+	CHECK(block != nullptr);
+	for(size_t i = 0; i < 1000; ++i)
+		block[i] = static_cast<uint8_t>(i * 7);
+
+	block = realloc_arr(block, large + 4096);
+	CHECK(block != nullptr && arr_size(block) == large + 4096);
+	block[large + 4095] = 0xcd;
+
+	block = realloc_arr(block, large * 2);
+	CHECK(block != nullptr && arr_size(block) == large * 2);
+	CHECK(block[large + 4095] == 0xcd);
+	block[large * 2 - 1] = 0xef;
+
+	block = realloc_arr(block, 100);
+	CHECK(block != nullptr && arr_size(block) == 100);
+	bool same = true;
+	for(size_t i = 0; i < 100; ++i)
+		same = same && block[i] == static_cast<uint8_t>(i * 7);
+	CHECK(same);
+	free_arr(block);
+
+	uint8_t* const direct = alloc_arr(large);
+	CHECK(direct != nullptr && arr_size(direct) == large);
+	direct[0] = direct[large - 1] = 1;
+	free_arr(direct);
+}
+
+
+TEST(alloc_stats)
+{
+	const AllocStats before = GetAllocStats();
+	void* const a = alloc_arr(100);
+	void* b = alloc_arr(3000);
+	b = realloc_arr(b, 6000);
+	free_arr(a);
+	free_arr(b);
+	const AllocStats after = GetAllocStats();
+
+	// the counters only move when built with UTIX_ALLOC_STATS
+	CHECK(after.enabled == before.enabled);
+	if( after.enabled ) {
+		CHECK(after.allocs - before.allocs == 2);
+		CHECK(after.reallocs - before.reallocs == 1);
+		CHECK(after.frees - before.frees == 2);
+		CHECK(after.histogram[6] > before.histogram[6] && after.histogram[12] > before.histogram[12]);
+	}
+	else {
+		CHECK(after.allocs == 0 && after.frees == 0);
+	}
+
+	const std::string json = AllocStatsToJson(after);
+	CHECK(json.compare(0, 11, "{\"enabled\":") == 0 && json.back() == '}');
+}
@@ -0,0 +1,142 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <cstddef>
+#include <Utix/Arena.h>
+#include <Utix/Alloc.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+static bool is_aligned(const void* const block)
+{
+	return reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t) == 0;
+}
+
+
+TEST(arena_alloc)
+{
+	Arena arena(1024);
+	int* const a = arena.AllocArr<int>(10);
+	double* const b = arena.AllocArr<double>(3);
+	CHECK(a != nullptr && b != nullptr);
+	CHECK(is_aligned(a) && is_aligned(b));
+	CHECK(arr_size(a) == 10 && arr_size(b) == 3);
+
+	// blocks don't overlap
+	for(int i = 0; i < 10; ++i)
+		a[i] = i;
+	b[0] = b[1] = b[2] = -1.0;
+	for(int i = 0; i < 10; ++i)
+		CHECK(a[i] == i);
+
+	// bigger than a chunk gets its own
+	uint8_t* const big = arena.AllocArr(4000);
+	CHECK(big != nullptr && arr_size(big) == 4000);
+	memset(big, 0xab, 4000);
+	CHECK(a[9] == 9 && b[2] == -1.0);
+}
+
+
+TEST(arena_realloc)
+{
+	Arena arena(4096);
+	char* block = arena.AllocArr<char>(16);
+	memcpy(block, "0123456789abcdef", 16);
+
+	// the last block grows in place
+	char* grown = arena.ReallocArr<char>(block, 64);
+	CHECK(grown == block && arr_size(grown) == 64);
+	CHECK(memcmp(grown, "0123456789abcdef", 16) == 0);
+
+	// one that isn't last moves, keeping its contents
+	char* const other = arena.AllocArr<char>(8);
+	CHECK(other != nullptr);
+	char* const moved = arena.ReallocArr<char>(grown, 128);
+	CHECK(moved != grown && arr_size(moved) == 128);
+	CHECK(memcmp(moved, "0123456789abcdef", 16) == 0);
+}
+
+
+TEST(arena_rollback)
+{
+	Arena arena(256);
+	arena.AllocArr<int>(4);
+	const Arena::Mark mark = arena.GetMark();
+	int* const first = arena.AllocArr<int>(4);
+
+	// past the first chunk and back
+	for(int i = 0; i < 20; ++i)
+		CHECK(arena.AllocArr<int>(16) != nullptr);
+
+	arena.Rollback(mark);
+	CHECK(arena.AllocArr<int>(4) == first);
+
+	int* inScope;
+	{
+		ArenaScope scope(arena);
+		inScope = arena.AllocArr<int>(4);
+		for(int i = 0; i < 20; ++i)
+			arena.AllocArr<int>(16);
+	}
+	CHECK(arena.AllocArr<int>(4) == inScope);
+
+	// Reset goes back to the start and reuses the chunks
+	arena.Reset();
+	int* const again = arena.AllocArr<int>(4);
+	arena.Reset();
+	CHECK(arena.AllocArr<int>(4) == again);
+}
+
+
+TEST(arena_buffer)
+{
+	alignas(std::max_align_t) uint8_t buffer[512];
+	Arena arena(buffer, sizeof(buffer), 1024);
+
+	uint8_t* const inside = arena.AllocArr(64);
+	CHECK(inside >= buffer && inside + 64 <= buffer + sizeof(buffer));
+
+	// once the buffer is full it goes to malloc
+	uint8_t* const outside = arena.AllocArr(600);
+	CHECK(outside != nullptr && (outside + 600 <= buffer || outside >= buffer + sizeof(buffer)));
+
+	Arena moved(std::move(arena));
+	moved.Reset();
+	CHECK(moved.AllocArr(64) == inside);
+}
+
+
+TEST(arena_vector)
+{
+	Arena arena(1024);
+	Vector<int, ArenaArrAlloc> vec{ArenaArrAlloc(arena)};
+	CHECK(vec.initialize(4));
+	for(int i = 0; i < 1000; ++i)
+		CHECK(vec.push_back(i));
+
+	CHECK(vec.size() == 1000);
+	for(int i = 0; i < 1000; ++i)
+		CHECK(vec[i] == i);
+}
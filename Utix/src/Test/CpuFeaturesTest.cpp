@@ -0,0 +1,64 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+#include <string.h>
+#include <Utix/CpuFeatures.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+TEST(cpu_features)
+{
+	const CpuFeatures& cpu = get_cpu_features();
+	CHECK(&cpu == &get_cpu_features());
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	// the compiler's own detection agrees
+	CHECK(cpu.Has(CpuFeatures::Sse2) == (__builtin_cpu_supports("sse2") != 0));
+	CHECK(cpu.Has(CpuFeatures::Avx2) == (__builtin_cpu_supports("avx2") != 0));
+	CHECK(cpu.Has(CpuFeatures::Avx512F) == (__builtin_cpu_supports("avx512f") != 0));
+	CHECK(strlen(cpu.vendor) == 12);
+#endif
+
+	CHECK(strcmp(get_cpu_feature_name(CpuFeatures::Avx2), "avx2") == 0);
+	CHECK(strcmp(get_cpu_feature_name(CpuFeatures::Sse41), "sse4.1") == 0);
+	CHECK(strcmp(get_cpu_feature_name(CpuFeatures::Avx | CpuFeatures::Avx2), "unknown") == 0);
+}
+
+
+TEST(cpu_dispatch)
+{
+	// the first variant the cpu runs, and the last one always runs
+	static const int best = 1;
+	static const int fallback = 2;
+	static const CpuVariant<int> missing[] = { 
+		{ CpuFeatures::Neon | CpuFeatures::Sse2, &best }, 
+		{ 0, &fallback } 
+	};
+	CHECK(&cpu_dispatch(missing) == &fallback);
+
+	static const CpuVariant<int> present[] = { 
+		{ get_cpu_features().flags, &best }, 
+		{ 0, &fallback } 
+	};
+	CHECK(&cpu_dispatch(present) == &best);
+}
@@ -0,0 +1,92 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <string>
+#include <type_traits>
+#include <Utix/FlatMap.h>
+#include <Utix/FlatSet.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+TEST(flat_map_sorted)
+{
+	FlatMap<int, std::string> map;
+	const int keys[] = { 5, 1, 9, 3, 7 };
+	for(const int key : keys)
+		CHECK(map.insert(key, std::to_string(key)) != nullptr);
+
+	CHECK(*map.insert(3, "x") == "3");
+	CHECK(*map.insert_or_assign(9, "nine") == "nine");
+	CHECK(map.find_or_insert(4)->empty());
+
+	// iteration is in key order
+	int previous = -1;
+	for(const auto& entry : map) {
+		CHECK(entry.key > previous);
+		previous = entry.key;
+	}
+	CHECK(map.size() == 6);
+
+	CHECK(map.erase(5) && !map.erase(5) && !map.contains(5));
+	CHECK(*map.find(9) == "nine" && map.find(2) == nullptr);
+
+	const FlatMap<int, std::string>& cmap = map;
+	CHECK(*cmap.find(1) == "1");
+	static_assert(std::is_same<decltype(cmap.find(1)), const std::string*>::value, "a const map gives const values");
+}
+
+
+TEST(flat_map_bulk_and_freeze)
+{
+	FlatMap<int, int> map;
+	for(int i = 0; i < 5000; ++i)
+		CHECK(map.push_unsorted((i * 7919) % 5000, i));
+
+	// duplicates keep the first pushed
+	CHECK(map.push_unsorted(0, -1));
+	map.sort();
+	CHECK(map.size() == 5000 && *map.find(0) == 0);
+
+	CHECK(map.freeze() && map.is_frozen());
+	for(int key = 0; key < 5000; ++key) {
+		const int* const value = map.find(key);
+		CHECK(value && (*value * 7919) % 5000 == key);
+	}
+	CHECK(map.find(-3) == nullptr && map.find(5000) == nullptr);
+
+	// any change drops the frozen layout, lookups still work
+	CHECK(map.insert(6000, 1) != nullptr);
+	CHECK(!map.is_frozen() && *map.find(6000) == 1 && map.contains(2500));
+}
+
+
+TEST(flat_set)
+{
+	FlatSet<std::string> set;
+	CHECK(set.insert("pear") && set.insert("apple") && set.insert("fig"));
+	CHECK(*set.insert("fig") == "fig" && set.size() == 3);
+	CHECK(*set.begin() == "apple" && *(set.end() - 1) == "pear");
+	CHECK(set.contains("fig") && !set.contains("kiwi"));
+
+	CHECK(set.freeze() && set.contains("pear") && *set.find("apple") == "apple");
+	CHECK(set.erase("apple") && !set.is_frozen() && set.size() == 2);
+}
@@ -0,0 +1,162 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <Utix/Format.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+using namespace utix::literals;
+
+namespace {
+
+
+bool shortest_is(const double value, const char* expected)
+{
+	char buffer[FloatCharsMax];
+	const size_t len = format_shortest(buffer, value);
+	return len == strlen(expected) && memcmp(buffer, expected, len) == 0;
+}
+
+
+bool shortest_is(const float value, const char* expected)
+{
+	char buffer[FloatCharsMax];
+	const size_t len = format_shortest(buffer, value);
+	return len == strlen(expected) && memcmp(buffer, expected, len) == 0;
+}
+
+
+}
+
+
+
+
+TEST(format_buffers)
+{
+	// snprintf-like: the full length comes back, the text is cut and terminated
+	char small[8];
+	CHECK(FormatTo(small, "{} and {}"_fmt, 12345, "abc") == 13);
+	CHECK(strcmp(small, "12345 a") == 0);
+	CHECK(FormatTo(small, 1, "{}"_fmt, 7) == 1 && small[0] == '\0');
+	CHECK(FormatTo(nullptr, 0, "{}{}"_fmt, 10, 20) == 4);
+
+	char buffer[64];
+	CHECK(FormatTo(buffer, "id {} is {}"_fmt, 3, "ok") == 10);
+	CHECK(strcmp(buffer, "id 3 is ok") == 0);
+
+	// past the stack buffer Format goes to the heap
+	const std::string longText(300, 'x');
+	const std::string formatted = Format("[{}]"_fmt, longText);
+	CHECK(formatted.size() == 302 && formatted == "[" + longText + "]");
+
+	// the Vector overload appends and grows
+	Vector<char> out;
+	CHECK(out.initialize(4));
+	CHECK(FormatTo(out, "{}-"_fmt, 1));
+	CHECK(FormatTo(out, "{}"_fmt, longText));
+	CHECK(out.size() == 302 && memcmp(out.data(), "1-xx", 4) == 0 && out[301] == 'x');
+}
+
+
+TEST(format_specs)
+{
+	CHECK(Format("{{}} {{{}}}"_fmt, 1) == "{} {1}");
+	CHECK(Format("{} {} {}"_fmt, 1) == "1 {} {}");
+	CHECK(Format("{}"_fmt, 1, 2, 3) == "1");
+	CHECK(Format("no args"_fmt) == "no args");
+
+	// integers of every width and sign
+	CHECK(Format("{} {} {}"_fmt, -5, 42u, INT64_MIN) == "-5 42 -9223372036854775808");
+	CHECK(Format("{}"_fmt, UINT64_MAX) == "18446744073709551615");
+	CHECK(Format("{} {}"_fmt, static_cast<signed char>(-3), static_cast<unsigned char>(200)) == "-3 200");
+	CHECK(Format("{:x} {:X} {:o} {:b}"_fmt, 255, 255, 8, 5) == "ff FF 10 101");
+	CHECK(Format("{:#x} {:#o} {:#b}"_fmt, 255, 8, 5) == "0xff 010 0b101");
+	CHECK(Format("{:+} {:+} {:+}"_fmt, 5, -5, 0) == "+5 -5 +0");
+	CHECK(Format("{:c}"_fmt, 65) == "A");
+
+	// width, fill and alignment. numbers go right, the rest left
+	CHECK(Format("[{:5}] [{:5}]"_fmt, 42, "ab") == "[   42] [ab   ]");
+	CHECK(Format("[{:<5}] [{:>5}] [{:^6}]"_fmt, 42, "ab", "ab") == "[42   ] [   ab] [  ab  ]");
+	CHECK(Format("[{:*^7}] [{:->4}]"_fmt, 1, 'c') == "[***1***] [---c]");
+	CHECK(Format("[{:05}] [{:05}] [{:#06x}]"_fmt, 42, -42, 255) == "[00042] [-0042] [0x00ff]");
+	CHECK(Format("[{:2}]"_fmt, 12345) == "[12345]");
+
+	// strings, chars, bools and pointers
+	CHECK(Format("{} {} {}"_fmt, 'z', true, false) == "z true false");
+	CHECK(Format("[{:.2}] [{:5.1}]"_fmt, "abcdef", std::string("xyz")) == "[ab] [x    ]");
+	CHECK(Format("{}"_fmt, static_cast<const char*>(nullptr)) == "(null)");
+
+	int value = 0;
+	char pointer[32];
+	snprintf(pointer, sizeof(pointer), "%p", static_cast<void*>(&value));
+	CHECK(Format("{}"_fmt, &value) == pointer && Format("{:p}"_fmt, &value) == pointer);
+}
+
+
+TEST(format_floats)
+{
+	// without a type or precision: the shortest text that reads back
+	CHECK(Format("{} {} {}"_fmt, 0.1, 1.5, -2.0) == "0.1 1.5 -2");
+	CHECK(Format("{}"_fmt, 0.1f) == "0.1");
+	CHECK(Format("{}"_fmt, 1e23) == "1e+23");
+	CHECK(Format("{}"_fmt, 123456789012.0) == "123456789012");
+
+	// a type or precision goes through printf's rounding
+	CHECK(Format("{:.3f} {:.2e} {:g}"_fmt, 3.14159, 12345.678, 0.0001) == "3.142 1.23e+04 0.0001");
+	CHECK(Format("{:E} {:.0f}"_fmt, 1.5, 2.5) == "1.500000E+00 2");
+	CHECK(Format("[{:8.2f}] [{:<8.2f}] [{:+.1f}]"_fmt, 3.14159, 3.14159, 2.0) == "[    3.14] [3.14    ] [+2.0]");
+
+	CHECK(shortest_is(0.0, "0") && shortest_is(-0.0, "-0"));
+	CHECK(shortest_is(5e-324, "5e-324"));
+	CHECK(shortest_is(1.7976931348623157e308, "1.7976931348623157e+308"));
+	CHECK(shortest_is(1e23, "1e+23"));
+	CHECK(shortest_is(0.3f, "0.3") && shortest_is(16777216.0f, "16777216"));
+
+	// any value reads back as itself, in no more digits than %.17g needs
+	std::mt19937_64 rng(5);
+	bool roundTrip = true;
+	for(int i = 0; i < 20000; ++i)
+	{
+		uint64_t bits = rng();
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		if( value != value || value - value != 0 )
+			continue;
+
+		char buffer[FloatCharsMax + 1];
+		buffer[format_shortest(buffer, value)] = '\0';
+		roundTrip = roundTrip && strtod(buffer, nullptr) == value;
+
+		float single = static_cast<float>(value);
+		if( single - single == 0 ) {
+			buffer[format_shortest(buffer, single)] = '\0';
+			roundTrip = roundTrip && strtof(buffer, nullptr) == single;
+		}
+	}
+	CHECK(roundTrip);
+}
@@ -0,0 +1,165 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <Utix/HashMap.h>
+#include <Utix/HashSet.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+TEST(hash_map_basics)
+{
+	HashMap<std::string, int> map;
+	CHECK(map.empty() && map.find("a") == nullptr);
+
+	CHECK(*map.insert("one", 1) == 1);
+	CHECK(*map.insert("two", 2) == 2);
+
+	// insert keeps, insert_or_assign replaces
+	CHECK(*map.insert("one", 10) == 1);
+	CHECK(*map.insert_or_assign("two", 20) == 20);
+	CHECK(*map.find_or_insert("three") == 0);
+	CHECK(map.size() == 3);
+
+	// lookups by const char* don't build a std::string
+	CHECK(map.contains("one") && !map.contains("four"));
+	CHECK(*map.find(std::string("two")) == 20);
+
+	CHECK(map.erase("one") && !map.erase("one"));
+	CHECK(map.size() == 2 && !map.contains("one"));
+
+	int sum = 0;
+	for(auto& entry : map)
+		sum += entry.value;
+	CHECK(sum == 20);
+
+	const HashMap<std::string, int>& cmap = map;
+	CHECK(*cmap.find("two") == 20);
+	static_assert(std::is_same<decltype(cmap.find("two")), const int*>::value, "a const map gives const values");
+	static_assert(std::is_same<decltype(*map.begin()), const HashMap<std::string, int>::Entry&>::value, 
+	              "iteration can't reach a key");
+	size_t count = 0;
+	for(const auto& entry : cmap)
+		count += entry.key.size();
+	CHECK(count == 8);
+
+	map.clear();
+	CHECK(map.empty() && !map.contains("two"));
+}
+
+
+TEST(hash_map_against_std)
+{
+	// random inserts and erases, checked against std::unordered_map
+	HashMap<uint64_t, uint64_t> map;
+	std::unordered_map<uint64_t, uint64_t> expected;
+	uint64_t state = 0x9E3779B97F4A7C15ull;
+
+	for(int i = 0; i < 200000; ++i)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		const uint64_t key = state % 5000;
+
+		if( state & 0x100 ) {
+			CHECK(map.insert_or_assign(key, i) != nullptr);
+			expected[key] = i;
+		}
+		else {
+			CHECK(map.erase(key) == (expected.erase(key) == 1));
+		}
+	}
+
+	CHECK(map.size() == expected.size());
+	for(const auto& pair : expected) {
+		const uint64_t* const value = map.find(pair.first);
+		CHECK(value && *value == pair.second);
+	}
+
+	size_t visited = 0;
+	for(const auto& entry : map) {
+		CHECK(expected.count(entry.key) == 1);
+		++visited;
+	}
+	CHECK(visited == expected.size());
+}
+
+
+TEST(hash_map_aligned_values)
+{
+	struct alignas(32) Wide
+	{
+		float lanes[8];
+	};
+
+	HashMap<int, Wide> map;
+	for(int i = 0; i < 1000; ++i) {
+		Wide* const value = map.find_or_insert(i);
+		CHECK(value && reinterpret_cast<uintptr_t>(value) % 32 == 0);
+	}
+
+	for(const auto& entry : map)
+		CHECK(reinterpret_cast<uintptr_t>(&entry.value) % 32 == 0);
+}
+
+
+TEST(hash_map_move)
+{
+	HashMap<int, std::string> map;
+	CHECK(map.reserve(100) && map.capacity() >= 100);
+	for(int i = 0; i < 100; ++i)
+		map.insert(i, std::to_string(i));
+
+	HashMap<int, std::string> moved(std::move(map));
+	CHECK(moved.size() == 100 && *moved.find(42) == "42");
+
+	HashMap<int, std::string> other;
+	other.insert(-1, "x");
+	other.swap(moved);
+	CHECK(other.size() == 100 && moved.size() == 1);
+
+	other.free();
+	CHECK(other.empty() && other.insert(5, "5") != nullptr);
+}
+
+
+TEST(hash_set)
+{
+	HashSet<std::string> set;
+	CHECK(set.insert("a") && set.insert("b"));
+	CHECK(*set.insert("a") == "a" && set.size() == 2);
+	CHECK(set.contains("b") && *set.find("b") == "b");
+	CHECK(set.erase("a") && !set.contains("a"));
+
+	for(int i = 0; i < 1000; ++i)
+		set.insert(std::to_string(i));
+	CHECK(set.size() == 1001);
+
+	size_t count = 0;
+	for(const std::string& key : set)
+		count += key == "b" ? 1 : 0;
+	CHECK(count == 1);
+}
@@ -0,0 +1,435 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <Utix/BinaryLog.h>
+#include <Utix/Log.h>
+#include "Test.h"
+
+using namespace utix;
+using namespace utix::literals;
+
+namespace {
+
+
+std::string read_file(FILE* const file)
+{
+	std::string text;
+	char chunk[4096];
+	rewind(file);
+	for(size_t len; (len = fread(chunk, 1, sizeof(chunk), file)) > 0; )
+		text.append(chunk, len);
+	return text;
+}
+
+
+// points fd 1 or 2 at a temporary file until Finish
+class Capture
+{
+public:
+	explicit Capture(const int fd) : _fd(fd) 
+	{
+		fflush(stdout);
+		fflush(stderr);
+		_file = tmpfile();
+		_saved = dup(fd);
+		dup2(fileno(_file), fd);
+	}
+
+	std::string Finish()
+	{
+		fflush(stdout);
+		fflush(stderr);
+		dup2(_saved, _fd);
+		close(_saved);
+		const std::string text = read_file(_file);
+		fclose(_file);
+		return text;
+	}
+
+private:
+	FILE* _file;
+	int _fd;
+	int _saved;
+};
+
+
+std::string run(const std::string& command)
+{
+	std::string text;
+	FILE* const pipe = popen(command.c_str(), "r");
+	if( !pipe )
+		return text;
+
+	char chunk[4096];
+	for(size_t len; (len = fread(chunk, 1, sizeof(chunk), pipe)) > 0; )
+		text.append(chunk, len);
+	pclose(pipe);
+	return text;
+}
+
+
+template<class T>
+bool take(const char*& itr, const char* const end, T* const value)
+{
+	if( static_cast<size_t>(end - itr) < sizeof(T) )
+		return false;
+	memcpy(value, itr, sizeof(T));
+	itr += sizeof(T);
+	return true;
+}
+
+
+}
+
+
+
+
+static LogCategory test_log("test");
+
+
+TEST(log_warning_state)
+{
+	Capture err(2);
+	errno = EINVAL;
+	LogError("first %d", 1);
+	const int errnoAfterError = errno;
+	const std::string lastError = GetLastLogError();
+
+	// a warning is only a line: errno and the last error stay
+	errno = ENOENT;
+	LogWarning("careful %s", "there");
+	LogWarning("typed {}"_fmt, 2);
+	LogWarn("macro %d", 3);
+	const int errnoAfterWarnings = errno;
+	const std::string text = err.Finish();
+
+	CHECK(errnoAfterError == 0);
+	CHECK(lastError.compare(0, 9, "first 1: ") == 0);
+	CHECK(errnoAfterWarnings == ENOENT);
+	CHECK(lastError == GetLastLogError());
+	CHECK(text == lastError + "\ncareful there\ntyped 2\nmacro 3\n");
+	errno = 0;
+}
+
+
+TEST(log_levels)
+{
+	// arguments are only evaluated for the levels that print
+	int evaluated = 0;
+	const auto count = [&evaluated] { return ++evaluated; };
+
+	Capture out(1);
+	test_log.SetLevel(LogLevel::Warn);
+	LogInfoIn(test_log, "hidden %d", count());
+	LogTraceIn(test_log, "hidden %d", count());
+	test_log.SetLevel(LogLevel::Info);
+	LogInfoIn(test_log, "shown %d", count());
+	LogDebugIn(test_log, "hidden %d", count());
+	test_log.SetLevel(LogLevel::Off);
+	LogErrIn(test_log, "hidden %d", count());
+
+	// one call in an expression, like a function
+	const bool logged = (LogInfoIn(test_log, "hidden"), true);
+	const std::string text = out.Finish();
+
+	CHECK(evaluated == 1 && logged);
+	CHECK(text == "shown 1\n");
+	CHECK(test_log.GetLevel() == LogLevel::Off && !test_log.Enabled(LogLevel::Error));
+
+	// the LogError function isn't a level macro, the library still reports with everything off
+	Capture err(2);
+	SetLogLevel(LogLevel::Off);
+	errno = 0;
+	LogError("unfiltered %d", 2);
+	LogErr("hidden %d", count());
+	SetLogLevel(LogLevel::Info);
+	const std::string errText = err.Finish();
+
+	CHECK(errText == "unfiltered 2\n" && evaluated == 1);
+}
+
+
+TEST(log_last_error)
+{
+	Capture err(2);
+
+	// each thread sees its own last error
+	bool own = true;
+	std::thread threads[2];
+	for(int t = 0; t < 2; ++t)
+		threads[t] = std::thread([t, &own] {
+			char expected[32];
+			for(int i = 0; i < 1000; ++i) {
+				errno = 0;
+				LogError("thread %d error %d", t, i);
+				snprintf(expected, sizeof(expected), "thread %d error %d", t, i);
+				if( strcmp(GetLastLogError(), expected) != 0 )
+					own = false;
+			}
+		});
+	for(auto& thread : threads)
+		thread.join();
+
+	errno = ENOENT;
+	LogError("open");
+	const std::string withErrno = GetLastLogError();
+
+	// cut at LogRecordMax, still terminated
+	const std::string longText(LogRecordMax * 2, 'x');
+	errno = 0;
+	LogError("%s", longText.c_str());
+	const size_t longSize = strlen(GetLastLogError());
+	const std::string text = err.Finish();
+
+	CHECK(own);
+	CHECK(withErrno == std::string("open: ") + strerror(ENOENT));
+	CHECK(longSize > 0 && longSize < LogRecordMax);
+	CHECK(std::count(text.begin(), text.end(), '\n') == 2002);
+	CHECK(text.compare(text.size() - longSize - 1, longSize, GetLastLogError()) == 0);
+
+	// the old std::string accessor gives the same text
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+	CHECK(GetLastLogErrorString() == GetLastLogError());
+#pragma GCC diagnostic pop
+}
+
+
+TEST(log_async_round_trip)
+{
+	// small rings and several threads, Block keeps every line
+	constexpr int threads = 3;
+	constexpr int lines = 2000;
+	const uint64_t dropped = GetDroppedLogCount();
+
+	Capture out(1);
+	Capture err(2);
+	const bool started = StartAsyncLog(4096, LogOverflow::Block);
+
+	std::thread workers[threads];
+	for(int t = 0; t < threads; ++t)
+		workers[t] = std::thread([t] {
+			for(int i = 0; i < lines; ++i)
+				Log("thread %d line %d", t, i);
+		});
+	for(auto& worker : workers)
+		worker.join();
+
+	Log("{} typed"_fmt, "last");
+	errno = 0;
+	LogError("async error %d", 4);
+	LogWarning("async warning");
+	FlushLogs();
+	StopAsyncLog();
+	const std::string errText = err.Finish();
+	const std::string outText = out.Finish();
+
+	CHECK(started);
+	CHECK(GetDroppedLogCount() == dropped);
+	CHECK(errText == "async error 4\nasync warning\n");
+
+	// each thread's lines come out whole and in order
+	int next[threads] = { };
+	int typed = 0;
+	bool whole = true;
+	for(size_t pos = 0; pos < outText.size(); )
+	{
+		const size_t newline = outText.find('\n', pos);
+		if( newline == std::string::npos ) {
+			whole = false;
+			break;
+		}
+
+		const std::string line = outText.substr(pos, newline - pos);
+		int t, i;
+		if( line == "last typed" )
+			++typed;
+		else if( sscanf(line.c_str(), "thread %d line %d", &t, &i) == 2 && t >= 0 && t < threads && i == next[t] )
+			++next[t];
+		else
+			whole = false;
+		pos = newline + 1;
+	}
+
+	CHECK(whole && typed == 1);
+	CHECK(next[0] == lines && next[1] == lines && next[2] == lines);
+}
+
+
+TEST(log_async_reused_ring)
+{
+	// a later session with a smaller buffer drains the thread's bigger ring,
+	// lines logged while the writer naps pile up past its staging area
+	constexpr int lines = 300;
+	const std::string pad(1000, '.');
+	bool bigStarted = false;
+	bool smallStarted = false;
+	Capture out(1);
+
+	// a new thread, so its ring comes from the first session here
+	std::thread logger([&] {
+		bigStarted = StartAsyncLog(1024 * 1024, LogOverflow::Block);
+		Log("first");
+		FlushLogs();
+		StopAsyncLog();
+
+		smallStarted = StartAsyncLog(4096, LogOverflow::Block);
+		Log("second");
+		FlushLogs();
+		for(int i = 0; i < lines; ++i)
+			Log("%d %s", i, pad.c_str());
+		FlushLogs();
+		StopAsyncLog();
+	});
+	logger.join();
+	const std::string text = out.Finish();
+
+	CHECK(bigStarted && smallStarted);
+	CHECK(text.compare(0, 13, "first\nsecond\n") == 0);
+
+	int next = 0;
+	for(size_t pos = 13; pos < text.size(); ++next)
+	{
+		const std::string line = std::to_string(next) + ' ' + pad + '\n';
+		if( text.compare(pos, line.size(), line) != 0 )
+			break;
+		pos += line.size();
+	}
+	CHECK(next == lines);
+}
+
+
+TEST(log_binary_round_trip)
+{
+	char path[] = "/tmp/utix_test_log_XXXXXX";
+	const int fd = mkstemp(path);
+	CHECK(fd != -1);
+	close(fd);
+
+	Capture err(2);
+	const bool started = StartBinaryLog(path);
+	Log("plain %d %s %.2f", 7, "abc", 1.5);
+	Log("star [%.*s] [%5s]", 2, "xyz", "a");
+	// the precision bounds a buffer without a terminating zero
+	const char unterminated[3] = { 'a', 'b', 'c' };
+	Log("bound [%.3s] [%.*s]", unterminated, 2, unterminated);
+	Log("{} typed"_fmt, 3);
+	errno = 0;
+	LogError("binary error %u", 5u);
+	LogWarning("binary warning");
+	FlushLogs();
+	StopAsyncLog();
+	err.Finish();
+	CHECK(started);
+
+	FILE* const file = fopen(path, "rb");
+	CHECK(file != nullptr);
+	if( !file )
+		return;
+	const std::string data = read_file(file);
+	fclose(file);
+
+	BinaryLogHeader header;
+	CHECK(data.size() >= sizeof(header));
+	if( data.size() < sizeof(header) )
+		return;
+	memcpy(&header, data.data(), sizeof(header));
+	CHECK(memcmp(header.magic, BinaryLogMagic, sizeof(header.magic)) == 0);
+	CHECK(header.version == BinaryLogVersion && header.longDoubleSize == sizeof(long double));
+
+	// the plain line is a format entry and a record of its raw arguments,
+	// the rest is text formatted at the call
+	uint64_t plainId = 0;
+	uint64_t boundId = 0;
+	int records = 0;
+	int texts = 0;
+	bool plainArgs = false;
+	bool boundArgs = false;
+	bool entries = true;
+	for(const char* itr = data.data() + sizeof(header); itr != data.data() + data.size(); )
+	{
+		uint16_t size;
+		if( data.data() + data.size() - itr < 3 ) {
+			entries = false;
+			break;
+		}
+		const char kind = itr[0];
+		memcpy(&size, itr + 1, sizeof(size));
+		itr += 3;
+		const char* const end = itr + size;
+
+		uint64_t id;
+		uint8_t stream;
+		uint64_t time;
+		if( kind == BinaryLogFormat && take(itr, end, &id) ) {
+			const std::string text(itr, end);
+			if( text == "plain %d %s %.2f" )
+				plainId = id;
+			else if( text == "bound [%.3s] [%.*s]" )
+				boundId = id;
+		}
+		else if( kind == BinaryLogRecord && take(itr, end, &stream) && take(itr, end, &id) && take(itr, end, &time) ) {
+			++records;
+			int64_t number;
+			uint16_t length;
+			double real;
+			if( id == plainId && stream == 1 && take(itr, end, &number) && take(itr, end, &length) && length == 3 
+			    && memcmp(itr, "abc", 3) == 0 && (itr += 3, take(itr, end, &real)) )
+				plainArgs = number == 7 && real == 1.5 && itr == end;
+
+			// a '*' precision goes ahead of its string
+			uint16_t first;
+			int32_t star;
+			uint16_t second;
+			if( id == boundId && take(itr, end, &first) && first == 3 && memcmp(itr, "abc", 3) == 0
+			    && (itr += 3, take(itr, end, &star)) && star == 2 
+			    && take(itr, end, &second) && second == 2 && memcmp(itr, "ab", 2) == 0 )
+				boundArgs = itr + 2 == end;
+		}
+		else if( kind == BinaryLogText ) {
+			++texts;
+		}
+		itr = end;
+	}
+
+	CHECK(entries && plainId != 0 && plainArgs);
+	CHECK(boundId != 0 && boundArgs);
+	CHECK(records == 3 && texts == 3);
+
+	// and LogDecode renders it back, stdout and stderr apart
+	if( test::log_decode_path )
+	{
+		const std::string command = std::string("\"") + test::log_decode_path + "\" " + path;
+		CHECK(run(command + " 2>/dev/null") == "plain 7 abc 1.50\nstar [xy] [    a]\nbound [abc] [ab]\n3 typed\n");
+		CHECK(run(command + " 2>&1 >/dev/null") == "binary error 5\nbinary warning\n");
+	}
+
+	remove(path);
+}
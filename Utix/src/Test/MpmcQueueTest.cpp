@@ -0,0 +1,140 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <Utix/MpmcQueue.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+namespace {
+
+
+// over-aligned, every object made checks where it landed
+struct alignas(128) Wide
+{
+	static bool misplaced;
+	int value;
+
+	Wide(const int v = 0) : value(v) { this->check(); }
+	Wide(const Wide& other) : value(other.value) { this->check(); }
+	Wide& operator=(const Wide& other) { value = other.value; return *this; }
+
+	void check() const
+	{
+		if( reinterpret_cast<uintptr_t>(this) % 128 != 0 )
+			misplaced = true;
+	}
+};
+
+bool Wide::misplaced = false;
+
+
+}
+
+
+TEST(mpmc_queue_single_thread)
+{
+	MpmcQueue<std::string> queue;
+	CHECK(queue.initialize(3) && queue.capacity() == 4);
+
+	CHECK(queue.try_push("a") && queue.try_push(std::string("b")));
+	CHECK(queue.try_emplace(3, 'c') && queue.try_push("d"));
+	CHECK(!queue.try_push("e") && queue.size() == 4);
+
+	std::string out;
+	CHECK(queue.try_pop(out) && out == "a");
+	CHECK(queue.try_pop(out) && out == "b");
+	CHECK(queue.try_pop(out) && out == "ccc");
+	queue.push("f");
+	CHECK(queue.try_pop(out) && out == "d");
+	queue.pop(out);
+	CHECK(out == "f" && queue.empty() && !queue.try_pop(out));
+}
+
+
+TEST(mpmc_queue_aligned_cells)
+{
+	MpmcQueue<Wide> queue;
+	CHECK(queue.initialize(8));
+	Wide::misplaced = false;
+	for(int i = 0; i < 8; ++i)
+		CHECK(queue.try_emplace(i));
+
+	for(int i = 0; i < 8; ++i) {
+		Wide out;
+		CHECK(queue.try_pop(out) && out.value == i);
+	}
+	CHECK(!Wide::misplaced);
+}
+
+
+TEST(mpmc_queue_threads)
+{
+	// every value pushed by every producer is popped exactly once
+	constexpr unsigned producers = 3;
+	constexpr unsigned consumers = 3;
+	constexpr uint32_t perProducer = 30000;
+
+	MpmcQueue<uint32_t> queue;
+	CHECK(queue.initialize(64));
+
+	static std::atomic<uint8_t> seen[producers * perProducer];
+
+	std::atomic<uint32_t> popped{0};
+	Vector<std::thread> threads;
+	threads.initialize(producers + consumers);
+
+	for(unsigned p = 0; p < producers; ++p)
+		threads.emplace_back([&queue, p] {
+			for(uint32_t i = 0; i < perProducer; ++i) 
+			{
+				// blocking and non blocking pushes both get exercised
+				const uint32_t value = p * perProducer + i;
+				if( i & 1 )
+					queue.push(value);
+				else
+					while( !queue.try_push(value) )
+						std::this_thread::yield();
+			}
+		});
+
+	for(unsigned c = 0; c < consumers; ++c)
+		threads.emplace_back([&queue, &popped] {
+			while( popped.fetch_add(1, std::memory_order_relaxed) < producers * perProducer ) 
+			{
+				uint32_t value;
+				queue.pop(value);
+				seen[value].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+	for(auto& thread : threads)
+		thread.join();
+
+	bool once = true;
+	for(const auto& flag : seen)
+		once = once && flag.load(std::memory_order_relaxed) == 1;
+	CHECK(once && queue.empty());
+}
@@ -0,0 +1,96 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <string>
+#include <Utix/SegmentedVector.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+TEST(segmented_vector_stable)
+{
+	SegmentedVector<int, 64> vec;
+	CHECK(vec.empty() && vec.chunk_count() == 0);
+
+	CHECK(vec.push_back(0));
+	const int* const first = &vec[0];
+
+	for(int i = 1; i < 1000; ++i)
+		CHECK(vec.push_back(i));
+
+	// growing never moves elements
+	CHECK(&vec[0] == first);
+	CHECK(vec.size() == 1000 && vec.back() == 999);
+	for(int i = 0; i < 1000; ++i)
+		CHECK(vec[i] == i);
+
+	CHECK(vec.chunk_count() == 16 && vec.chunk_size(15) == 1000 - 15 * 64);
+
+	vec.pop_back();
+	CHECK(vec.size() == 999 && vec.back() == 998);
+}
+
+
+TEST(segmented_vector_chunks)
+{
+	SegmentedVector<float> vec;
+	for(int i = 0; i < 10000; ++i)
+		vec.push_back(static_cast<float>(i));
+
+	// chunks are whole cache lines
+	size_t total = 0;
+	for(size_t chunk = 0; chunk < vec.chunk_count(); ++chunk) {
+		CHECK(reinterpret_cast<uintptr_t>(vec.chunk_data(chunk)) % CacheLineSize == 0);
+		total += vec.chunk_size(chunk);
+	}
+	CHECK(total == vec.size());
+
+	double sum = 0;
+	vec.for_each_chunk([&sum](float* const data, const size_t count) {
+		for(size_t i = 0; i < count; ++i)
+			sum += data[i];
+	});
+	CHECK(sum == 10000.0 * 9999.0 / 2);
+
+	CHECK(vec.reserve(20000) && vec.capacity() >= 20000);
+	vec.clear();
+	CHECK(vec.empty() && vec.capacity() >= 20000);
+}
+
+
+TEST(segmented_vector_objects)
+{
+	SegmentedVector<std::string, 8> vec;
+	for(int i = 0; i < 100; ++i)
+		vec.emplace_back(std::to_string(i));
+
+	SegmentedVector<std::string, 8> moved(std::move(vec));
+	CHECK(vec.empty() && moved.size() == 100 && moved[42] == "42");
+
+	SegmentedVector<std::string, 8> other;
+	other.push_back("x");
+	other.swap(moved);
+	CHECK(other.size() == 100 && moved.size() == 1 && moved[0] == "x");
+
+	other.free();
+	CHECK(other.empty() && other.capacity() == 0);
+}
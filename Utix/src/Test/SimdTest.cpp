@@ -0,0 +1,152 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <random>
+#include <Utix/Simd.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+namespace {
+
+
+struct Data
+{
+	Vector<float> f, g;
+	Vector<int32_t> i;
+	Vector<uint8_t> u;
+};
+
+
+// float sums add in another order per ISA
+bool close(const double a, const double b, const double scale)
+{
+	return fabs(a - b) <= 1e-5 * scale;
+}
+
+
+// every kernel on [offset, offset + count), so heads, tails and unaligned starts are covered
+void compare(const SimdIsa isa, const Data& data, const size_t offset, const size_t count)
+{
+	const float* const f = data.f.data() + offset;
+	const float* const g = data.g.data() + offset;
+	const int32_t* const i = data.i.data() + offset;
+	const uint8_t* const u = data.u.data() + offset;
+	const int32_t needle = i[count / 2];
+	const uint8_t byte = u[count - 1];
+
+	CHECK(set_simd_isa(SimdIsa::Scalar));
+	const float sum = simd_sum(f, count);
+	const int64_t isum = simd_sum(i, count);
+	const uint64_t usum = simd_sum(u, count);
+	const float fmin = simd_min(f, count), fmax = simd_max(f, count);
+	const int32_t imin = simd_min(i, count), imax = simd_max(i, count);
+	const uint8_t umin = simd_min(u, count), umax = simd_max(u, count);
+	const float dot = simd_dot(f, g, count);
+	const size_t icount = simd_count(i, count, needle), ucount = simd_count(u, count, byte);
+	const size_t ifind = simd_find(i, count, needle), ufind = simd_find(u, count, byte);
+
+	Vector<float> axpy, scale;
+	axpy.initialize(g, count);
+	scale.initialize(f, count);
+	simd_axpy(0.75f, f, axpy.data(), count);
+	simd_scale(scale.data(), count, -1.5f);
+
+	CHECK(set_simd_isa(isa));
+	double magnitude = 0;
+	for(size_t n = 0; n < count; ++n)
+		magnitude += fabs(f[n]) * (1 + fabs(g[n]));
+
+	CHECK(close(simd_sum(f, count), sum, magnitude));
+	CHECK(simd_sum(i, count) == isum && simd_sum(u, count) == usum);
+	CHECK(simd_min(f, count) == fmin && simd_max(f, count) == fmax);
+	CHECK(simd_min(i, count) == imin && simd_max(i, count) == imax);
+	CHECK(simd_min(u, count) == umin && simd_max(u, count) == umax);
+	CHECK(close(simd_dot(f, g, count), dot, magnitude));
+	CHECK(simd_count(i, count, needle) == icount && simd_count(u, count, byte) == ucount);
+	CHECK(simd_find(i, count, needle) == ifind && simd_find(u, count, byte) == ufind);
+	CHECK(simd_find(i, count, 1 << 30) == count);
+
+	Vector<float> out;
+	out.initialize(g, count);
+	simd_axpy(0.75f, f, out.data(), count);
+	bool same = true;
+	for(size_t n = 0; n < count; ++n)
+		same = same && close(out[n], axpy[n], 1 + fabs(axpy[n]));
+	CHECK(same);
+
+	out.assign(f, f + count);
+	simd_scale(out.data(), count, -1.5f);
+	CHECK(memcmp(out.data(), scale.data(), count * sizeof(float)) == 0);
+
+	// fills touch exactly their range
+	Vector<int32_t> filled;
+	filled.initialize(count + 2);
+	filled.resize(count + 2, 0);
+	simd_fill(filled.data() + 1, count, int32_t(7));
+	CHECK(filled[0] == 0 && filled[count + 1] == 0 && simd_count(filled.data() + 1, count, 7) == count);
+}
+
+
+}
+
+
+
+
+TEST(simd_against_scalar)
+{
+	const SimdIsa original = get_simd_isa();
+
+	Data data;
+	constexpr size_t size = 10000 + 64;
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+	data.f.initialize(size);
+	data.g.initialize(size);
+	data.i.initialize(size);
+	data.u.initialize(size);
+	for(size_t n = 0; n < size; ++n) {
+		data.f.push_back(dist(rng));
+		data.g.push_back(dist(rng));
+		data.i.push_back(static_cast<int32_t>(rng() % 2001) - 1000);
+		data.u.push_back(static_cast<uint8_t>(rng()));
+	}
+
+	// whatever this cpu can run besides the scalar loops
+	int tested = 0;
+	for(const SimdIsa isa : { SimdIsa::Sse2, SimdIsa::Avx2, SimdIsa::Avx512 })
+	{
+		if( !set_simd_isa(isa) )
+			continue;
+
+		++tested;
+		for(size_t count = 1; count <= 140; ++count)
+			compare(isa, data, count % 17, count);
+		compare(isa, data, 3, 10000);
+		compare(isa, data, 0, 10064);
+	}
+
+	CHECK(set_simd_isa(original) && get_simd_isa() == original);
+	printf("  simd isas checked against scalar: %d\n", tested);
+}
@@ -0,0 +1,149 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <Utix/Slab.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+namespace {
+
+
+void* late_block = nullptr;
+
+// built before the slab cache on its thread, so destroyed after it
+struct LateSlabUser
+{
+	~LateSlabUser()
+	{
+		late_block = slab_alloc(1000);
+		if( late_block )
+			slab_free(late_block, 1000);
+	}
+};
+
+thread_local LateSlabUser late_slab_user;
+
+
+}
+
+
+TEST(slab_sizes)
+{
+	for(size_t bytes = 1; bytes <= SlabMaxBlockSize; ++bytes)
+	{
+		const size_t size = slab_block_size(bytes);
+		CHECK(size >= bytes && size <= SlabMaxBlockSize);
+		CHECK(slab_block_size(size) == size);
+	}
+}
+
+
+TEST(slab_alloc)
+{
+	// blocks of a class are distinct and keep their contents
+	constexpr int count = 5000;
+	static uint8_t* blocks[count];
+	for(int i = 0; i < count; ++i)
+	{
+		const size_t bytes = 1 + (i * 37) % SlabMaxBlockSize;
+		blocks[i] = static_cast<uint8_t*>(slab_alloc(bytes));
+		CHECK(blocks[i] != nullptr);
+		memset(blocks[i], i & 0xff, bytes);
+	}
+
+	for(int i = 0; i < count; ++i)
+	{
+		const size_t bytes = 1 + (i * 37) % SlabMaxBlockSize;
+		CHECK(blocks[i][0] == (i & 0xff) && blocks[i][bytes - 1] == (i & 0xff));
+		slab_free(blocks[i], bytes);
+	}
+
+	// freed blocks are handed out again
+	void* const block = slab_alloc(48);
+	slab_free(block, 48);
+	CHECK(slab_alloc(48) == block);
+	slab_free(block, 48);
+}
+
+
+TEST(slab_threads)
+{
+	// each thread frees what another one allocated
+	constexpr int count = 20000;
+	static void* blocks[count];
+	std::thread producer([] {
+		for(int i = 0; i < count; ++i)
+			blocks[i] = slab_alloc(64);
+	});
+	producer.join();
+
+	bool ok = true;
+	std::thread consumer([&ok] {
+		for(int i = 0; i < count; ++i) {
+			ok = ok && blocks[i] != nullptr;
+			slab_free(blocks[i], 64);
+		}
+	});
+	consumer.join();
+	CHECK(ok);
+}
+
+
+TEST(slab_after_thread_cache)
+{
+	// a block freed after the thread's cache is gone goes back to the central pool,
+	// the next thread to refill that size gets it first
+	std::thread dying([] {
+		static_cast<void>(&late_slab_user);
+		slab_free(slab_alloc(16), 16);
+	});
+	dying.join();
+	CHECK(late_block != nullptr);
+
+	void* reused = nullptr;
+	std::thread next([&reused] {
+		reused = slab_alloc(1000);
+		slab_free(reused, 1000);
+	});
+	next.join();
+	CHECK(reused == late_block);
+}
+
+
+TEST(slab_arr_alloc)
+{
+	Vector<int, SlabArrAlloc> vec;
+	CHECK(vec.initialize(2));
+	// grows through the slab classes into malloc
+	for(int i = 0; i < 4000; ++i)
+		CHECK(vec.push_back(i));
+	CHECK(vec.size() == 4000);
+	for(int i = 0; i < 4000; ++i)
+		CHECK(vec[i] == i);
+
+	vec.clear();
+	CHECK(vec.shrink_to_fit());
+	CHECK(vec.push_back(7) && vec[0] == 7);
+}
@@ -0,0 +1,117 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <Utix/SmallVector.h>
+#include "Test.h"
+
+using namespace utix;
+
+namespace {
+
+
+template<class V, class A, class = void>
+struct can_initialize : std::false_type {};
+
+template<class V, class A>
+struct can_initialize<V, A, decltype(static_cast<void>(std::declval<V&>().initialize(std::declval<A>())))> 
+	: std::true_type {};
+
+
+}
+
+
+TEST(small_vector_inline)
+{
+	SmallVector<int, 8> vec;
+	CHECK(vec.is_inline() && vec.capacity() == 8);
+	const int* const storage = vec.data();
+
+	for(int i = 0; i < 8; ++i)
+		CHECK(vec.push_back(i));
+	CHECK(vec.is_inline() && vec.data() == storage);
+
+	// the 9th element moves it out
+	CHECK(vec.push_back(8));
+	CHECK(!vec.is_inline() && vec.size() == 9);
+	for(int i = 0; i < 9; ++i)
+		CHECK(vec[i] == i);
+
+	// shrinking stays on the heap
+	vec.resize(4);
+	CHECK(vec.shrink_to_fit());
+	CHECK(!vec.is_inline() && vec.capacity() == 4 && vec[3] == 3);
+
+	// the inline block is free again for a fresh start
+	vec.free();
+	CHECK(vec.initialize() && vec.is_inline() && vec.data() == storage);
+}
+
+
+TEST(small_vector_move_swap)
+{
+	SmallVector<std::string, 4> a;
+	SmallVector<std::string, 4> b;
+	a.push_back("one");
+	a.push_back("two");
+	for(int i = 0; i < 10; ++i)
+		b.push_back(std::to_string(i));
+	CHECK(a.is_inline() && !b.is_inline());
+
+	// inline with heap, both ways
+	a.swap(b);
+	CHECK(!a.is_inline() && b.is_inline());
+	CHECK(a.size() == 10 && a[9] == "9" && b.size() == 2 && b[1] == "two");
+
+	SmallVector<std::string, 4> moved(std::move(b));
+	CHECK(moved.is_inline() && moved.size() == 2 && moved[0] == "one");
+	CHECK(b.empty());
+
+	SmallVector<std::string, 4> heap(std::move(a));
+	CHECK(!heap.is_inline() && heap.size() == 10 && heap[0] == "0");
+
+	moved = std::move(heap);
+	CHECK(moved.size() == 10 && moved[5] == "5");
+}
+
+
+TEST(small_vector_initialize)
+{
+	// a Vector rvalue would hand over raw pointers into an inline buffer
+	using Small = SmallVector<std::string, 4>;
+	static_assert(!can_initialize<Small, Vector<std::string, InlineArrAlloc<std::string, 4>>&&>::value,
+	              "Vector's rvalue initialize is not reachable");
+	static_assert(can_initialize<Small, Small&&>::value, "SmallVector's own is");
+
+	Small a;
+	CHECK(a.initialize({ "x", "y" }) && a.is_inline() && a.size() == 2);
+
+	Small b;
+	b.initialize(std::move(a));
+	CHECK(b.is_inline() && b.size() == 2 && b[1] == "y" && b.data() != a.data());
+	CHECK(a.empty());
+
+	const std::string words[] = { "1", "2", "3", "4", "5", "6" };
+	CHECK(a.initialize(words, words + 6) && !a.is_inline() && a[5] == "6");
+	b.initialize(std::move(a));
+	CHECK(!b.is_inline() && b.size() == 6 && b[0] == "1");
+}
@@ -0,0 +1,177 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <Utix/Algorithm.h>
+#include <Utix/RadixSort.h>
+#include <Utix/ThreadPool.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+namespace {
+
+
+struct Pair
+{
+	int32_t key;
+	uint32_t order;
+};
+
+
+template<class T, class Gen>
+Vector<T> make(const size_t count, Gen gen)
+{
+	Vector<T> vec;
+	vec.initialize(count);
+	for(size_t i = 0; i < count; ++i)
+		vec.push_back(gen(i));
+	return vec;
+}
+
+
+template<class T>
+bool same(const Vector<T>& a, const Vector<T>& b)
+{
+	return a.size() == b.size() && memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0;
+}
+
+
+}
+
+
+
+
+TEST(radix_sort_keys)
+{
+	std::mt19937_64 rng(1);
+
+	// sizes on both sides of the std::stable_sort cutoff
+	for(const size_t count : { size_t(10), size_t(100000) })
+	{
+		Vector<uint64_t> u = make<uint64_t>(count, [&rng](size_t) { return rng(); });
+		Vector<uint64_t> uExpected = make<uint64_t>(count, [&u](size_t i) { return u[i]; });
+		radix_sort(u);
+		std::sort(uExpected.begin(), uExpected.end());
+		CHECK(same(u, uExpected));
+
+		Vector<int32_t> s = make<int32_t>(count, [&rng](size_t) { return static_cast<int32_t>(rng()); });
+		Vector<int32_t> sExpected = make<int32_t>(count, [&s](size_t i) { return s[i]; });
+		radix_sort(s.begin(), s.end());
+		std::sort(sExpected.begin(), sExpected.end());
+		CHECK(same(s, sExpected));
+
+		// only the low byte varies: the other passes are skipped
+		Vector<uint32_t> narrow = make<uint32_t>(count, [&rng](size_t) { return 0x1234500u | (rng() & 0xff); });
+		radix_sort(narrow.begin(), narrow.end());
+		CHECK(std::is_sorted(narrow.begin(), narrow.end()));
+	}
+}
+
+
+TEST(radix_sort_floats)
+{
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<double> dist(-1e6, 1e6);
+	Vector<double> values = make<double>(50000, [&](size_t i) { 
+		return i % 1000 == 0 ? -0.0 : i % 1000 == 1 ? 0.0 : dist(rng); 
+	});
+	values.push_back(std::numeric_limits<double>::infinity());
+	values.push_back(-std::numeric_limits<double>::infinity());
+	values.push_back(std::numeric_limits<double>::denorm_min());
+
+	radix_sort(values.begin(), values.end());
+	CHECK(std::is_sorted(values.begin(), values.end()));
+	CHECK(values[0] == -std::numeric_limits<double>::infinity());
+
+	// -0.0 comes before 0.0
+	const double* const zero = std::lower_bound(values.begin(), values.end(), 0.0);
+	CHECK(std::signbit(zero[0]) && !std::signbit(zero[99]) && zero[100] > 0);
+
+	Vector<float> floats = make<float>(50000, [&](size_t) { return static_cast<float>(dist(rng)); });
+	radix_sort(floats.begin(), floats.end());
+	CHECK(std::is_sorted(floats.begin(), floats.end()));
+}
+
+
+TEST(radix_sort_stable)
+{
+	// a key/value sort keeps equal keys in their first order, serial and on the pool
+	std::mt19937 rng(3);
+	ThreadPool pool;
+	CHECK(pool.Start(4));
+
+	for(const bool parallel : { false, true })
+	{
+		Vector<Pair> pairs = make<Pair>(200000, [&rng](size_t i) { 
+			return Pair { static_cast<int32_t>(rng() % 1000) - 500, static_cast<uint32_t>(i) }; 
+		});
+
+		const auto key = [](const Pair& p) { return p.key; };
+		if( parallel )
+			radix_sort(pool, pairs.begin(), pairs.end(), key);
+		else
+			radix_sort(pairs.begin(), pairs.end(), key);
+
+		bool stable = true;
+		for(size_t i = 1; i < pairs.size(); ++i)
+			stable = stable && (pairs[i - 1].key < pairs[i].key 
+			                    || (pairs[i - 1].key == pairs[i].key && pairs[i - 1].order < pairs[i].order));
+		CHECK(stable);
+	}
+
+	pool.Stop();
+}
+
+
+TEST(parallel_sort)
+{
+	ThreadPool pool;
+	CHECK(pool.Start(4));
+	std::mt19937_64 rng(4);
+
+	// odd sizes so the last run and merge are partial
+	Vector<uint64_t> values = make<uint64_t>(300001, [&rng](size_t) { return rng() % 100000; });
+	Vector<uint64_t> expected = make<uint64_t>(values.size(), [&values](size_t i) { return values[i]; });
+	parallel_sort(pool, values);
+	std::sort(expected.begin(), expected.end());
+	CHECK(same(values, expected));
+
+	parallel_sort(pool, values.begin(), values.end(), [](uint64_t a, uint64_t b) { return a > b; });
+	CHECK(std::is_sorted(values.begin(), values.end(), [](uint64_t a, uint64_t b) { return a > b; }));
+
+	// elements that aren't trivially copyable go through live objects
+	Vector<std::string> strings = make<std::string>(70001, [&rng](size_t) { return std::to_string(rng() % 1000000); });
+	parallel_sort(pool, strings);
+	CHECK(std::is_sorted(strings.begin(), strings.end()));
+
+	// and a stopped pool sorts serially
+	pool.Stop();
+	Vector<uint64_t> serial = make<uint64_t>(50000, [&rng](size_t) { return rng(); });
+	parallel_sort(pool, serial);
+	CHECK(std::is_sorted(serial.begin(), serial.end()));
+}
@@ -0,0 +1,145 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <memory>
+#include <thread>
+#include <Utix/SpscRing.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+TEST(spsc_ring_single_thread)
+{
+	SpscRing<int> ring;
+	CHECK(ring.initialize(5) && ring.capacity() == 8);
+	CHECK(ring.empty());
+
+	for(int i = 0; i < 8; ++i)
+		CHECK(ring.push(i));
+	CHECK(!ring.push(8) && ring.size() == 8);
+
+	int value = -1;
+	CHECK(ring.pop(value) && value == 0);
+
+	// wraps around the end of the storage
+	const int more[] = { 8, 9, 10 };
+	CHECK(!ring.push_all(more, 3));
+	CHECK(ring.push_n(more, 3) == 1);
+
+	int out[16];
+	CHECK(ring.pop_n(out, 16) == 8);
+	for(int i = 0; i < 8; ++i)
+		CHECK(out[i] == i + 1);
+	CHECK(ring.empty() && !ring.pop(value));
+
+	// spans stop at the end of the storage: slots 1 to 3 hold 8, 9, 10
+	CHECK(ring.push_all(more, 3));
+	SpscRing<int>::Span span = ring.read_peek(8);
+	CHECK(span.size == 3 && span.data[0] == 8 && span.data[2] == 10);
+	ring.read_release(1);
+
+	span = ring.write_reserve(8);
+	CHECK(span.size == 4);
+	span.data[0] = 42;
+	ring.write_commit(1);
+
+	CHECK(ring.pop_n(out, 16) == 3);
+	CHECK(out[0] == 9 && out[1] == 10 && out[2] == 42);
+}
+
+
+TEST(spsc_ring_objects)
+{
+	SpscRing<std::unique_ptr<int>> ring;
+	CHECK(ring.initialize(4));
+	CHECK(ring.push(std::unique_ptr<int>(new int(1))));
+	CHECK(ring.emplace(new int(2)));
+
+	std::unique_ptr<int> out;
+	CHECK(ring.pop(out) && *out == 1);
+
+	// what's left is destroyed with the ring
+	ring.free();
+	CHECK(ring.capacity() == 0);
+}
+
+
+TEST(spsc_ring_aligned_slots)
+{
+	// slots start on a cache line, and keep a bigger alignment of T
+	SpscRing<int> ring;
+	CHECK(ring.initialize(16));
+	CHECK(reinterpret_cast<uintptr_t>(ring.write_reserve(1).data) % CacheLineSize == 0);
+
+	struct alignas(128) Wide
+	{
+		uint64_t value;
+	};
+
+	SpscRing<Wide> wide;
+	CHECK(wide.initialize(4));
+	for(uint64_t i = 0; i < 3; ++i)
+		CHECK(wide.push(Wide { i }));
+
+	const SpscRing<Wide>::Span span = wide.read_peek(4);
+	CHECK(span.size == 3 && reinterpret_cast<uintptr_t>(span.data) % 128 == 0 && span.data[2].value == 2);
+}
+
+
+TEST(spsc_ring_threads)
+{
+	constexpr uint64_t count = 200000;
+	SpscRing<uint64_t> ring;
+	CHECK(ring.initialize(256));
+
+	std::thread producer([&ring] {
+		uint64_t batch[16];
+		for(uint64_t next = 0; next < count; ) 
+		{
+			size_t n = 0;
+			while( n < 16 && next + n < count ) {
+				batch[n] = next + n;
+				++n;
+			}
+			const size_t pushed = ring.push_n(batch, n);
+			next += pushed;
+			if( pushed == 0 )
+				std::this_thread::yield();
+		}
+	});
+
+	// everything arrives once and in order
+	bool inOrder = true;
+	uint64_t expected = 0;
+	uint64_t batch[32];
+	while( expected < count ) 
+	{
+		const size_t n = ring.pop_n(batch, 32);
+		for(size_t i = 0; i < n; ++i)
+			inOrder = inOrder && batch[i] == expected++;
+		if( n == 0 )
+			std::this_thread::yield();
+	}
+
+	producer.join();
+	CHECK(inOrder && ring.empty());
+}
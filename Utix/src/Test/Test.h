@@ -0,0 +1,68 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#ifndef UTIX_TEST_H_
+#define UTIX_TEST_H_
+#include <stdio.h>
+
+
+// the UTIX_TEST runner: every *Test.cpp registers its cases with TEST, 
+// test.cpp runs them all. CHECK reports a failed condition and the case goes on
+
+namespace utix {
+namespace test {
+
+
+struct TestCase
+{
+	const char* name;
+	void (*func)();
+	TestCase* next;
+};
+
+
+// cases run in registration order, file by file
+struct Register
+{
+	explicit Register(TestCase& testCase) noexcept;
+};
+
+
+extern void check_failed(const char* file, const int line, const char* condition) noexcept;
+
+// LogDecode's path, when the tools are built ctest passes it to UTIX_TEST
+extern const char* log_decode_path;
+
+
+}
+}
+
+
+#define TEST(name)                                                                       \
+	static void name();                                                                  \
+	static ::utix::test::TestCase name##_case_ { #name, name, nullptr };                 \
+	static const ::utix::test::Register name##_register_(name##_case_);                  \
+	static void name()
+
+#define CHECK(...) \
+	((__VA_ARGS__) ? (void)0 : ::utix::test::check_failed(__FILE__, __LINE__, #__VA_ARGS__))
+
+
+#endif // UTIX_TEST_H_
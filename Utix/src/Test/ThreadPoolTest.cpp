@@ -0,0 +1,126 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdint.h>
+#include <atomic>
+#include <Utix/ThreadPool.h>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+
+TEST(thread_pool_tasks)
+{
+	ThreadPool pool;
+	CHECK(pool.Start(3) && pool.IsRunning() && pool.GetWorkerCount() == 3);
+
+	// tasks live on the waiter's stack
+	std::atomic<int> sum{0};
+	struct Item { std::atomic<int>* sum; int value; };
+	Item items[500];
+	Task tasks[500];
+	TaskGroup group;
+	for(int i = 0; i < 500; ++i) {
+		items[i] = Item { &sum, i };
+		tasks[i] = Task { [](void* data) {
+			Item* const item = static_cast<Item*>(data);
+			item->sum->fetch_add(item->value, std::memory_order_relaxed);
+		}, &items[i], &group };
+		pool.Submit(tasks[i]);
+	}
+
+	pool.Wait(group);
+	CHECK(group.IsDone() && sum.load() == 500 * 499 / 2);
+
+	uint64_t ran = 0;
+	for(unsigned i = 0; i < pool.GetWorkerCount(); ++i)
+		ran += pool.GetWorkerStats(i).tasks;
+	CHECK(ran <= 500);
+
+	pool.Stop();
+	CHECK(!pool.IsRunning());
+
+	// a stopped pool runs tasks inline
+	TaskGroup inlineGroup;
+	Task task { [](void* data) { ++*static_cast<int*>(data); }, nullptr, &inlineGroup };
+	int counter = 0;
+	task.data = &counter;
+	pool.Submit(task);
+	CHECK(counter == 1 && inlineGroup.IsDone());
+}
+
+
+TEST(thread_pool_parallel)
+{
+	ThreadPool pool;
+	CHECK(pool.Start(4));
+
+	Vector<uint32_t> data;
+	CHECK(data.initialize(100000) && data.assign(100000, 0u));
+
+	// every index is visited once
+	parallel_for(pool, 0, data.size(), [&data](const size_t first, const size_t last) {
+		for(size_t i = first; i < last; ++i)
+			data[i] += static_cast<uint32_t>(i);
+	}, 1000);
+
+	bool visited = true;
+	for(size_t i = 0; i < data.size(); ++i)
+		visited = visited && data[i] == i;
+	CHECK(visited);
+
+	// join keeps the left to right order
+	const uint64_t sum = parallel_reduce(pool, size_t(0), data.size(), uint64_t(0), 
+		[&data](const size_t first, const size_t last, uint64_t acc) {
+			for(size_t i = first; i < last; ++i)
+				acc += data[i];
+			return acc;
+		},
+		[](const uint64_t left, const uint64_t right) { return left + right; });
+	CHECK(sum == uint64_t(99999) * 100000 / 2);
+
+	// chunks cover the range once, and join gets them left to right
+	struct Span { size_t first, last; bool ok; };
+	const Span span = parallel_reduce(pool, size_t(0), size_t(5000), Span { 0, 0, false },
+		[](const size_t first, const size_t last, Span acc) {
+			return acc.ok ? Span { acc.first, last, acc.last == first } : Span { first, last, true };
+		},
+		[](const Span& left, const Span& right) { 
+			return Span { left.first, right.last, left.ok && right.ok && left.last == right.first }; 
+		}, 7);
+	CHECK(span.ok && span.first == 0 && span.last == 5000);
+
+	// nested waits don't deadlock
+	std::atomic<int> leaves{0};
+	parallel_for(pool, 0, 4, [&pool, &leaves](const size_t first, const size_t last) {
+		for(size_t i = first; i < last; ++i)
+			parallel_for(pool, 0, 64, [&leaves](size_t from, size_t to) { leaves += int(to - from); }, 1);
+	}, 1);
+	CHECK(leaves.load() == 256);
+
+	leaves = 0;
+	parallel_invoke(pool, 
+		[&pool, &leaves] { parallel_for(pool, 0, 64, [&leaves](size_t first, size_t last) { leaves += int(last - first); }, 1); },
+		[&pool, &leaves] { parallel_for(pool, 0, 64, [&leaves](size_t first, size_t last) { leaves += int(last - first); }, 1); });
+	CHECK(leaves.load() == 128);
+
+	pool.Stop();
+}
@@ -0,0 +1,290 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <memory>
+#include <string>
+#include <Utix/Vector.h>
+#include "Test.h"
+
+using namespace utix;
+
+namespace {
+
+
+// counts live objects, to catch missed or doubled constructors and destructors
+struct Counted
+{
+	static int live;
+	int value;
+
+	Counted(const int v = 0) : value(v) { ++live; }
+	Counted(const Counted& other) : value(other.value) { ++live; }
+	Counted(Counted&& other) : value(other.value) { other.value = -1; ++live; }
+	Counted& operator=(const Counted& other) { value = other.value; return *this; }
+	Counted& operator=(Counted&& other) { value = other.value; other.value = -1; return *this; }
+	~Counted() { --live; }
+};
+
+int Counted::live = 0;
+
+
+template<class V>
+bool equals(const V& vec, std::initializer_list<int> expected)
+{
+	if( vec.size() != expected.size() )
+		return false;
+
+	size_t i = 0;
+	for(const int value : expected)
+		if( vec[i++] != value )
+			return false;
+	return true;
+}
+
+
+template<class V>
+bool equals_counted(const V& vec, std::initializer_list<int> expected)
+{
+	if( vec.size() != expected.size() )
+		return false;
+
+	size_t i = 0;
+	for(const int value : expected)
+		if( vec[i++].value != value )
+			return false;
+	return true;
+}
+
+
+// the distinct capacities push_back goes through
+template<class GROWTH, class T = int>
+Vector<size_t> capacities(const size_t pushes)
+{
+	Vector<size_t> caps;
+	caps.initialize();
+	Vector<T, DefaultArrAlloc, GROWTH> vec;
+	vec.initialize();
+	for(size_t i = 0; i < pushes; ++i) {
+		vec.push_back(T());
+		if( caps.empty() || caps[caps.size() - 1] != vec.capacity() )
+			caps.push_back(vec.capacity());
+	}
+	return caps;
+}
+
+
+}
+
+
+
+
+TEST(vector_basics)
+{
+	Vector<int> vec;
+	CHECK(vec.initialize({ 1, 2, 3 }));
+	CHECK(equals(vec, { 1, 2, 3 }));
+	CHECK(vec.push_back(4) && vec.emplace_back(5));
+	CHECK(equals(vec, { 1, 2, 3, 4, 5 }));
+
+	CHECK(vec.resize(7) && vec.size() == 7);
+	vec[5] = vec[6] = 0;
+	CHECK(equals(vec, { 1, 2, 3, 4, 5, 0, 0 }));
+	CHECK(vec.resize(2));
+	CHECK(equals(vec, { 1, 2 }));
+
+	// growing a trivial vector doesn't write the new elements, zeroing is asked for
+	CHECK(vec.resize(4));
+	CHECK(equals(vec, { 1, 2, 3, 4 }));
+	CHECK(vec.resize(2) && vec.resize(5, 0));
+	CHECK(equals(vec, { 1, 2, 0, 0, 0 }));
+	CHECK(vec.resize(2, 9));
+	CHECK(equals(vec, { 1, 2 }));
+
+	Vector<int> other;
+	CHECK(other.initialize(vec));
+	CHECK(equals(other, { 1, 2 }));
+	other[0] = 9;
+	CHECK(vec[0] == 1);
+
+	Vector<int> moved(std::move(other));
+	CHECK(equals(moved, { 9, 2 }) && other.empty());
+
+	moved.swap(vec);
+	CHECK(equals(moved, { 1, 2 }) && equals(vec, { 9, 2 }));
+
+	vec.clear();
+	CHECK(vec.empty() && vec.capacity() > 0);
+	vec.free();
+	CHECK(vec.capacity() == 0 && vec.data() == nullptr);
+}
+
+
+TEST(vector_range_ops)
+{
+	Vector<int> vec;
+	vec.initialize();
+	const int values[] = { 1, 2, 3, 4, 5, 6 };
+
+	CHECK(vec.append(values, values + 3));
+	CHECK(equals(vec, { 1, 2, 3 }));
+
+	// appending part of itself, across a reallocation
+	vec.shrink_to_fit();
+	CHECK(vec.append(vec.begin(), vec.end()));
+	CHECK(equals(vec, { 1, 2, 3, 1, 2, 3 }));
+
+	CHECK(vec.insert(vec.begin() + 1, values + 3, values + 6));
+	CHECK(equals(vec, { 1, 4, 5, 6, 2, 3, 1, 2, 3 }));
+
+	CHECK(vec.insert(vec.end(), 2, 7));
+	CHECK(vec.insert(vec.begin(), 8));
+	CHECK(equals(vec, { 8, 1, 4, 5, 6, 2, 3, 1, 2, 3, 7, 7 }));
+
+	int* const next = vec.erase(vec.begin() + 2, vec.begin() + 5);
+	CHECK(next == vec.begin() + 2 && *next == 2);
+	CHECK(equals(vec, { 8, 1, 2, 3, 1, 2, 3, 7, 7 }));
+	CHECK(*vec.erase(vec.begin()) == 1);
+	CHECK(vec.erase(vec.end() - 1) == vec.end());
+	CHECK(equals(vec, { 1, 2, 3, 1, 2, 3, 7 }));
+
+	CHECK(vec.assign(values + 4, values + 6));
+	CHECK(equals(vec, { 5, 6 }));
+	CHECK(vec.assign(3, 9));
+	CHECK(equals(vec, { 9, 9, 9 }));
+	CHECK(vec.assign({ 4, 3 }));
+	CHECK(equals(vec, { 4, 3 }));
+}
+
+
+TEST(vector_range_one_allocation)
+{
+	Vector<int> src;
+	src.initialize();
+	for(int i = 0; i < 10000; ++i)
+		src.push_back(i);
+
+	Vector<int> vec;
+	vec.initialize();
+	vec.push_back(-1);
+	const size_t before = vec.capacity();
+	CHECK(vec.append(src.begin(), src.end()));
+	CHECK(vec.capacity() >= 10001 && vec.capacity() != before);
+
+	// enough room already: no new block at all
+	CHECK(vec.reserve(30000));
+	const int* const data = vec.data();
+	CHECK(vec.insert(vec.begin() + 1, src.begin(), src.end()));
+	CHECK(vec.data() == data && vec.size() == 20001);
+	CHECK(vec[0] == -1 && vec[1] == 0 && vec[10000] == 9999 && vec[10001] == 0 && vec[20000] == 9999);
+}
+
+
+TEST(vector_objects)
+{
+	Counted::live = 0;
+	{
+		Vector<Counted> vec;
+		vec.initialize();
+		for(int i = 0; i < 100; ++i)
+			vec.emplace_back(i);
+		CHECK(Counted::live == 100);
+
+		const Counted extra[] = { 100, 101, 102 };
+		CHECK(vec.insert(vec.begin() + 50, extra, extra + 3));
+		CHECK(vec.size() == 103 && vec[50].value == 100 && vec[53].value == 50);
+		CHECK(Counted::live == 106);
+
+		vec.erase(vec.begin(), vec.begin() + 50);
+		CHECK(Counted::live == 56 && vec[0].value == 100);
+
+		CHECK(vec.insert(vec.begin(), 2, Counted(7)));
+		CHECK(vec.resize(10));
+		CHECK(equals_counted(vec, { 7, 7, 100, 101, 102, 50, 51, 52, 53, 54 }));
+		CHECK(Counted::live == 13);
+
+		CHECK(vec.assign(4, Counted(1)));
+		CHECK(Counted::live == 7);
+
+		CHECK(vec.resize(6, Counted(3)));
+		CHECK(equals_counted(vec, { 1, 1, 1, 1, 3, 3 }) && Counted::live == 9);
+	}
+	CHECK(Counted::live == 0);
+
+	Vector<std::string> strings;
+	strings.initialize();
+	for(int i = 0; i < 50; ++i)
+		strings.push_back(std::string(40, static_cast<char>('a' + i % 26)));
+	strings.erase(strings.begin() + 10, strings.begin() + 40);
+	CHECK(strings.size() == 20 && strings[10] == std::string(40, 'a' + 40 % 26));
+}
+
+
+TEST(vector_relocatable)
+{
+	// unique_ptr grows by reallocate, the pointers come along.
+	// the trait comes with Vector.h, every translation unit sees the same one
+	static_assert(is_trivially_relocatable<std::unique_ptr<int>>::value, "unique_ptr relocates without Memory.h");
+	Vector<std::unique_ptr<int>> owners;
+	owners.initialize(1);
+	for(int i = 0; i < 1000; ++i)
+		CHECK(owners.push_back(std::unique_ptr<int>(new int(i))));
+
+	bool same = true;
+	for(int i = 0; i < 1000; ++i)
+		same = same && *owners[i] == i;
+	CHECK(same);
+
+	Vector<std::unique_ptr<int>> moved(std::move(owners));
+	CHECK(moved.size() == 1000 && *moved[999] == 999 && owners.empty());
+}
+
+
+TEST(vector_growth)
+{
+	// GrowDouble doubles
+	const Vector<size_t> doubling = capacities<GrowDouble>(1000);
+	for(size_t i = 1; i < doubling.size(); ++i)
+		CHECK(doubling[i] == doubling[i - 1] * 2);
+
+	// GrowHalf takes 1.5x steps
+	const Vector<size_t> half = capacities<GrowHalf>(1000);
+	for(size_t i = 1; i < half.size(); ++i)
+		CHECK(half[i] == half[i - 1] + half[i - 1] / 2);
+
+	// GrowStep adds the step
+	const Vector<size_t> step = capacities<GrowStep<16>>(100);
+	CHECK(step[0] == 16);
+	for(size_t i = 1; i < step.size(); ++i)
+		CHECK(step[i] == step[i - 1] + 16);
+
+	// GrowPage fills whole pages, header included
+	const Vector<size_t> page = capacities<GrowPage, uint64_t>(5000);
+	for(size_t i = 0; i < page.size(); ++i) {
+		const size_t bytes = page[i] * sizeof(uint64_t) + sizeof(size_t);
+		CHECK(bytes % GrowPage::PageSize == 0);
+	}
+
+	// reserve and shrink_to_fit
+	Vector<int> vec;
+	vec.initialize();
+	CHECK(vec.reserve(100) && vec.capacity() >= 100);
+	vec.push_back(1);
+	CHECK(vec.shrink_to_fit() && vec.capacity() == 1 && vec[0] == 1);
+}
@@ -1,10 +1,89 @@
-#include <cstdio>
-#include <iostream>
-#include <memory>
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdio.h>
+#include <type_traits>
 #include <Utix/BaseTraits.h>
+#include "Test.h"
+
+namespace utix {
+namespace test {
+
+
+static TestCase* first_case = nullptr;
+static TestCase** last_case = &first_case;
+static int case_failures = 0;
+const char* log_decode_path = nullptr;
+
+
+Register::Register(TestCase& testCase) noexcept
+{
+	*last_case = &testCase;
+	last_case = &testCase.next;
+}
+
+
+void check_failed(const char* const file, const int line, const char* const condition) noexcept
+{
+	fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, condition);
+	++case_failures;
+}
 
-int main()
+
+}
+}
+
+
+
+
+using namespace utix;
+
+
+TEST(base_traits)
 {
-	utix::remove_pointer_t<int* const volatile restrict> x = 0;
-	std::cout << utix::is_pointer<decltype(x)>::value << '\n';	
+	// the pointer's own cv qualifiers go too. (restrict isn't a C++ keyword)
+	CHECK(std::is_same<remove_pointer_t<int* const volatile>, int>::value);
+	CHECK(std::is_same<remove_pointer_t<const int*>, const int>::value);
+	CHECK(is_pointer<int* const>::value);
+	CHECK(!is_pointer<int>::value);
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+	if( argc > 1 )
+		test::log_decode_path = argv[1];
+
+	int failed = 0;
+	int count = 0;
+	for(test::TestCase* itr = test::first_case; itr; itr = itr->next, ++count)
+	{
+		test::case_failures = 0;
+		itr->func();
+		printf("%s %s\n", test::case_failures ? "[FAIL]" : "[ OK ]", itr->name);
+		fflush(stdout);
+		failed += test::case_failures ? 1 : 0;
+	}
+
+	printf("%d of %d test cases passed\n", count - failed, count);
+	return failed ? 1 : 0;
 }
@@ -0,0 +1,278 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+// renders a binary log (see StartBinaryLog) back to text.
+//   LogDecode [-t] <binary log>
+// records logged to stdout go to stdout, LogError lines to stderr.
+// -t prefixes every line with the seconds since the log started
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <Utix/BinaryLog.h>
+#include <Utix/HashMap.h>
+#include <Utix/Log.h>
+#include <Utix/Vector.h>
+
+using namespace utix;
+
+namespace {
+
+constexpr size_t entry_header = 3;
+constexpr size_t spec_max = 64;
+
+
+template<class T>
+bool take(const char*& itr, const char* const end, T* const value)
+{
+	if( static_cast<size_t>(end - itr) < sizeof(T) )
+		return false;
+	memcpy(value, itr, sizeof(T));
+	itr += sizeof(T);
+	return true;
+}
+
+
+template<class T>
+void print_arg(FILE* const out, const char* const spec, const int32_t* const stars, const int starCount, const T value)
+{
+	switch( starCount ) {
+	case 0: fprintf(out, spec, value); break;
+	case 1: fprintf(out, spec, stars[0], value); break;
+	default: fprintf(out, spec, stars[0], stars[1], value); break;
+	}
+}
+
+
+// prints fmtString with the arguments of one record, false if they don't match it
+bool render(FILE* const out, const char* const fmtString, const char* args, const char* const end)
+{
+	const char* text = fmtString;
+	for(const char* itr = strchr(text, '%'); itr; itr = strchr(text, '%'))
+	{
+		fwrite(text, 1, static_cast<size_t>(itr - text), out);
+
+		const LogSpec logSpec = parse_log_spec(itr);
+		text = itr + logSpec.size;
+
+		if( logSpec.arg == LogArg::None ) {
+			fputc('%', out);
+			continue;
+		}
+
+		if( logSpec.arg == LogArg::Unsupported || logSpec.size >= spec_max )
+			return false;
+
+		char spec[spec_max];
+		memcpy(spec, itr, logSpec.size);
+		spec[logSpec.size] = '\0';
+
+		int32_t stars[2];
+		for(int i = 0; i < logSpec.stars; ++i)
+			if( !take(args, end, &stars[i]) )
+				return false;
+
+		switch( logSpec.arg )
+		{
+		case LogArg::Int: {
+			int64_t value;
+			if( !take(args, end, &value) )
+				return false;
+			switch( logSpec.length ) {
+			case LogLength::Long: print_arg(out, spec, stars, logSpec.stars, static_cast<long>(value)); break;
+			case LogLength::LongLong: print_arg(out, spec, stars, logSpec.stars, static_cast<long long>(value)); break;
+			case LogLength::IntMax: print_arg(out, spec, stars, logSpec.stars, static_cast<intmax_t>(value)); break;
+			case LogLength::Size:
+			case LogLength::PtrDiff: print_arg(out, spec, stars, logSpec.stars, static_cast<ptrdiff_t>(value)); break;
+			default: print_arg(out, spec, stars, logSpec.stars, static_cast<int>(value)); break;
+			}
+			break;
+		}
+		case LogArg::Unsigned: {
+			uint64_t value;
+			if( !take(args, end, &value) )
+				return false;
+			switch( logSpec.length ) {
+			case LogLength::Long: print_arg(out, spec, stars, logSpec.stars, static_cast<unsigned long>(value)); break;
+			case LogLength::LongLong: print_arg(out, spec, stars, logSpec.stars, static_cast<unsigned long long>(value)); break;
+			case LogLength::IntMax: print_arg(out, spec, stars, logSpec.stars, static_cast<uintmax_t>(value)); break;
+			case LogLength::Size:
+			case LogLength::PtrDiff: print_arg(out, spec, stars, logSpec.stars, static_cast<size_t>(value)); break;
+			default: print_arg(out, spec, stars, logSpec.stars, static_cast<unsigned>(value)); break;
+			}
+			break;
+		}
+		case LogArg::Double: {
+			double value;
+			if( !take(args, end, &value) )
+				return false;
+			print_arg(out, spec, stars, logSpec.stars, value);
+			break;
+		}
+		case LogArg::LongDouble: {
+			long double value;
+			if( !take(args, end, &value) )
+				return false;
+			print_arg(out, spec, stars, logSpec.stars, value);
+			break;
+		}
+		case LogArg::Pointer: {
+			uint64_t value;
+			if( !take(args, end, &value) )
+				return false;
+			print_arg(out, spec, stars, logSpec.stars, reinterpret_cast<void*>(static_cast<uintptr_t>(value)));
+			break;
+		}
+		case LogArg::String: {
+			uint16_t len;
+			if( !take(args, end, &len) || static_cast<size_t>(end - args) < len )
+				return false;
+			const std::string str(args, len);
+			args += len;
+			print_arg(out, spec, stars, logSpec.stars, str.c_str());
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+
+	fputs(text, out);
+	return true;
+}
+
+
+void print_time(FILE* const out, const BinaryLogHeader& header, const uint64_t time)
+{
+	const double seconds = static_cast<double>(static_cast<int64_t>(time - header.startTime)) / 1e9;
+	fprintf(out, "[%12.6f] ", seconds);
+}
+
+
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+	const bool times = argc > 2 && strcmp(argv[1], "-t") == 0;
+	const char* const path = times ? argv[2] : argv[1];
+	if( argc < 2 || (argc > 2 && !times) ) {
+		LogError("usage: LogDecode [-t] <binary log>");
+		return EXIT_FAILURE;
+	}
+
+	FILE* const file = fopen(path, "rb");
+	if( !file ) {
+		LogError("Failed to open %s", path);
+		return EXIT_FAILURE;
+	}
+
+	BinaryLogHeader header;
+	if( fread(&header, sizeof(header), 1, file) != 1 
+	    || memcmp(header.magic, BinaryLogMagic, sizeof(header.magic)) != 0 ) {
+		LogError("%s is not a binary log", path);
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+
+	if( header.version != BinaryLogVersion || header.longDoubleSize != sizeof(long double) ) {
+		LogError("%s was written by another version or platform", path);
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+
+	HashMap<uint64_t, std::string> formats;
+	Vector<char> payload;
+	payload.initialize(0xffff);
+
+	int result = EXIT_SUCCESS;
+	uint8_t entry[entry_header];
+	while( fread(entry, entry_header, 1, file) == 1 )
+	{
+		uint16_t size;
+		memcpy(&size, entry + 1, sizeof(size));
+		payload.resize_uninitialized(size);
+		if( size > 0 && fread(payload.data(), size, 1, file) != 1 ) {
+			LogError("%s: truncated entry", path);
+			result = EXIT_FAILURE;
+			break;
+		}
+
+		const char* itr = payload.data();
+		const char* const end = itr + size;
+
+		uint8_t stream = 1;
+		uint64_t id = 0;
+		uint64_t time = 0;
+
+		switch( entry[0] )
+		{
+		case BinaryLogFormat:
+			if( take(itr, end, &id) )
+				formats.insert_or_assign(id, std::string(itr, end));
+			break;
+
+		case BinaryLogRecord: {
+			if( !take(itr, end, &stream) || !take(itr, end, &id) || !take(itr, end, &time) )
+				break;
+
+			FILE* const out = stream == 2 ? stderr : stdout;
+			const std::string* const fmtString = formats.find(id);
+			if( times )
+				print_time(out, header, time);
+
+			if( !fmtString || !render(out, fmtString->c_str(), itr, end) )
+				fprintf(out, "<undecodable record, format %llx>", static_cast<unsigned long long>(id));
+			fputc('\n', out);
+			break;
+		}
+
+		case BinaryLogText: {
+			if( !take(itr, end, &stream) || !take(itr, end, &time) )
+				break;
+
+			FILE* const out = stream == 2 ? stderr : stdout;
+			if( times )
+				print_time(out, header, time);
+			fwrite(itr, 1, static_cast<size_t>(end - itr), out);
+			fputc('\n', out);
+			break;
+		}
+
+		case BinaryLogDropped: {
+			uint64_t count;
+			if( take(itr, end, &count) )
+				fprintf(stderr, "utix: %llu log lines dropped\n", static_cast<unsigned long long>(count));
+			break;
+		}
+
+		default:
+			LogError("%s: unknown entry kind %d", path, entry[0]);
+			fclose(file);
+			return EXIT_FAILURE;
+		}
+	}
+
+	fclose(file);
+	return result;
+}
@@ -19,22 +19,215 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 */
 
 #include <stdlib.h>
+#include <string.h>
 #include <Utix/Alloc.h>
 #include <Utix/Assert.h>
 
+#ifdef UTIX_SLAB_ALLOC
+#include <Utix/Slab.h>
+#endif
+
+#ifdef UTIX_ALLOC_STATS
+#include <Utix/AllocStats.h>
+#define UTIX_ALLOC_STATS_(hook_call) hook_call
+#else
+#define UTIX_ALLOC_STATS_(hook_call)
+#endif
+
+#if (defined(__linux__) || defined(__APPLE__)) && UTIX_MMAP_THRESHOLD > 0
+#define UTIX_MMAP_ALLOC_ 1
+#include <sys/mman.h>
+#include <unistd.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
  
 
 namespace utix {
 
 
+// backend: the size of a block (header included) picks where it lives,
+// so free and realloc can find it again without extra bookkeeping.
+//  - up to SlabMaxBlockSize: slab allocator, if UTIX_SLAB_ALLOC is defined
+//  - from UTIX_MMAP_THRESHOLD: anonymous mapping with huge pages advice
+//  - everything else: malloc
+
+enum class Backend { Slab, Malloc, Mmap };
+
+
+static inline Backend get_backend(const size_t size)
+{
+#ifdef UTIX_MMAP_ALLOC_
+	if(size >= UTIX_MMAP_THRESHOLD)
+		return Backend::Mmap;
+#endif
+#ifdef UTIX_SLAB_ALLOC
+	if(size <= SlabMaxBlockSize)
+		return Backend::Slab;
+#endif
+	((void)size);
+	return Backend::Malloc;
+}
+
+
+
+
+#ifdef UTIX_MMAP_ALLOC_
+
+// the data starts one cache line into the mapping
+static constexpr size_t map_offset = CacheLineSize - sizeof(size_t);
+
+
+static inline size_t map_length(const size_t size)
+{
+#if defined(UTIX_MMAP_HUGETLB) && defined(MAP_HUGETLB)
+	// hugetlb mappings must be unmapped in whole huge pages
+	const size_t granularity = 2 * 1024 * 1024;
+#else
+	static const size_t granularity = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+	return (size + map_offset + (granularity - 1)) & ~(granularity - 1);
+}
+
+
+static void* mmap_alloc(const size_t size)
+{
+	const size_t length = map_length(size);
+	void* base = MAP_FAILED;
+
+#if defined(UTIX_MMAP_HUGETLB) && defined(MAP_HUGETLB)
+	base = mmap(nullptr, length, PROT_READ | PROT_WRITE, 
+	            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+	if(base == MAP_FAILED)
+	{
+		base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if(base == MAP_FAILED)
+			return nullptr;
+
+#ifdef MADV_HUGEPAGE
+		madvise(base, length, MADV_HUGEPAGE);
+#endif
+	}
+
+	return static_cast<uint8_t*>(base) + map_offset;
+}
+
+
+static inline void mmap_free(void* block, const size_t size)
+{
+	munmap(static_cast<uint8_t*>(block) - map_offset, map_length(size));
+}
+
+
+static void* mmap_realloc(void* from, const size_t oldSize, const size_t size)
+{
+	const size_t oldLength = map_length(oldSize);
+	const size_t length = map_length(size);
+
+	if(oldLength == length)
+		return from;
+
+	auto* const oldBase = static_cast<uint8_t*>(from) - map_offset;
+
+#ifdef __linux__
+	// the kernel moves the page tables, nothing is copied
+	void* const base = mremap(oldBase, oldLength, length, MREMAP_MAYMOVE);
+	if(base != MAP_FAILED)
+		return static_cast<uint8_t*>(base) + map_offset;
+#endif
+
+	void* const block = mmap_alloc(size);
+	if(block) {
+		memcpy(block, from, oldSize < size ? oldSize : size);
+		munmap(oldBase, oldLength);
+	}
+
+	return block;
+}
+
+#endif // UTIX_MMAP_ALLOC_
+
+
+
+
+
+static inline void* backend_alloc(const size_t size)
+{
+	switch(get_backend(size))
+	{
+#ifdef UTIX_SLAB_ALLOC
+	case Backend::Slab: return slab_alloc(size);
+#endif
+#ifdef UTIX_MMAP_ALLOC_
+	case Backend::Mmap: return mmap_alloc(size);
+#endif
+	default: return malloc(size);
+	}
+}
+
+
+static inline void backend_free(void* block, const size_t size)
+{
+	switch(get_backend(size))
+	{
+#ifdef UTIX_SLAB_ALLOC
+	case Backend::Slab: slab_free(block, size); break;
+#endif
+#ifdef UTIX_MMAP_ALLOC_
+	case Backend::Mmap: mmap_free(block, size); break;
+#endif
+	default: free(block); break;
+	}
+}
+
+
+static inline void* backend_realloc(void* from, const size_t oldSize, const size_t size)
+{
+	const auto backend = get_backend(size);
+
+	if(backend == get_backend(oldSize))
+	{
+		switch(backend)
+		{
+#ifdef UTIX_SLAB_ALLOC
+		case Backend::Slab:
+			if(slab_block_size(oldSize) == slab_block_size(size))
+				return from;
+			break;
+#endif
+#ifdef UTIX_MMAP_ALLOC_
+		case Backend::Mmap: return mmap_realloc(from, oldSize, size);
+#endif
+		default: return realloc(from, size);
+		}
+	}
+
+	// moving between backends
+	void* const block = backend_alloc(size);
+	if(block) {
+		memcpy(block, from, oldSize < size ? oldSize : size);
+		backend_free(from, oldSize);
+	}
+
+	return block;
+}
+
+
+
+
 void* _alloc_arr(const size_t size) UTIX_NOEXCEPT_
 {
 	ASSERT_MSG(size > 0, "attempt to alloc array of size 0");
 
-	auto* const block = (size_t*) malloc(size + sizeof(size_t));
+	auto* const block = (size_t*) backend_alloc(size + sizeof(size_t));
 	
 	if (block)
 	{
+		UTIX_ALLOC_STATS_(_alloc_stats_on_alloc(size));
 		*block = size;
 		return block + 1;
 	}
@@ -49,10 +242,13 @@ void* _realloc_arr(void* from, const size_t size) UTIX_NOEXCEPT_
 	ASSERT_MSG(from != nullptr, "attempt to realloc from null pointer!");
 	ASSERT_MSG(size > 0, "attempt to realloc to size 0!");
 
-	auto* const block = (size_t*) realloc(((size_t*)from-1), size + sizeof(size_t));
+	auto* const oldBlock = ((size_t*)from) - 1;
+	const size_t oldSize = *oldBlock;
+	auto* const block = (size_t*) backend_realloc(oldBlock, oldSize + sizeof(size_t), size + sizeof(size_t));
 
 	if(block)
 	{
+		UTIX_ALLOC_STATS_(_alloc_stats_on_realloc(oldSize, size));
 		*block = size;
 		return block + 1;
 	}
@@ -62,6 +258,97 @@ void* _realloc_arr(void* from, const size_t size) UTIX_NOEXCEPT_
 
 
 
+void _free_arr(void* block) UTIX_NOEXCEPT_
+{
+	auto* const header = ((size_t*)block) - 1;
+	UTIX_ALLOC_STATS_(_alloc_stats_on_free(*header));
+	backend_free(header, *header + sizeof(size_t));
+}
+
+
+
+
+// aligned blocks come straight from malloc with room to align:
+// [ padding ][ offset to malloc block ][ size ][ data... ]
+
+static inline size_t aligned_total(const size_t size, const size_t alignment)
+{
+	return size + (sizeof(size_t) * 2) + (alignment - 1);
+}
+
+
+static inline size_t* aligned_header(uint8_t* const raw, const size_t alignment)
+{
+	const auto first = reinterpret_cast<uintptr_t>(raw + (sizeof(size_t) * 2));
+	const auto data = (first + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+	return reinterpret_cast<size_t*>(data) - 1;
+}
+
+
+
+void* _alloc_arr_aligned(const size_t size, const size_t alignment) UTIX_NOEXCEPT_
+{
+	ASSERT_MSG(size > 0, "attempt to alloc array of size 0");
+	ASSERT_MSG(alignment != 0 && (alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+
+	auto* const raw = (uint8_t*) malloc(aligned_total(size, alignment));
+
+	if (raw)
+	{
+		UTIX_ALLOC_STATS_(_alloc_stats_on_alloc(size));
+		auto* const header = aligned_header(raw, alignment);
+		header[-1] = reinterpret_cast<uint8_t*>(header + 1) - raw;
+		header[0] = size;
+		return header + 1;
+	}
+
+	return nullptr;
+}
+
+
+
+void* _realloc_arr_aligned(void* from, const size_t size, const size_t alignment) UTIX_NOEXCEPT_
+{
+	ASSERT_MSG(from != nullptr, "attempt to realloc from null pointer!");
+	ASSERT_MSG(size > 0, "attempt to realloc to size 0!");
+	ASSERT_MSG(alignment != 0 && (alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+	ASSERT_MSG(((uintptr_t)from & (alignment - 1)) == 0, "realloc with a different alignment");
+
+	auto* const oldHeader = ((size_t*)from) - 1;
+	const size_t oldSize = oldHeader[0];
+	const size_t oldOffset = oldHeader[-1];
+
+	auto* const raw = (uint8_t*) realloc(((uint8_t*)from) - oldOffset, aligned_total(size, alignment));
+
+	if (!raw)
+		return nullptr;
+
+	UTIX_ALLOC_STATS_(_alloc_stats_on_realloc(oldSize, size));
+
+	// realloc keeps malloc's alignment only, the data may need to slide
+	auto* const header = aligned_header(raw, alignment);
+	auto* const data = reinterpret_cast<uint8_t*>(header + 1);
+	const size_t offset = data - raw;
+
+	if (offset != oldOffset)
+		memmove(data, raw + oldOffset, oldSize < size ? oldSize : size);
+
+	header[-1] = offset;
+	header[0] = size;
+	return data;
+}
+
+
+
+void _free_arr_aligned(void* block) UTIX_NOEXCEPT_
+{
+	auto* const header = ((size_t*)block) - 1;
+	UTIX_ALLOC_STATS_(_alloc_stats_on_free(header[0]));
+	free(((uint8_t*)block) - header[-1]);
+}
+
+
+
 
 }
 
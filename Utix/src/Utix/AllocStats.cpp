@@ -0,0 +1,266 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <Utix/AllocStats.h>
+
+
+
+namespace utix {
+
+
+#ifdef UTIX_ALLOC_STATS
+
+namespace {
+
+
+// counters are written only by the owner thread, 
+// atomics just make the reads from GetAllocStats safe
+struct ThreadAllocStats
+{
+	ThreadAllocStats();
+	ThreadAllocStats(const ThreadAllocStats&) = delete;
+	ThreadAllocStats& operator=(const ThreadAllocStats&) = delete;
+	~ThreadAllocStats();
+
+	std::atomic<uint64_t> allocs{0};
+	std::atomic<uint64_t> reallocs{0};
+	std::atomic<uint64_t> frees{0};
+	std::atomic<int64_t> pendingBytes{0};
+	std::atomic<uint64_t> histogram[AllocStatsBuckets];
+
+	ThreadAllocStats* prev = nullptr;
+	ThreadAllocStats* next = nullptr;
+};
+
+
+std::mutex threads_mutex;
+ThreadAllocStats* threads_head = nullptr;
+
+// counters of threads that are gone
+uint64_t retired_allocs = 0;
+uint64_t retired_reallocs = 0;
+uint64_t retired_frees = 0;
+uint64_t retired_histogram[AllocStatsBuckets] = { };
+
+std::atomic<int64_t> live_bytes{0};
+std::atomic<int64_t> peak_bytes{0};
+
+thread_local ThreadAllocStats thread_stats;
+
+
+
+inline void increment(std::atomic<uint64_t>& counter)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+inline size_t get_bucket(size_t bytes)
+{
+	size_t bucket = 0;
+	while(bytes > 1 && bucket < (AllocStatsBuckets - 1)) {
+		bytes >>= 1;
+		++bucket;
+	}
+
+	return bucket;
+}
+
+
+void publish(const int64_t bytes)
+{
+	const int64_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+	while(live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+
+inline void add_live(ThreadAllocStats& stats, const int64_t bytes)
+{
+	const int64_t pending = stats.pendingBytes.load(std::memory_order_relaxed) + bytes;
+	const int64_t limit = static_cast<int64_t>(AllocStatsFlushBytes);
+
+	if(pending >= limit || pending <= -limit) {
+		stats.pendingBytes.store(0, std::memory_order_relaxed);
+		publish(pending);
+	} else {
+		stats.pendingBytes.store(pending, std::memory_order_relaxed);
+	}
+}
+
+
+
+ThreadAllocStats::ThreadAllocStats()
+{
+	for(auto& bucket : histogram)
+		bucket.store(0, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	next = threads_head;
+	if(threads_head)
+		threads_head->prev = this;
+	threads_head = this;
+}
+
+
+ThreadAllocStats::~ThreadAllocStats()
+{
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	retired_allocs += allocs.load(std::memory_order_relaxed);
+	retired_reallocs += reallocs.load(std::memory_order_relaxed);
+	retired_frees += frees.load(std::memory_order_relaxed);
+	for(size_t i = 0; i < AllocStatsBuckets; ++i)
+		retired_histogram[i] += histogram[i].load(std::memory_order_relaxed);
+
+	publish(pendingBytes.exchange(0, std::memory_order_relaxed));
+
+	if(prev)
+		prev->next = next;
+	else
+		threads_head = next;
+	if(next)
+		next->prev = prev;
+}
+
+
+
+} // anonymous namespace
+
+
+
+
+void _alloc_stats_on_alloc(const size_t bytes) noexcept
+{
+	ThreadAllocStats& stats = thread_stats;
+	increment(stats.allocs);
+	increment(stats.histogram[get_bucket(bytes)]);
+	add_live(stats, static_cast<int64_t>(bytes));
+}
+
+
+void _alloc_stats_on_realloc(const size_t oldBytes, const size_t bytes) noexcept
+{
+	ThreadAllocStats& stats = thread_stats;
+	increment(stats.reallocs);
+	increment(stats.histogram[get_bucket(bytes)]);
+	add_live(stats, static_cast<int64_t>(bytes) - static_cast<int64_t>(oldBytes));
+}
+
+
+void _alloc_stats_on_free(const size_t bytes) noexcept
+{
+	ThreadAllocStats& stats = thread_stats;
+	increment(stats.frees);
+	add_live(stats, -static_cast<int64_t>(bytes));
+}
+
+
+
+AllocStats GetAllocStats() noexcept
+{
+	AllocStats stats { };
+	stats.enabled = true;
+
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	stats.allocs = retired_allocs;
+	stats.reallocs = retired_reallocs;
+	stats.frees = retired_frees;
+	for(size_t i = 0; i < AllocStatsBuckets; ++i)
+		stats.histogram[i] = retired_histogram[i];
+
+	stats.liveBytes = live_bytes.load(std::memory_order_relaxed);
+
+	for(auto* itr = threads_head; itr != nullptr; itr = itr->next)
+	{
+		stats.allocs += itr->allocs.load(std::memory_order_relaxed);
+		stats.reallocs += itr->reallocs.load(std::memory_order_relaxed);
+		stats.frees += itr->frees.load(std::memory_order_relaxed);
+		stats.liveBytes += itr->pendingBytes.load(std::memory_order_relaxed);
+		for(size_t i = 0; i < AllocStatsBuckets; ++i)
+			stats.histogram[i] += itr->histogram[i].load(std::memory_order_relaxed);
+	}
+
+	const int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+	stats.peakBytes = peak > stats.liveBytes ? peak : stats.liveBytes;
+	return stats;
+}
+
+
+
+#else // UTIX_ALLOC_STATS
+
+
+
+AllocStats GetAllocStats() noexcept
+{
+	AllocStats stats { };
+	stats.enabled = false;
+	return stats;
+}
+
+
+
+#endif // UTIX_ALLOC_STATS
+
+
+
+
+
+std::string AllocStatsToJson(const AllocStats& stats)
+{
+	char buffer[256];
+	snprintf(buffer, sizeof(buffer), 
+	         "{\"enabled\":%s,\"allocs\":%llu,\"reallocs\":%llu,\"frees\":%llu,"
+	         "\"live_bytes\":%lld,\"peak_bytes\":%lld,\"histogram\":[",
+	         stats.enabled ? "true" : "false",
+	         static_cast<unsigned long long>(stats.allocs),
+	         static_cast<unsigned long long>(stats.reallocs),
+	         static_cast<unsigned long long>(stats.frees),
+	         static_cast<long long>(stats.liveBytes),
+	         static_cast<long long>(stats.peakBytes));
+
+	std::string json(buffer);
+
+	// only the buckets in use, each one as its lower bound and count
+	bool first = true;
+	for(size_t i = 0; i < AllocStatsBuckets; ++i)
+	{
+		if(stats.histogram[i] == 0)
+			continue;
+
+		snprintf(buffer, sizeof(buffer), "%s{\"min_bytes\":%llu,\"count\":%llu}",
+		         first ? "" : ",",
+		         1ull << i,
+		         static_cast<unsigned long long>(stats.histogram[i]));
+		json += buffer;
+		first = false;
+	}
+
+	json += "]}";
+	return json;
+}
+
+
+
+
+}
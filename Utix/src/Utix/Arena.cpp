@@ -0,0 +1,289 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <Utix/Arena.h>
+#include <Utix/Assert.h>
+#include <Utix/Log.h>
+
+
+
+namespace utix {
+
+
+// blocks are aligned like malloc's, the size header sits right before them
+static constexpr size_t block_align = alignof(std::max_align_t);
+
+
+static inline uintptr_t align_up(const uintptr_t value)
+{
+	return (value + (block_align - 1)) & ~static_cast<uintptr_t>(block_align - 1);
+}
+
+
+template<class Chunk>
+static inline uint8_t* chunk_base(Chunk* const chunk)
+{
+	return reinterpret_cast<uint8_t*>(chunk + 1);
+}
+
+
+template<class Chunk>
+static void* chunk_bump(Chunk* const chunk, const size_t bytes)
+{
+	const auto base = reinterpret_cast<uintptr_t>(chunk_base(chunk));
+	const auto data = align_up(base + chunk->used + sizeof(size_t));
+
+	if( bytes > chunk->size || data + bytes > base + chunk->size )
+		return nullptr;
+
+	chunk->used = (data + bytes) - base;
+	auto* const header = reinterpret_cast<size_t*>(data) - 1;
+	*header = bytes;
+	return header + 1;
+}
+
+
+
+
+
+Arena::Arena(const size_t chunkSize) noexcept
+	: _chunkSize(chunkSize)
+{
+	ASSERT_MSG(chunkSize > 0, "Arena chunk size must be greater than 0");
+}
+
+
+Arena::Arena(void* buffer, const size_t bufferSize, const size_t chunkSize) noexcept
+	: _chunkSize(chunkSize)
+{
+	ASSERT_MSG(buffer != nullptr, "Arena buffer must not be null");
+	ASSERT_MSG(chunkSize > 0, "Arena chunk size must be greater than 0");
+
+	// the buffer holds its own chunk header
+	const auto begin = reinterpret_cast<uintptr_t>(buffer);
+	const auto chunkAddr = (begin + (alignof(Chunk) - 1)) & ~static_cast<uintptr_t>(alignof(Chunk) - 1);
+	const size_t overhead = (chunkAddr - begin) + sizeof(Chunk);
+
+	if( bufferSize > overhead ) 
+	{
+		auto* const chunk = reinterpret_cast<Chunk*>(chunkAddr);
+		chunk->next = nullptr;
+		chunk->size = bufferSize - overhead;
+		chunk->used = 0;
+		chunk->owned = false;
+		_head = chunk;
+		_current = chunk;
+	}
+}
+
+
+Arena::Arena(Arena&& rhs) noexcept
+	: _head(rhs._head),
+	_current(rhs._current),
+	_chunkSize(rhs._chunkSize)
+{
+	rhs._head = nullptr;
+	rhs._current = nullptr;
+}
+
+
+Arena& Arena::operator=(Arena&& rhs) noexcept
+{
+	this->Swap(rhs);
+	return *this;
+}
+
+
+Arena::~Arena()
+{
+	this->Free();
+}
+
+
+
+
+void* Arena::Alloc(const size_t bytes) noexcept
+{
+	ASSERT_MSG(bytes > 0, "attempt to alloc array of size 0");
+
+	if( _current ) 
+	{
+		void* const block = chunk_bump(_current, bytes);
+		if( block )
+			return block;
+	}
+
+	if( !this->NextChunk(bytes + sizeof(size_t) + block_align) )
+		return nullptr;
+
+	return chunk_bump(_current, bytes);
+}
+
+
+
+
+void* Arena::Realloc(void* from, const size_t bytes) noexcept
+{
+	ASSERT_MSG(from != nullptr, "attempt to realloc from null pointer!");
+	ASSERT_MSG(bytes > 0, "attempt to realloc to size 0!");
+
+	auto* const header = static_cast<size_t*>(from) - 1;
+	const size_t oldBytes = *header;
+
+	// the last block of the current chunk can grow or shrink in place
+	if( _current ) 
+	{
+		uint8_t* const base = chunk_base(_current);
+		uint8_t* const block = static_cast<uint8_t*>(from);
+
+		if( block + oldBytes == base + _current->used 
+		    && bytes <= _current->size - static_cast<size_t>(block - base) )
+		{
+			_current->used = static_cast<size_t>(block - base) + bytes;
+			*header = bytes;
+			return from;
+		}
+	}
+
+	void* const block = this->Alloc(bytes);
+
+	if( block )
+		memcpy(block, from, oldBytes < bytes ? oldBytes : bytes);
+
+	return block;
+}
+
+
+
+
+void Arena::Rollback(const Mark& mark) noexcept
+{
+	if( !mark.chunk ) 
+	{
+		this->Reset();
+		return;
+	}
+
+	ASSERT_MSG(mark.used <= mark.chunk->size, "invalid Arena mark");
+	_current = mark.chunk;
+	_current->used = mark.used;
+}
+
+
+
+void Arena::Reset() noexcept
+{
+	// chunks are kept for reuse, only the cursor goes back
+	if( _head ) 
+	{
+		_current = _head;
+		_current->used = 0;
+	}
+}
+
+
+
+void Arena::Free() noexcept
+{
+	// a caller's buffer is always the head, it stays
+	Chunk* const buffer = _head && !_head->owned ? _head : nullptr;
+
+	Chunk* chunk = _head;
+	while( chunk ) 
+	{
+		Chunk* const next = chunk->next;
+		if( chunk->owned )
+			free(chunk);
+		chunk = next;
+	}
+
+	if( buffer ) 
+	{
+		buffer->next = nullptr;
+		buffer->used = 0;
+	}
+
+	_head = buffer;
+	_current = buffer;
+}
+
+
+
+void Arena::Swap(Arena& other) noexcept
+{
+	if( &other != this )
+	{
+		auto* const headAux = this->_head;
+		auto* const currentAux = this->_current;
+		const auto chunkSizeAux = this->_chunkSize;
+		this->_head = other._head;
+		this->_current = other._current;
+		this->_chunkSize = other._chunkSize;
+		other._head = headAux;
+		other._current = currentAux;
+		other._chunkSize = chunkSizeAux;
+	}
+}
+
+
+
+
+bool Arena::NextChunk(const size_t minSize) noexcept
+{
+	Chunk* const next = _current ? _current->next : _head;
+
+	// reuse chunks left behind by Reset / Rollback
+	if( next && next->size >= minSize ) 
+	{
+		next->used = 0;
+		_current = next;
+		return true;
+	}
+
+	const size_t size = minSize > _chunkSize ? minSize : _chunkSize;
+	auto* const chunk = static_cast<Chunk*>(malloc(sizeof(Chunk) + size));
+
+	if( !chunk ) 
+	{
+		LogError("Arena failed to allocate chunk of %zu bytes", size);
+		return false;
+	}
+
+	chunk->next = next;
+	chunk->size = size;
+	chunk->used = 0;
+	chunk->owned = true;
+
+	if( _current )
+		_current->next = chunk;
+	else
+		_head = chunk;
+
+	_current = chunk;
+	return true;
+}
+
+
+
+
+
+}
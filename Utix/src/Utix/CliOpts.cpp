@@ -23,6 +23,7 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 
 
 
+#include <iterator>
 #include <Utix/Ints.h>
 #include <Utix/Log.h>
 #include <Utix/CliOpts.h>
@@ -34,14 +35,20 @@ namespace utix {
 
 CliOpts::CliOpts(int argc, char** argv)
 {
-	Vector::initialize(argv, argv + argc);
+	SmallVector::initialize(argv, argv + argc);
 }
 
 
+// the strings' buffers change hands, nothing is copied
 CliOpts::CliOpts(Vector<std::string>&& cliArgs)
-	: Vector(std::move(cliArgs))
 {
+	SmallVector::initialize(cliArgs.size());
 
+	const auto end = std::make_move_iterator(cliArgs.end());
+	for (auto itr = std::make_move_iterator(cliArgs.begin()); itr != end; ++itr)
+		this->emplace_back(*itr);
+
+	cliArgs.free();
 }
 
 
@@ -0,0 +1,221 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <string.h>
+#include <stdio.h>
+#include <Utix/CpuFeatures.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define UTIX_CPU_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define UTIX_CPU_X86 0
+#endif
+
+
+namespace utix {
+
+
+#if UTIX_CPU_X86
+
+
+static void cpuid(const uint32_t leaf, uint32_t regs[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int out[4];
+	__cpuidex(out, static_cast<int>(leaf), 0);
+	for(int i = 0; i < 4; ++i)
+		regs[i] = static_cast<uint32_t>(out[i]);
+#else
+	__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+
+// which register states the os saves on context switches
+static uint64_t xgetbv0()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	return _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (uint64_t(edx) << 32) | eax;
+#endif
+}
+
+
+static CpuFeatures detect()
+{
+	CpuFeatures cpu;
+	cpu.flags = 0;
+
+	uint32_t regs[4];
+	cpuid(0, regs);
+	const uint32_t max_leaf = regs[0];
+	memcpy(cpu.vendor, &regs[1], 4);
+	memcpy(cpu.vendor + 4, &regs[3], 4);
+	memcpy(cpu.vendor + 8, &regs[2], 4);
+	cpu.vendor[12] = '\0';
+
+	if( max_leaf < 1 )
+		return cpu;
+
+	const auto bit = [](const uint32_t reg, const int n) { return ((reg >> n) & 1) != 0; };
+	const auto set = [&cpu](const bool present, const uint32_t flag) { if( present ) cpu.flags |= flag; };
+
+	cpuid(1, regs);
+	const uint32_t ecx1 = regs[2];
+	set(bit(regs[3], 26), CpuFeatures::Sse2);
+	set(bit(ecx1, 0), CpuFeatures::Sse3);
+	set(bit(ecx1, 9), CpuFeatures::Ssse3);
+	set(bit(ecx1, 19), CpuFeatures::Sse41);
+	set(bit(ecx1, 20), CpuFeatures::Sse42);
+	set(bit(ecx1, 23), CpuFeatures::Popcnt);
+
+	// AVX and up also need the os to save the ymm / zmm state
+	const uint64_t xcr0 = bit(ecx1, 27) ? xgetbv0() : 0;
+	const bool ymm = (xcr0 & 0x06) == 0x06;
+	const bool zmm = (xcr0 & 0xE6) == 0xE6;
+
+	set(ymm && bit(ecx1, 28), CpuFeatures::Avx);
+	set(ymm && bit(ecx1, 12), CpuFeatures::Fma);
+
+	if( max_leaf < 7 )
+		return cpu;
+
+	cpuid(7, regs);
+	const uint32_t ebx7 = regs[1];
+	set(bit(ebx7, 3), CpuFeatures::Bmi1);
+	set(bit(ebx7, 8), CpuFeatures::Bmi2);
+	set(ymm && bit(ebx7, 5), CpuFeatures::Avx2);
+	set(zmm && bit(ebx7, 16), CpuFeatures::Avx512F);
+	set(zmm && bit(ebx7, 30), CpuFeatures::Avx512BW);
+	set(zmm && bit(ebx7, 31), CpuFeatures::Avx512VL);
+	return cpu;
+}
+
+
+#elif defined(__aarch64__) || defined(__arm__)
+
+
+// the kernel's hwcaps, read from /proc/self/auxv rather than getauxval,
+// which old Android API levels don't have
+static void read_hwcaps(unsigned long& hwcap, unsigned long& hwcap2)
+{
+	constexpr unsigned long at_hwcap = 16;
+	constexpr unsigned long at_hwcap2 = 26;
+	hwcap = hwcap2 = 0;
+
+	FILE* const file = fopen("/proc/self/auxv", "rb");
+	if( !file )
+		return;
+
+	unsigned long entry[2];
+	while( fread(entry, sizeof(entry), 1, file) == 1 && entry[0] != 0 ) {
+		if( entry[0] == at_hwcap )
+			hwcap = entry[1];
+		else if( entry[0] == at_hwcap2 )
+			hwcap2 = entry[1];
+	}
+
+	fclose(file);
+}
+
+
+static CpuFeatures detect()
+{
+	CpuFeatures cpu;
+	cpu.flags = 0;
+	cpu.vendor[0] = '\0';
+
+	unsigned long hwcap, hwcap2;
+	read_hwcaps(hwcap, hwcap2);
+
+#if defined(__aarch64__)
+	// advanced simd is part of armv8-a
+	cpu.flags |= CpuFeatures::Neon;
+	if( hwcap & (1ul << 7) )
+		cpu.flags |= CpuFeatures::Crc32;
+#else
+	if( hwcap & (1ul << 12) )
+		cpu.flags |= CpuFeatures::Neon;
+	if( hwcap2 & (1ul << 4) )
+		cpu.flags |= CpuFeatures::Crc32;
+#endif
+
+	return cpu;
+}
+
+
+#else
+
+
+static CpuFeatures detect()
+{
+	CpuFeatures cpu;
+	cpu.flags = 0;
+	cpu.vendor[0] = '\0';
+	return cpu;
+}
+
+
+#endif
+
+
+
+
+const CpuFeatures& get_cpu_features()
+{
+	static const CpuFeatures cpu = detect();
+	return cpu;
+}
+
+
+const char* get_cpu_feature_name(const uint32_t flag)
+{
+	switch( flag ) 
+	{
+	case CpuFeatures::Sse2: return "sse2";
+	case CpuFeatures::Sse3: return "sse3";
+	case CpuFeatures::Ssse3: return "ssse3";
+	case CpuFeatures::Sse41: return "sse4.1";
+	case CpuFeatures::Sse42: return "sse4.2";
+	case CpuFeatures::Popcnt: return "popcnt";
+	case CpuFeatures::Avx: return "avx";
+	case CpuFeatures::Avx2: return "avx2";
+	case CpuFeatures::Fma: return "fma";
+	case CpuFeatures::Bmi1: return "bmi1";
+	case CpuFeatures::Bmi2: return "bmi2";
+	case CpuFeatures::Avx512F: return "avx512f";
+	case CpuFeatures::Avx512BW: return "avx512bw";
+	case CpuFeatures::Avx512VL: return "avx512vl";
+	case CpuFeatures::Neon: return "neon";
+	case CpuFeatures::Crc32: return "crc32";
+	default: return "unknown";
+	}
+}
+
+
+}
@@ -0,0 +1,777 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Utix/Format.h>
+#include <Utix/Alloc.h>
+
+
+namespace utix {
+
+namespace {
+
+const char digit_pairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+const char lower_digits[] = "0123456789abcdef";
+const char upper_digits[] = "0123456789ABCDEF";
+
+
+// writes value's digits so they end at 'end', returns where they start
+char* write_decimal(char* end, uint64_t value)
+{
+	while( value >= 100 ) 
+	{
+		const unsigned pair = static_cast<unsigned>(value % 100) * 2;
+		value /= 100;
+		*--end = digit_pairs[pair + 1];
+		*--end = digit_pairs[pair];
+	}
+
+	if( value >= 10 ) {
+		const unsigned pair = static_cast<unsigned>(value) * 2;
+		*--end = digit_pairs[pair + 1];
+		*--end = digit_pairs[pair];
+	}
+	else {
+		*--end = static_cast<char>('0' + value);
+	}
+
+	return end;
+}
+
+
+// hex, octal and binary
+char* write_radix(char* end, uint64_t value, const unsigned shift, const char* const digits)
+{
+	const uint64_t mask = (uint64_t(1) << shift) - 1;
+	do {
+		*--end = digits[value & mask];
+		value >>= shift;
+	} while( value );
+	return end;
+}
+
+
+
+
+// Grisu3 (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately").
+// it proves its digits are the shortest that read back, and the closest of those,
+// or gives up on the ~0.5% of values it can't settle, those go through printf
+
+struct DiyFp
+{
+	uint64_t f;
+	int e;
+};
+
+
+// 10^k for k = -348, -340 ... 340, normalized to 64 bits
+const uint64_t cached_powers_f[] = {
+	0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76, 0xcf42894a5dce35ea,
+	0x9a6bb0aa55653b2d, 0xe61acf033d1a45df, 0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f,
+	0xbe5691ef416bd60c, 0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+	0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57, 0xc21094364dfb5637,
+	0x9096ea6f3848984f, 0xd77485cb25823ac7, 0xa086cfcd97bf97f4, 0xef340a98172aace5,
+	0xb23867fb2a35b28e, 0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+	0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126, 0xb5b5ada8aaff80b8,
+	0x87625f056c7c4a8b, 0xc9bcff6034c13053, 0x964e858c91ba2655, 0xdff9772470297ebd,
+	0xa6dfbd9fb8e5b88f, 0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+	0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06, 0xaa242499697392d3,
+	0xfd87b5f28300ca0e, 0xbce5086492111aeb, 0x8cbccc096f5088cc, 0xd1b71758e219652c,
+	0x9c40000000000000, 0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+	0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068, 0x9f4f2726179a2245,
+	0xed63a231d4c4fb27, 0xb0de65388cc8ada8, 0x83c7088e1aab65db, 0xc45d1df942711d9a,
+	0x924d692ca61be758, 0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+	0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d, 0x952ab45cfa97a0b3,
+	0xde469fbd99a05fe3, 0xa59bc234db398c25, 0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece,
+	0x88fcf317f22241e2, 0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+	0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410, 0x8bab8eefb6409c1a,
+	0xd01fef10a657842c, 0x9b10a4e5e9913129, 0xe7109bfba19c0c9d, 0xac2820d9623bf429,
+	0x80444b5e7aa7cf85, 0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+	0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b
+};
+
+const int16_t cached_powers_e[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+	-901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+	-582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+	-263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+	56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+	694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+	1013, 1039, 1066
+};
+
+const uint32_t pow10_32[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+
+DiyFp multiply(const DiyFp& x, const DiyFp& y)
+{
+	const uint64_t m32 = 0xffffffff;
+	const uint64_t a = x.f >> 32, b = x.f & m32;
+	const uint64_t c = y.f >> 32, d = y.f & m32;
+	const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+
+	// the low half only matters for rounding
+	const uint64_t mid = (bd >> 32) + (ad & m32) + (bc & m32) + (uint64_t(1) << 31);
+	return DiyFp { ac + (ad >> 32) + (bc >> 32) + (mid >> 32), x.e + y.e + 64 };
+}
+
+
+DiyFp normalize(DiyFp x)
+{
+#if defined(__GNUC__)
+	const int shift = __builtin_clzll(x.f);
+	x.f <<= shift;
+	x.e -= shift;
+#else
+	while( !(x.f & (uint64_t(1) << 63)) ) {
+		x.f <<= 1;
+		--x.e;
+	}
+#endif
+	return x;
+}
+
+
+// the cached power that brings a product with exponent e into [-60, -32]
+DiyFp cached_power(const int e, int* const k)
+{
+	const double dk = (-61 - e) * 0.30102999566398114 + 347;
+	int ik = static_cast<int>(dk);
+	if( dk - ik > 0.0 )
+		++ik;
+
+	const unsigned index = static_cast<unsigned>((ik >> 3) + 1);
+	*k = -(-348 + static_cast<int>(index << 3));
+	return DiyFp { cached_powers_f[index], cached_powers_e[index] };
+}
+
+
+// steps the last digit down toward w while that stays inside the safe interval,
+// false if the result isn't provably the closest or inside it
+bool round_weed(char* const digits, const int len, const uint64_t distanceTooHighW, const uint64_t unsafe,
+                uint64_t rest, const uint64_t tenKappa, const uint64_t unit)
+{
+	const uint64_t smallDistance = distanceTooHighW - unit;
+	const uint64_t bigDistance = distanceTooHighW + unit;
+
+	while( rest < smallDistance && unsafe - rest >= tenKappa 
+	       && (rest + tenKappa < smallDistance || smallDistance - rest >= rest + tenKappa - smallDistance) ) {
+		--digits[len - 1];
+		rest += tenKappa;
+	}
+
+	// w's real position is anywhere within a unit, another candidate could be as close
+	if( rest < bigDistance && unsafe - rest >= tenKappa 
+	    && (rest + tenKappa < bigDistance || bigDistance - rest > rest + tenKappa - bigDistance) )
+		return false;
+
+	return 2 * unit <= rest && rest <= unsafe - 4 * unit;
+}
+
+
+unsigned count_digits(const uint32_t n)
+{
+	unsigned count = 1;
+	while( count < 10 && n >= pow10_32[count] )
+		++count;
+	return count;
+}
+
+
+// w, low and high share an exponent in [-60, -32]. the products are off by up to
+// a unit, digits stop once they're inside the unsafe interval (low - unit, high + unit)
+bool digit_gen(const DiyFp& w, const DiyFp& low, const DiyFp& high, char* const digits, int* const len, int* const k)
+{
+	uint64_t unit = 1;
+	const uint64_t tooHigh = high.f + unit;
+	uint64_t unsafe = tooHigh - (low.f - unit);
+	const DiyFp one { uint64_t(1) << -w.e, w.e };
+	uint32_t p1 = static_cast<uint32_t>(tooHigh >> -one.e);
+	uint64_t p2 = tooHigh & (one.f - 1);
+	int kappa = static_cast<int>(count_digits(p1));
+	*len = 0;
+
+	while( kappa > 0 ) 
+	{
+		const uint32_t div = pow10_32[kappa - 1];
+		digits[(*len)++] = static_cast<char>('0' + p1 / div);
+		p1 %= div;
+
+		--kappa;
+		const uint64_t rest = (static_cast<uint64_t>(p1) << -one.e) + p2;
+		if( rest < unsafe ) {
+			*k += kappa;
+			return round_weed(digits, *len, tooHigh - w.f, unsafe, rest, static_cast<uint64_t>(div) << -one.e, unit);
+		}
+	}
+
+	for(;;) 
+	{
+		p2 *= 10;
+		unit *= 10;
+		unsafe *= 10;
+		digits[(*len)++] = static_cast<char>('0' + (p2 >> -one.e));
+
+		p2 &= one.f - 1;
+		--kappa;
+		if( p2 < unsafe ) {
+			*k += kappa;
+			return round_weed(digits, *len, (tooHigh - w.f) * unit, unsafe, p2, one.f, unit);
+		}
+	}
+}
+
+
+template<class T>
+struct FloatBits;
+
+template<>
+struct FloatBits<double>
+{
+	using Uint = uint64_t;
+	static constexpr int mantissa = 52;
+	static constexpr int bias = 1023 + 52;
+	static constexpr unsigned maxExponent = 0x7ff;
+};
+
+template<>
+struct FloatBits<float>
+{
+	using Uint = uint32_t;
+	static constexpr int mantissa = 23;
+	static constexpr int bias = 127 + 23;
+	static constexpr unsigned maxExponent = 0xff;
+};
+
+
+// value = digits * 10^k. value is finite and not zero, the sign is ignored.
+// false if Grisu3 can't vouch for the digits
+template<class T>
+bool grisu3(const T value, char* const digits, int* const len, int* const k)
+{
+	using Bits = FloatBits<T>;
+	typename Bits::Uint bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	const uint64_t hidden = uint64_t(1) << Bits::mantissa;
+	const int biased = static_cast<int>((bits >> Bits::mantissa) & Bits::maxExponent);
+	const uint64_t significand = bits & (hidden - 1);
+	const DiyFp v = biased ? DiyFp { significand + hidden, biased - Bits::bias }
+	                       : DiyFp { significand, 1 - Bits::bias };
+
+	// the boundaries halfway to the neighbours, the lower one is closer at a power of two.
+	// normalized v and plus have the same exponent
+	const DiyFp plus = normalize(DiyFp { (v.f << 1) + 1, v.e - 1 });
+	DiyFp minus = v.f == hidden && biased > 1 ? DiyFp { (v.f << 2) - 1, v.e - 2 } 
+	                                          : DiyFp { (v.f << 1) - 1, v.e - 1 };
+	minus.f <<= minus.e - plus.e;
+	minus.e = plus.e;
+
+	const DiyFp cached = cached_power(plus.e, k);
+	return digit_gen(multiply(normalize(v), cached), multiply(minus, cached), multiply(plus, cached), 
+	                 digits, len, k);
+}
+
+
+// what Grisu3 gives up on: the fewest of printf's exactly rounded digits that read back
+inline bool reads_back(const char* const text, const double value) { return strtod(text, nullptr) == value; }
+inline bool reads_back(const char* const text, const float value) { return strtof(text, nullptr) == value; }
+
+template<class T>
+void exact_shortest(const T value, char* const digits, int* const len, int* const k)
+{
+	const T magnitude = value < 0 ? -value : value;
+	char text[40];
+	int precision = 0;
+	while( snprintf(text, sizeof(text), "%.*e", precision, static_cast<double>(magnitude)) > 0 
+	       && !reads_back(text, magnitude) && precision < 16 )
+		++precision;
+
+	// d.ddde+XX, the decimal point is the locale's
+	const char* itr = text;
+	*len = 0;
+	for(; *itr != 'e'; ++itr)
+		if( *itr >= '0' && *itr <= '9' )
+			digits[(*len)++] = *itr;
+
+	*k = atoi(itr + 1) - precision;
+}
+
+
+// digits * 10^k in fixed notation for 1e-6 <= value < 1e21, else d.ddde+XX
+size_t place_point(char* const buffer, const int len, const int k)
+{
+	const int kk = len + k;
+
+	// 1234e2 -> 123400
+	if( k >= 0 && kk <= 21 ) {
+		for(int i = len; i < kk; ++i)
+			buffer[i] = '0';
+		return static_cast<size_t>(kk);
+	}
+
+	// 1234e-2 -> 12.34
+	if( kk > 0 && kk <= 21 ) {
+		memmove(&buffer[kk + 1], &buffer[kk], static_cast<size_t>(len - kk));
+		buffer[kk] = '.';
+		return static_cast<size_t>(len + 1);
+	}
+
+	// 1234e-6 -> 0.001234
+	if( kk > -6 && kk <= 0 ) {
+		const int offset = 2 - kk;
+		memmove(&buffer[offset], &buffer[0], static_cast<size_t>(len));
+		buffer[0] = '0';
+		buffer[1] = '.';
+		for(int i = 2; i < offset; ++i)
+			buffer[i] = '0';
+		return static_cast<size_t>(len + offset);
+	}
+
+	// 1234e30 -> 1.234e+33
+	size_t size = 1;
+	if( len > 1 ) {
+		memmove(&buffer[2], &buffer[1], static_cast<size_t>(len - 1));
+		buffer[1] = '.';
+		size = static_cast<size_t>(len + 1);
+	}
+
+	int exponent = kk - 1;
+	buffer[size++] = 'e';
+	buffer[size++] = exponent < 0 ? '-' : '+';
+	if( exponent < 0 )
+		exponent = -exponent;
+
+	if( exponent >= 100 ) {
+		buffer[size++] = static_cast<char>('0' + exponent / 100);
+		exponent %= 100;
+	}
+
+	buffer[size++] = digit_pairs[exponent * 2];
+	buffer[size++] = digit_pairs[exponent * 2 + 1];
+	return size;
+}
+
+
+template<class T>
+size_t shortest(char* const buffer, const T value)
+{
+	using Bits = FloatBits<T>;
+	typename Bits::Uint bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	const bool negative = (bits >> (sizeof(bits) * 8 - 1)) != 0;
+	const unsigned exponent = static_cast<unsigned>((bits >> Bits::mantissa) & Bits::maxExponent);
+	const bool nan = exponent == Bits::maxExponent && (bits & ((typename Bits::Uint(1) << Bits::mantissa) - 1));
+
+	char* out = buffer;
+	if( negative && !nan )
+		*out++ = '-';
+
+	if( exponent == Bits::maxExponent ) {
+		memcpy(out, nan ? "nan" : "inf", 3);
+		return static_cast<size_t>(out - buffer) + 3;
+	}
+
+	if( value == 0 ) {
+		*out = '0';
+		return static_cast<size_t>(out - buffer) + 1;
+	}
+
+	int len = 0;
+	int k = 0;
+	if( !grisu3(value, out, &len, &k) )
+		exact_shortest(value, out, &len, &k);
+	return static_cast<size_t>(out - buffer) + place_point(out, len, k);
+}
+
+
+
+
+struct Spec
+{
+	char fill = ' ';
+	char align = 0;
+	bool plus = false;
+	bool alt = false;
+	bool zero = false;
+	size_t width = 0;
+	int precision = -1;
+	char type = 0;
+};
+
+
+// the text between ':' and '}', false if it isn't a spec
+bool parse_spec(const char* itr, const char* const end, Spec& spec)
+{
+	auto is_align = [](const char c) { return c == '<' || c == '>' || c == '^'; };
+
+	if( end - itr >= 2 && is_align(itr[1]) ) {
+		spec.fill = itr[0];
+		spec.align = itr[1];
+		itr += 2;
+	}
+	else if( itr != end && is_align(*itr) ) {
+		spec.align = *itr++;
+	}
+
+	if( itr != end && *itr == '+' ) {
+		spec.plus = true;
+		++itr;
+	}
+
+	if( itr != end && *itr == '#' ) {
+		spec.alt = true;
+		++itr;
+	}
+
+	if( itr != end && *itr == '0' ) {
+		spec.zero = true;
+		++itr;
+	}
+
+	while( itr != end && *itr >= '0' && *itr <= '9' )
+		spec.width = spec.width * 10 + static_cast<size_t>(*itr++ - '0');
+
+	if( itr != end && *itr == '.' ) {
+		spec.precision = 0;
+		for(++itr; itr != end && *itr >= '0' && *itr <= '9'; ++itr)
+			spec.precision = spec.precision * 10 + (*itr - '0');
+	}
+
+	if( itr != end )
+		spec.type = *itr++;
+
+	return itr == end && spec.width < 4096 && spec.precision < 4096;
+}
+
+
+// snprintf semantics over the caller's buffer, counts what doesn't fit
+class Output
+{
+public:
+	Output(char* const buffer, const size_t size) 
+		: _buffer(buffer), _room(size > 0 ? size - 1 : 0), _hasRoom(size > 0)
+	{
+	}
+
+	void Put(const char c)
+	{
+		if( _size < _room )
+			_buffer[_size] = c;
+		++_size;
+	}
+
+	void Write(const char* const text, const size_t len)
+	{
+		if( _size < _room )
+			memcpy(_buffer + _size, text, len < _room - _size ? len : _room - _size);
+		_size += len;
+	}
+
+	void Fill(const char c, const size_t count)
+	{
+		if( _size < _room )
+			memset(_buffer + _size, c, count < _room - _size ? count : _room - _size);
+		_size += count;
+	}
+
+	// prefix (sign, 0x) then body, padded to the spec's width
+	void Padded(const Spec& spec, const char defaultAlign, const char* const prefix, const size_t prefixLen, 
+	            const char* const body, const size_t bodyLen)
+	{
+		const size_t len = prefixLen + bodyLen;
+		const size_t pad = spec.width > len ? spec.width - len : 0;
+		const char align = spec.align ? spec.align : defaultAlign;
+
+		if( pad == 0 ) {
+			this->Write(prefix, prefixLen);
+			this->Write(body, bodyLen);
+		}
+		else if( spec.zero && !spec.align && defaultAlign == '>' ) {
+			this->Write(prefix, prefixLen);
+			this->Fill('0', pad);
+			this->Write(body, bodyLen);
+		}
+		else {
+			const size_t before = align == '<' ? 0 : align == '^' ? pad / 2 : pad;
+			this->Fill(spec.fill, before);
+			this->Write(prefix, prefixLen);
+			this->Write(body, bodyLen);
+			this->Fill(spec.fill, pad - before);
+		}
+	}
+
+	size_t Finish()
+	{
+		if( _hasRoom )
+			_buffer[_size < _room ? _size : _room] = '\0';
+		return _size;
+	}
+
+private:
+	char* const _buffer;
+	const size_t _room;
+	const bool _hasRoom;
+	size_t _size = 0;
+};
+
+
+
+
+void format_integer(Output& out, const Spec& spec, const bool negative, const uint64_t magnitude)
+{
+	char digits[66];
+	char* const end = digits + sizeof(digits);
+	char* start;
+	char prefix[4];
+	size_t prefixLen = 0;
+
+	if( negative )
+		prefix[prefixLen++] = '-';
+	else if( spec.plus )
+		prefix[prefixLen++] = '+';
+
+	switch( spec.type )
+	{
+	case 'x':
+	case 'X':
+		start = write_radix(end, magnitude, 4, spec.type == 'x' ? lower_digits : upper_digits);
+		if( spec.alt ) {
+			prefix[prefixLen++] = '0';
+			prefix[prefixLen++] = spec.type;
+		}
+		break;
+	case 'o':
+		start = write_radix(end, magnitude, 3, lower_digits);
+		if( spec.alt && magnitude != 0 )
+			prefix[prefixLen++] = '0';
+		break;
+	case 'b':
+		start = write_radix(end, magnitude, 1, lower_digits);
+		if( spec.alt ) {
+			prefix[prefixLen++] = '0';
+			prefix[prefixLen++] = 'b';
+		}
+		break;
+	case 'c': {
+		const char c = static_cast<char>(magnitude);
+		out.Padded(spec, '<', "", 0, &c, 1);
+		return;
+	}
+	default:
+		start = write_decimal(end, magnitude);
+		break;
+	}
+
+	out.Padded(spec, '>', prefix, prefixLen, start, static_cast<size_t>(end - start));
+}
+
+
+template<class T>
+void format_float(Output& out, const Spec& spec, const T value)
+{
+	using Bits = FloatBits<T>;
+	typename Bits::Uint bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	// the sign goes in the prefix, so zero padding lands after it
+	const typename Bits::Uint signBit = typename Bits::Uint(1) << (sizeof(bits) * 8 - 1);
+	const bool nan = ((bits >> Bits::mantissa) & Bits::maxExponent) == Bits::maxExponent 
+	                 && (bits & ((typename Bits::Uint(1) << Bits::mantissa) - 1));
+	const bool negative = (bits & signBit) && !nan;
+	bits &= ~signBit;
+	T magnitude;
+	memcpy(&magnitude, &bits, sizeof(bits));
+
+	char prefix = negative ? '-' : '+';
+	const size_t prefixLen = negative || (spec.plus && !nan) ? 1 : 0;
+
+	if( !spec.type && spec.precision < 0 ) {
+		char body[FloatCharsMax];
+		const size_t len = shortest(body, magnitude);
+		out.Padded(spec, '>', &prefix, prefixLen, body, len);
+		return;
+	}
+
+	// fixed precision needs exact decimal rounding, snprintf has it
+	char printfSpec[8] = { '%' };
+	size_t specLen = 1;
+	if( spec.alt )
+		printfSpec[specLen++] = '#';
+	printfSpec[specLen++] = '.';
+	printfSpec[specLen++] = '*';
+	printfSpec[specLen++] = spec.type ? spec.type : 'g';
+
+	char body[64];
+	const int precision = spec.precision < 0 ? 6 : spec.precision;
+	const int len = snprintf(body, sizeof(body), printfSpec, precision, static_cast<double>(magnitude));
+	if( len < 0 )
+		return;
+
+	if( static_cast<size_t>(len) < sizeof(body) ) {
+		out.Padded(spec, '>', &prefix, prefixLen, body, static_cast<size_t>(len));
+		return;
+	}
+
+	// big %f values or long precisions
+	char* const longBody = alloc_arr<char>(static_cast<size_t>(len) + 1);
+	if( !longBody )
+		return;
+
+	snprintf(longBody, static_cast<size_t>(len) + 1, printfSpec, precision, static_cast<double>(magnitude));
+	out.Padded(spec, '>', &prefix, prefixLen, longBody, static_cast<size_t>(len));
+	free_arr(longBody);
+}
+
+
+void format_arg(Output& out, const Spec& spec, const FormatArg& arg)
+{
+	switch( arg.GetType() )
+	{
+	case FormatArg::Type::Bool:
+		if( !spec.type || spec.type == 's' ) {
+			const bool value = arg.GetBool();
+			out.Padded(spec, '<', "", 0, value ? "true" : "false", value ? 4 : 5);
+			return;
+		}
+		format_integer(out, spec, false, arg.GetUint());
+		return;
+
+	case FormatArg::Type::Char:
+		if( !spec.type || spec.type == 'c' ) {
+			const char c = static_cast<char>(arg.GetInt());
+			out.Padded(spec, '<', "", 0, &c, 1);
+			return;
+		}
+		/* fall through */
+	case FormatArg::Type::Int: {
+		const int64_t value = arg.GetInt();
+		const uint64_t magnitude = value < 0 ? uint64_t(0) - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+		format_integer(out, spec, value < 0, magnitude);
+		return;
+	}
+
+	case FormatArg::Type::Uint:
+		format_integer(out, spec, false, arg.GetUint());
+		return;
+
+	case FormatArg::Type::Float:
+		format_float(out, spec, arg.GetFloat());
+		return;
+
+	case FormatArg::Type::Double:
+		format_float(out, spec, arg.GetDouble());
+		return;
+
+	case FormatArg::Type::String: {
+		size_t len = arg.GetStringSize();
+		if( spec.precision >= 0 && static_cast<size_t>(spec.precision) < len )
+			len = static_cast<size_t>(spec.precision);
+		out.Padded(spec, '<', "", 0, arg.GetString(), len);
+		return;
+	}
+
+	case FormatArg::Type::Pointer: {
+		char digits[16];
+		char* const end = digits + sizeof(digits);
+		char* const start = write_radix(end, reinterpret_cast<uintptr_t>(arg.GetPointer()), 4, lower_digits);
+		out.Padded(spec, '>', "0x", 2, start, static_cast<size_t>(end - start));
+		return;
+	}
+	}
+}
+
+
+}
+
+
+
+
+size_t format_args(char* const buffer, const size_t size, const FormatString fmt, 
+                   const FormatArg* const args, const size_t count) noexcept
+{
+	Output out(buffer, size);
+	const char* itr = fmt.str;
+	const char* const end = fmt.str + fmt.size;
+	size_t next = 0;
+
+	while( itr != end ) 
+	{
+		const char* brace = itr;
+		while( brace != end && *brace != '{' && *brace != '}' )
+			++brace;
+
+		out.Write(itr, static_cast<size_t>(brace - itr));
+		if( brace == end )
+			break;
+
+		// '{{', '}}', or a lone '}'
+		if( *brace == '}' || (brace + 1 != end && brace[1] == '{') ) {
+			out.Put(*brace);
+			itr = brace + (brace + 1 != end && brace[1] == *brace ? 2 : 1);
+			continue;
+		}
+
+		const char* close = brace + 1;
+		while( close != end && *close != '}' )
+			++close;
+
+		if( close == end ) {
+			out.Write(brace, static_cast<size_t>(end - brace));
+			break;
+		}
+
+		Spec spec;
+		const bool valid = close == brace + 1 || (brace[1] == ':' && parse_spec(brace + 2, close, spec));
+		if( valid && next < count )
+			format_arg(out, spec, args[next++]);
+		else
+			out.Write(brace, static_cast<size_t>(close + 1 - brace));
+
+		itr = close + 1;
+	}
+
+	return out.Finish();
+}
+
+
+size_t format_shortest(char* const buffer, const double value) noexcept
+{
+	return shortest(buffer, value);
+}
+
+
+size_t format_shortest(char* const buffer, const float value) noexcept
+{
+	return shortest(buffer, value);
+}
+
+
+}
@@ -0,0 +1,213 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <limits.h>
+#include <time.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <Utix/Futex.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__APPLE__)
+// darwin's futex, what libc++ waits on atomics with. not in the SDK headers
+extern "C" int __ulock_wait(uint32_t operation, void* addr, uint64_t value, uint32_t timeoutUs);
+extern "C" int __ulock_wake(uint32_t operation, void* addr, uint64_t wakeValue);
+#define UL_COMPARE_AND_WAIT 1
+#define ULF_WAKE_ALL 0x00000100
+#define ULF_NO_ERRNO 0x01000000
+#endif
+
+
+namespace utix {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32 bit word");
+
+
+#if defined(__linux__)
+
+
+static void futex_call(std::atomic<uint32_t>* const word, const int op, const uint32_t value, 
+                       const timespec* const timeout = nullptr)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op | FUTEX_PRIVATE_FLAG, value, timeout, nullptr, 0);
+}
+
+
+void futex_wait(std::atomic<uint32_t>* const word, const uint32_t expected)
+{
+	futex_call(word, FUTEX_WAIT, expected);
+}
+
+
+void futex_wait_for(std::atomic<uint32_t>* const word, const uint32_t expected, const uint32_t timeoutUs)
+{
+	const timespec timeout { static_cast<time_t>(timeoutUs / 1000000), static_cast<long>(timeoutUs % 1000000) * 1000 };
+	futex_call(word, FUTEX_WAIT, expected, &timeout);
+}
+
+
+void futex_wake(std::atomic<uint32_t>* const word, const int count)
+{
+	futex_call(word, FUTEX_WAKE, static_cast<uint32_t>(count));
+}
+
+
+void futex_wake_all(std::atomic<uint32_t>* const word)
+{
+	futex_call(word, FUTEX_WAKE, INT_MAX);
+}
+
+
+
+
+#elif defined(_WIN32)
+
+
+void futex_wait(std::atomic<uint32_t>* const word, const uint32_t expected)
+{
+	uint32_t compare = expected;
+	WaitOnAddress(word, &compare, sizeof(compare), INFINITE);
+}
+
+
+void futex_wait_for(std::atomic<uint32_t>* const word, const uint32_t expected, const uint32_t timeoutUs)
+{
+	uint32_t compare = expected;
+	WaitOnAddress(word, &compare, sizeof(compare), (timeoutUs + 999) / 1000);
+}
+
+
+void futex_wake(std::atomic<uint32_t>* const word, const int count)
+{
+	for(int i = 0; i < count; ++i)
+		WakeByAddressSingle(word);
+}
+
+
+void futex_wake_all(std::atomic<uint32_t>* const word)
+{
+	WakeByAddressAll(word);
+}
+
+
+
+
+#elif defined(__APPLE__)
+
+
+void futex_wait(std::atomic<uint32_t>* const word, const uint32_t expected)
+{
+	// a 0 timeout waits for good
+	__ulock_wait(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, word, expected, 0);
+}
+
+
+void futex_wait_for(std::atomic<uint32_t>* const word, const uint32_t expected, const uint32_t timeoutUs)
+{
+	__ulock_wait(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, word, expected, timeoutUs > 0 ? timeoutUs : 1);
+}
+
+
+void futex_wake(std::atomic<uint32_t>* const word, const int count)
+{
+	for(int i = 0; i < count; ++i)
+		__ulock_wake(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, word, 0);
+}
+
+
+void futex_wake_all(std::atomic<uint32_t>* const word)
+{
+	__ulock_wake(UL_COMPARE_AND_WAIT | ULF_WAKE_ALL | ULF_NO_ERRNO, word, 0);
+}
+
+
+
+
+#else
+
+
+// waiters sleep on a condition variable picked by the word's address.
+// the word is checked under the mutex and wakers take it before notifying,
+// so a store followed by a wake can't slip in between a check and the sleep.
+// words sharing a bucket wake each other, which callers already put up with
+struct FutexBucket
+{
+	std::mutex mutex;
+	std::condition_variable cond;
+};
+
+constexpr size_t futex_bucket_count = 64;
+
+
+static FutexBucket& futex_bucket(const std::atomic<uint32_t>* const word)
+{
+	// never destroyed, static destructors can still wait and wake
+	static FutexBucket* const buckets = new FutexBucket[futex_bucket_count];
+	const size_t addr = reinterpret_cast<size_t>(word);
+	return buckets[((addr >> 2) ^ (addr >> 8)) % futex_bucket_count];
+}
+
+
+void futex_wait(std::atomic<uint32_t>* const word, const uint32_t expected)
+{
+	FutexBucket& bucket = futex_bucket(word);
+	std::unique_lock<std::mutex> lock(bucket.mutex);
+	if( word->load(std::memory_order_acquire) == expected )
+		bucket.cond.wait(lock);
+}
+
+
+void futex_wait_for(std::atomic<uint32_t>* const word, const uint32_t expected, const uint32_t timeoutUs)
+{
+	FutexBucket& bucket = futex_bucket(word);
+	std::unique_lock<std::mutex> lock(bucket.mutex);
+	if( word->load(std::memory_order_acquire) == expected )
+		bucket.cond.wait_for(lock, std::chrono::microseconds(timeoutUs));
+}
+
+
+// the bucket may hold waiters on other words, each wake reaches all of them
+void futex_wake(std::atomic<uint32_t>* const word, const int)
+{
+	futex_wake_all(word);
+}
+
+
+void futex_wake_all(std::atomic<uint32_t>* const word)
+{
+	FutexBucket& bucket = futex_bucket(word);
+	{
+		std::lock_guard<std::mutex> lock(bucket.mutex);
+	}
+	bucket.cond.notify_all();
+}
+
+
+#endif
+
+
+}
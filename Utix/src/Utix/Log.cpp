@@ -1,6 +1,6 @@
 /*
 
-utix - utility library from XChip
+UTIX - utility library from XChip
 Copyright (C) 2016  Rafael Moura
 
 This program is free software: you can redistribute it and/or modify
@@ -18,17 +18,33 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 
 */
 
-
 #include <errno.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <new>
+#include <thread>
 
 #ifdef __ANDROID__
 #include <android/log.h>
+#elif defined(_WIN32)
+#include <io.h>
+#else
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #endif
 
 #include <Utix/Log.h>
+#include <Utix/Alloc.h>
+#include <Utix/BinaryLog.h>
+#include <Utix/Futex.h>
+#include <Utix/HashSet.h>
+#include <Utix/SpscRing.h>
+#include <Utix/Vector.h>
 
 
 
@@ -39,13 +55,40 @@ along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
 namespace utix {
 
 
-static std::string errstr(512, '\0');
+LogCategory default_log_category("default");
+static bool async_log(const int stream, const char* text, size_t len) noexcept;
+static bool async_vlog(const int stream, const char* fmtString, va_list args) noexcept;
+static void write_line(const int stream, char* text, const size_t len) noexcept;
+
+// each thread's last LogError message, no allocation and nothing shared
+static thread_local char last_error[LogRecordMax];
+
+
+// strerror isn't thread safe, strerror_r is the XSI or the GNU one depending on the libc
+static inline const char* strerror_result(const int, const char* const buffer) { return buffer; }
+static inline const char* strerror_result(const char* const message, const char*) { return message; }
+
+static const char* errno_string(const int errnoCode, char* const buffer, const size_t size) noexcept
+{
+	buffer[0] = '\0';
+#ifdef _WIN32
+	strerror_s(buffer, size, errnoCode);
+	return buffer;
+#else
+	return strerror_result(strerror_r(errnoCode, buffer, size), buffer);
+#endif
+}
 
 
 void Log(const char* fmtString, ...) noexcept
 {
 	va_list args;
 	va_start(args, fmtString);
+
+	if( async_vlog(1, fmtString, args) ) {
+		va_end(args);
+		return;
+	}
 	
 	#ifdef __ANDROID__
 	__android_log_vprint(ANDROID_LOG_INFO, "LOG_INFO", fmtString, args);
@@ -58,46 +101,979 @@ void Log(const char* fmtString, ...) noexcept
 }
 
 
+// appends errno's text to the len chars in last_error and writes the line
+static void finish_error(const int errnoCode, size_t len) noexcept
+{
+	char* const errstr = last_error;
+	const size_t errstrSize = sizeof(last_error) - 1;
+
+	if(errnoCode) { 
+		char errnoText[128];
+		const int errnoSize = snprintf(errstr + len, errstrSize - len, ": %s", 
+		                               errno_string(errnoCode, errnoText, sizeof(errnoText)));
+		if( errnoSize > 0 )
+			len += static_cast<size_t>(errnoSize) < errstrSize - len ? errnoSize : errstrSize - len - 1;
+		errno = 0;
+	}
+
+	if( async_log(2, errstr, len) )
+		return;
+
+	// the whole line goes in one write, concurrent errors don't interleave
+	errstr[len] = '\n';
+	write_line(2, errstr, len + 1);
+	errstr[len] = '\0';
+}
+
+
 void LogError(const char* fmtString, ...) noexcept
 {
 	const auto errnoCode = errno;
 	va_list args;
 	va_start(args, fmtString);
 
-	// write the message to buffer and get writeSize
-	const auto errstrSize = errstr.size();
-	const auto writeSize = vsnprintf(&errstr[0], errstrSize, fmtString, args);
+	// write the message to buffer and get writeSize.
+	// the last byte is kept for the newline
+	const size_t errstrSize = sizeof(last_error) - 1;
+	const auto writeSize = vsnprintf(last_error, errstrSize, fmtString, args);
 	
 	va_end(args);
 
 	if(writeSize > 0)
+		finish_error(errnoCode, static_cast<size_t>(writeSize) < errstrSize ? writeSize : errstrSize - 1);
+	else
+		perror("Error in LogError vsprintf!!:");
+
+}
+
+
+// a warning is a line on stderr and nothing else, last_error and errno stay as they are
+static void finish_warning(char* const line, const size_t len, const int errnoCode) noexcept
+{
+	if( !async_log(2, line, len) ) {
+		line[len] = '\n';
+		write_line(2, line, len + 1);
+	}
+
+	errno = errnoCode;
+}
+
+
+void LogWarning(const char* fmtString, ...) noexcept
+{
+	const auto errnoCode = errno;
+	va_list args;
+	va_start(args, fmtString);
+
+	// the last byte is kept for the newline
+	char line[LogRecordMax];
+	const auto writeSize = vsnprintf(line, sizeof(line) - 1, fmtString, args);
+
+	va_end(args);
+
+	if(writeSize >= 0)
+		finish_warning(line, static_cast<size_t>(writeSize) < sizeof(line) - 1 ? writeSize : sizeof(line) - 2, errnoCode);
+}
+
+
+void log_args(const FormatString fmt, const FormatArg* const args, const size_t count) noexcept
+{
+	// the last byte is kept for the newline
+	char line[LogRecordMax];
+	size_t len = format_args(line, sizeof(line) - 1, fmt, args, count);
+	if( len >= sizeof(line) - 1 )
+		len = sizeof(line) - 2;
+
+	if( async_log(1, line, len) )
+		return;
+
+	#ifdef __ANDROID__
+	__android_log_write(ANDROID_LOG_INFO, "LOG_INFO", line);
+	#else
+	line[len] = '\n';
+	if( fwrite(line, 1, len + 1, stdout) != len + 1 )
+		LogError("Failed to print Log");
+	#endif
+}
+
+
+void log_error_args(const FormatString fmt, const FormatArg* const args, const size_t count) noexcept
+{
+	const auto errnoCode = errno;
+	const size_t errstrSize = sizeof(last_error) - 1;
+	const size_t len = format_args(last_error, errstrSize, fmt, args, count);
+	finish_error(errnoCode, len < errstrSize ? len : errstrSize - 1);
+}
+
+
+void log_warning_args(const FormatString fmt, const FormatArg* const args, const size_t count) noexcept
+{
+	const auto errnoCode = errno;
+	char line[LogRecordMax];
+	const size_t len = format_args(line, sizeof(line) - 1, fmt, args, count);
+	finish_warning(line, len < sizeof(line) - 1 ? len : sizeof(line) - 2, errnoCode);
+}
+
+
+const char* GetLastLogError() noexcept
+{
+	return last_error;
+}
+
+
+const std::string& GetLastLogErrorString()
+{
+	static thread_local std::string copy;
+	copy.assign(last_error);
+	return copy;
+}
+
+
+
+
+// async logging
+//
+// each thread that logs gets a LogBuffer, its SpscRing holds records of
+// [stream, uint16 length, text + newline], pushed whole with push_all.
+// the writer pops each ring into a staging area and writes every record
+// as one iovec, a writev per stream per pass.
+// wakeups go through futex words, in the same register / fence / recheck
+// order as MpmcQueue, so a producer only pays a fence when the writer sleeps.
+//
+// in binary mode the records are already BinaryLog.h entries, Log skips the
+// printf and the writer only adds the format definitions and appends to the file.
+
+namespace {
+
+constexpr size_t record_header = 3;
+constexpr size_t staging_min = 256 * 1024;
+constexpr uint32_t writer_nap_us = 1000;
+
+struct LogBuffer
+{
+	SpscRing<char> ring;
+	LogBuffer* next = nullptr;
+	std::atomic<bool> busy{false};     // the owner is pushing, StopAsyncLog waits it out
+	std::atomic<bool> orphaned{false}; // the owner exited, free once drained
+};
+
+
+// marks the buffer orphaned when its thread exits
+struct ThreadLogBuffer
+{
+	~ThreadLogBuffer() 
+	{ 
+		if( buffer ) 
+			buffer->orphaned.store(true, std::memory_order_release); 
+		buffer = nullptr;
+	}
+
+	LogBuffer* buffer = nullptr;
+	bool inLog = false;  // logging from inside the async path goes synchronous
+};
+
+
+thread_local ThreadLogBuffer thread_log;
+
+std::mutex buffers_mutex;
+LogBuffer* buffers = nullptr;
+
+std::thread writer;
+std::atomic<bool> async_running{false};
+std::atomic<bool> writer_stop{false};
+std::atomic<bool> writer_sleeping{false};
+std::atomic<bool> writer_napping{false};
+std::atomic<uint32_t> writer_epoch{0};
+std::atomic<uint32_t> space_epoch{0};
+std::atomic<uint32_t> blocked_producers{0};
+std::atomic<uint32_t> flush_request{0};
+std::atomic<uint32_t> flush_done{0};
+std::atomic<uint64_t> dropped{0};
+size_t buffer_size = 0;
+LogOverflow overflow_policy = LogOverflow::CountDrop;
+std::atomic<bool> binary_mode{false};
+FILE* binary_file = nullptr;
+
+
+// a writer still running at exit would make std::thread's destructor terminate
+struct AsyncLogShutdown
+{
+	~AsyncLogShutdown() { StopAsyncLog(); }
+} async_log_shutdown;
+
+
+void wake_writer()
+{
+	writer_epoch.fetch_add(1, std::memory_order_release);
+	futex_wake(&writer_epoch, 1);
+}
+
+
+LogBuffer* acquire_buffer()
+{
+	if( thread_log.buffer )
+		return thread_log.buffer;
+
+	LogBuffer* const buffer = alloc_arr<LogBuffer>(1);
+	if( !buffer )
+		return nullptr;
+
+	new(buffer) LogBuffer();
+
+	if( !buffer->ring.initialize(buffer_size) ) {
+		buffer->~LogBuffer();
+		free_arr(buffer);
+		return nullptr;
+	}
+
 	{
-		if(errnoCode) { 
-			snprintf(&errstr[writeSize], errstrSize - writeSize, ": %s", strerror(errnoCode));
-			errno = 0;
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		buffer->next = buffers;
+		buffers = buffer;
+	}
+
+	thread_log.buffer = buffer;
+	return buffer;
+}
+
+
+// false when async is off, the caller then logs synchronously
+bool push_record(const char* const record, const size_t size)
+{
+	ThreadLogBuffer& self = thread_log;
+	if( self.inLog || !async_running.load(std::memory_order_acquire) )
+		return false;
+
+	self.inLog = true;
+	LogBuffer* const buffer = acquire_buffer();
+	if( !buffer ) {
+		self.inLog = false;
+		return false;
+	}
+
+	// busy before the recheck, so StopAsyncLog either sees it or we see the stop
+	buffer->busy.store(true, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// a record built for the other mode, by a call that raced a restart, goes synchronous
+	const bool binaryRecord = record[0] == BinaryLogRecord || record[0] == BinaryLogText;
+	if( !async_running.load(std::memory_order_acquire) 
+	    || binaryRecord != binary_mode.load(std::memory_order_relaxed) ) {
+		buffer->busy.store(false, std::memory_order_release);
+		self.inLog = false;
+		return false;
+	}
+
+	while( !buffer->ring.push_all(record, size) )
+	{
+		if( overflow_policy != LogOverflow::Block ) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			break;
 		}
-		else { 
-			errstr[writeSize] = '\0';
+
+		const uint32_t epoch = space_epoch.load(std::memory_order_acquire);
+		blocked_producers.fetch_add(1, std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		wake_writer();
+
+		if( !buffer->ring.push_all(record, size) ) {
+			futex_wait(&space_epoch, epoch);
+			blocked_producers.fetch_sub(1, std::memory_order_relaxed);
+			continue;
 		}
-		
-		// print to stderr
-		#ifdef __ANDROID__
-		__android_log_print(ANDROID_LOG_ERROR, "LOG_ERROR", "%s", errstr.c_str());
-		#else
-		fprintf(stderr, "%s\n", errstr.c_str());
-		#endif
+
+		blocked_producers.fetch_sub(1, std::memory_order_relaxed);
+		break;
 	}
-	else
+
+	buffer->busy.store(false, std::memory_order_release);
+
+	// a napping writer comes back on its own, it's only hurried when the ring is half full
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if( writer_sleeping.load(std::memory_order_relaxed) 
+	    || (writer_napping.load(std::memory_order_relaxed) && buffer->ring.size() > buffer->ring.capacity() / 2) )
+		wake_writer();
+
+	self.inLog = false;
+	return true;
+}
+
+
+void make_header(char* const record, const int stream, const size_t len)
+{
+	const uint16_t size = static_cast<uint16_t>(len);
+	record[0] = static_cast<char>(stream);
+	memcpy(record + 1, &size, sizeof(size));
+}
+
+
+uint64_t now_ns()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+template<class T>
+void put(char*& out, const T value)
+{
+	memcpy(out, &value, sizeof(value));
+	out += sizeof(value);
+}
+
+
+// a text record is [stream, len, text + newline], a binary one
+// [BinaryLogText, len, stream, time, text]. the text starts at text_offset
+constexpr size_t binary_text_header = 1 + sizeof(uint64_t);
+
+size_t text_offset(const bool binary)
+{
+	return record_header + (binary ? binary_text_header : 0);
+}
+
+size_t text_room(const bool binary)
+{
+	return binary ? LogRecordMax - binary_text_header : LogRecordMax - 1;
+}
+
+// returns the record size
+size_t finish_text_record(char* const record, const bool binary, const int stream, const size_t len)
+{
+	if( !binary ) {
+		record[record_header + len] = '\n';
+		make_header(record, stream, len + 1);
+		return record_header + len + 1;
+	}
+
+	char* out = record + record_header;
+	put(out, static_cast<uint8_t>(stream));
+	put(out, now_ns());
+	make_header(record, BinaryLogText, binary_text_header + len);
+	return record_header + binary_text_header + len;
+}
+
+
+bool any_pending()
+{
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	for(LogBuffer* buffer = buffers; buffer; buffer = buffer->next)
+		if( !buffer->ring.empty() )
+			return true;
+	return false;
+}
+
+
+
+
+#if defined(__ANDROID__)
+
+struct LogIovec
+{
+	void* iov_base;
+	size_t iov_len;
+};
+
+// the text ends in a newline, which the android log adds on its own
+void write_stream(const int stream, LogIovec* const iov, const size_t count)
+{
+	for(size_t i = 0; i < count; ++i) {
+		char* const text = static_cast<char*>(iov[i].iov_base);
+		text[iov[i].iov_len - 1] = '\0';
+		__android_log_write(stream == 2 ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO, 
+		                    stream == 2 ? "LOG_ERROR" : "LOG_INFO", text);
+	}
+}
+
+#elif defined(_WIN32)
+
+struct LogIovec
+{
+	void* iov_base;
+	size_t iov_len;
+};
+
+void write_stream(const int stream, LogIovec* const iov, const size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+		_write(stream, iov[i].iov_base, static_cast<unsigned>(iov[i].iov_len));
+}
+
+#else
+
+using LogIovec = iovec;
+
+// writev takes at most IOV_MAX pieces and may write part of them
+void write_stream(const int stream, LogIovec* iov, size_t count)
+{
+#ifdef IOV_MAX
+	constexpr size_t iov_max = IOV_MAX;
+#else
+	constexpr size_t iov_max = 1024;
+#endif
+
+	while( count > 0 ) 
 	{
-		perror("Error in LogError vsprintf!!:");
+		const int batch = static_cast<int>(count < iov_max ? count : iov_max);
+		ssize_t written = writev(stream, iov, batch);
+
+		if( written < 0 ) {
+			if( errno == EINTR )
+				continue;
+			return;
+		}
+
+		while( count > 0 && static_cast<size_t>(written) >= iov->iov_len ) {
+			written -= iov->iov_len;
+			++iov;
+			--count;
+		}
+
+		if( count > 0 ) {
+			iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+			iov->iov_len -= written;
+		}
+	}
+}
+
+#endif
+
+
+
+
+class LogWriter
+{
+public:
+	bool Initialize(const size_t bufferSize)
+	{
+		// room for a full ring of this session, rings round their capacity up like this
+		_stagingSize = staging_min;
+		while( _stagingSize < bufferSize )
+			_stagingSize *= 2;
+		_staging = alloc_arr<char>(_stagingSize);
+		return _staging && _snapshot.initialize() && _out.initialize() && _err.initialize()
+		       && _binary.initialize();
+	}
+
+	~LogWriter() 
+	{ 
+		free_arr(_staging); 
 	}
 
+	void Run()
+	{
+		thread_log.inLog = true;
+		uint64_t reportedDrops = dropped.load(std::memory_order_relaxed);
+
+		for(;;)
+		{
+			const uint32_t epoch = writer_epoch.load(std::memory_order_acquire);
+			const uint32_t flush = flush_request.load(std::memory_order_acquire);
+			const bool stopping = writer_stop.load(std::memory_order_acquire);
+
+			const bool wrote = this->Drain();
+
+			const uint64_t drops = dropped.load(std::memory_order_relaxed);
+			if( drops != reportedDrops && overflow_policy == LogOverflow::CountDrop )
+				this->ReportDrops(drops - reportedDrops);
+			reportedDrops = drops;
+
+			if( flush_done.load(std::memory_order_relaxed) != flush ) {
+				flush_done.store(flush, std::memory_order_release);
+				futex_wake_all(&flush_done);
+			}
+
+			if( wrote ) {
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if( blocked_producers.load(std::memory_order_relaxed) ) {
+					space_epoch.fetch_add(1, std::memory_order_release);
+					futex_wake_all(&space_epoch);
+				}
+
+				// more is likely on the way, let it pile up instead of being woken for each line
+				if( !stopping && flush_request.load(std::memory_order_relaxed) == flush ) {
+					writer_napping.store(true, std::memory_order_relaxed);
+					futex_wait_for(&writer_epoch, epoch, writer_nap_us);
+					writer_napping.store(false, std::memory_order_relaxed);
+				}
+				continue;
+			}
+
+			if( stopping )
+				break;
+
+			writer_sleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if( !any_pending() && flush_request.load(std::memory_order_relaxed) == flush 
+			    && !writer_stop.load(std::memory_order_relaxed) )
+				futex_wait(&writer_epoch, epoch);
+
+			writer_sleeping.store(false, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	// one pass over every ring, true if anything was written
+	bool Drain()
+	{
+		_snapshot.clear();
+		{
+			std::lock_guard<std::mutex> lock(buffers_mutex);
+
+			// buffers of exited threads go once they're empty
+			LogBuffer** link = &buffers;
+			while( LogBuffer* const buffer = *link ) 
+			{
+				if( buffer->orphaned.load(std::memory_order_acquire) && buffer->ring.empty() ) {
+					*link = buffer->next;
+					buffer->~LogBuffer();
+					free_arr(buffer);
+					continue;
+				}
+
+				_snapshot.push_back(buffer);
+				link = &buffer->next;
+			}
+		}
+
+		bool wrote = false;
+		size_t used = 0;
+
+		for(LogBuffer* const buffer : _snapshot)
+		{
+			// whatever size() sees ends on a record boundary.
+			// a ring kept from an earlier StartAsyncLog can be bigger than the staging area,
+			// it then goes over in whole records, a staging area at a time
+			for(size_t size = buffer->ring.size(); size > 0; )
+			{
+				if( size > _stagingSize - used ) {
+					this->Write();
+					used = 0;
+				}
+
+				char* const data = _staging + used;
+				const size_t taken = size <= _stagingSize ? buffer->ring.pop_n(data, size) 
+				                                          : this->PopRecords(buffer->ring, data);
+				used += taken;
+				size -= taken;
+				wrote = true;
+
+				if( binary_file ) {
+					this->Encode(data, taken);
+					continue;
+				}
+
+				for(size_t pos = 0; pos < taken; ) 
+				{
+					uint16_t len;
+					memcpy(&len, data + pos + 1, sizeof(len));
+					LogIovec iov { data + pos + record_header, len };
+					(data[pos] == 2 ? _err : _out).push_back(iov);
+					pos += record_header + len;
+				}
+			}
+		}
+
+		this->Write();
+		return wrote;
+	}
+
+	// fills the empty staging area with whole records while the longest one still fits
+	size_t PopRecords(SpscRing<char>& ring, char* const data)
+	{
+		size_t taken = 0;
+		while( _stagingSize - taken >= record_header + LogRecordMax )
+		{
+			uint16_t len;
+			ring.pop_n(data + taken, record_header);
+			memcpy(&len, data + taken + 1, sizeof(len));
+			ring.pop_n(data + taken + record_header, len);
+			taken += record_header + len;
+		}
+		return taken;
+	}
+
+	// binary records are file entries already, a format's text goes before its first record
+	void Encode(const char* const data, const size_t size)
+	{
+		for(size_t pos = 0; pos < size; ) 
+		{
+			uint16_t len;
+			memcpy(&len, data + pos + 1, sizeof(len));
+			const char* const entry = data + pos;
+			pos += record_header + len;
+
+			if( entry[0] != BinaryLogRecord )
+				continue;
+
+			uint64_t id;
+			memcpy(&id, entry + record_header + 1, sizeof(id));
+			if( _formats.contains(id) )
+				continue;
+
+			const char* const fmtString = reinterpret_cast<const char*>(static_cast<uintptr_t>(id));
+			const size_t fmtMax = 0xffff - sizeof(id);
+			const size_t fmtLen = strlen(fmtString);
+			this->AppendEntry(BinaryLogFormat, &id, sizeof(id), fmtString, fmtLen < fmtMax ? fmtLen : fmtMax);
+
+			// if the insert fails the definition is just written again
+			_formats.insert(id);
+		}
+
+		// copying into _binary keeps the definitions in front of their records
+		_binary.append(data, data + size);
+	}
+
+	void AppendEntry(const BinaryLogKind kind, const void* head, const size_t headSize, 
+	                 const void* tail, const size_t tailSize)
+	{
+		char header[record_header];
+		make_header(header, kind, headSize + tailSize);
+		_binary.append(header, header + record_header);
+		_binary.append(static_cast<const char*>(head), static_cast<const char*>(head) + headSize);
+		if( tailSize > 0 )
+			_binary.append(static_cast<const char*>(tail), static_cast<const char*>(tail) + tailSize);
+	}
+
+	void ReportDrops(const uint64_t count)
+	{
+		if( binary_file ) {
+			this->AppendEntry(BinaryLogDropped, &count, sizeof(count), nullptr, 0);
+			this->Write();
+			return;
+		}
+
+		char line[64];
+		const int len = snprintf(line, sizeof(line), "utix: %llu log lines dropped\n",
+		                         static_cast<unsigned long long>(count));
+		LogIovec iov { line, static_cast<size_t>(len) };
+		write_stream(2, &iov, 1);
+	}
+
+	void Write()
+	{
+		if( !_binary.empty() ) {
+			fwrite(_binary.data(), 1, _binary.size(), binary_file);
+			_binary.clear();
+		}
+
+		if( !_out.empty() )
+			write_stream(1, _out.data(), _out.size());
+		if( !_err.empty() )
+			write_stream(2, _err.data(), _err.size());
+		_out.clear();
+		_err.clear();
+	}
+
+	char* _staging = nullptr;
+	size_t _stagingSize = 0;
+	Vector<LogBuffer*> _snapshot;
+	Vector<LogIovec> _out;
+	Vector<LogIovec> _err;
+	Vector<char> _binary;
+	HashSet<uint64_t> _formats;
+};
+
+
+}
+
+
+
+
+static void write_line(const int stream, char* const text, const size_t len) noexcept
+{
+	LogIovec iov { text, len };
+	write_stream(stream, &iov, 1);
+}
+
+
+static bool async_log(const int stream, const char* const text, size_t len) noexcept
+{
+	if( !async_running.load(std::memory_order_acquire) )
+		return false;
+
+	const bool binary = binary_mode.load(std::memory_order_relaxed);
+	if( len > text_room(binary) )
+		len = text_room(binary);
+
+	char record[record_header + LogRecordMax + 1];
+	memcpy(record + text_offset(binary), text, len);
+	return push_record(record, finish_text_record(record, binary, stream, len));
+}
+
+
+// stores the format pointer and the raw arguments. false if the format has a
+// conversion that can't be deferred, or the arguments don't fit a record
+static bool binary_vlog(const int stream, const char* const fmtString, va_list args) noexcept
+{
+	char record[record_header + LogRecordMax];
+	char* out = record + record_header;
+	char* const end = out + LogRecordMax;
+
+	put(out, static_cast<uint8_t>(stream));
+	put(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(fmtString)));
+	put(out, now_ns());
+
+	for(const char* itr = strchr(fmtString, '%'); itr; itr = strchr(itr, '%'))
+	{
+		const LogSpec spec = parse_log_spec(itr);
+		itr += spec.size;
+
+		if( spec.arg == LogArg::None )
+			continue;
+
+		// room for the stars and the widest fixed size argument
+		if( spec.arg == LogArg::Unsupported || end - out < 2 * 4 + 16 )
+			return false;
+
+		int32_t star = 0;
+		for(int i = 0; i < spec.stars; ++i) {
+			star = static_cast<int32_t>(va_arg(args, int));
+			put(out, star);
+		}
+
+		switch( spec.arg )
+		{
+		case LogArg::Int:
+			switch( spec.length ) {
+			case LogLength::Long: put(out, static_cast<int64_t>(va_arg(args, long))); break;
+			case LogLength::LongLong: put(out, static_cast<int64_t>(va_arg(args, long long))); break;
+			case LogLength::IntMax: put(out, static_cast<int64_t>(va_arg(args, intmax_t))); break;
+			case LogLength::Size:
+			case LogLength::PtrDiff: put(out, static_cast<int64_t>(va_arg(args, ptrdiff_t))); break;
+			default: put(out, static_cast<int64_t>(va_arg(args, int))); break;
+			}
+			break;
+		case LogArg::Unsigned:
+			switch( spec.length ) {
+			case LogLength::Long: put(out, static_cast<uint64_t>(va_arg(args, unsigned long))); break;
+			case LogLength::LongLong: put(out, static_cast<uint64_t>(va_arg(args, unsigned long long))); break;
+			case LogLength::IntMax: put(out, static_cast<uint64_t>(va_arg(args, uintmax_t))); break;
+			case LogLength::Size:
+			case LogLength::PtrDiff: put(out, static_cast<uint64_t>(va_arg(args, size_t))); break;
+			default: put(out, static_cast<uint64_t>(va_arg(args, unsigned))); break;
+			}
+			break;
+		case LogArg::Double:
+			put(out, va_arg(args, double));
+			break;
+		case LogArg::LongDouble:
+			put(out, va_arg(args, long double));
+			break;
+		case LogArg::Pointer:
+			put(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(va_arg(args, void*))));
+			break;
+		case LogArg::String: {
+			const char* str = va_arg(args, const char*);
+			if( !str )
+				str = "(null)";
+
+			// a precision bounds what's read, a negative '*' one means there is none.
+			// long strings are cut to what's left of the record
+			const int32_t precision = spec.starPrecision ? star : spec.precision;
+			size_t room = static_cast<size_t>(end - out) - sizeof(uint16_t);
+			if( precision >= 0 && static_cast<size_t>(precision) < room )
+				room = static_cast<size_t>(precision);
+			const char* const zero = static_cast<const char*>(memchr(str, '\0', room));
+			const size_t len = zero ? static_cast<size_t>(zero - str) : room;
+			put(out, static_cast<uint16_t>(len));
+			memcpy(out, str, len);
+			out += len;
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+
+	make_header(record, BinaryLogRecord, static_cast<size_t>(out - (record + record_header)));
+	return push_record(record, static_cast<size_t>(out - record));
+}
+
+
+static bool async_vlog(const int stream, const char* const fmtString, va_list args) noexcept
+{
+	if( !async_running.load(std::memory_order_acquire) )
+		return false;
+
+	// both may consume the list, keep the original for the synchronous fallback
+	va_list copy;
+	const bool binary = binary_mode.load(std::memory_order_relaxed);
+	if( binary ) {
+		va_copy(copy, args);
+		const bool stored = binary_vlog(stream, fmtString, copy);
+		va_end(copy);
+		if( stored )
+			return true;
+	}
+
+	va_copy(copy, args);
+	char record[record_header + LogRecordMax + 1];
+	int len = vsnprintf(record + text_offset(binary), text_room(binary) + 1, fmtString, copy);
+	va_end(copy);
+
+	if( len < 0 )
+		return false;
+	if( static_cast<size_t>(len) > text_room(binary) )
+		len = static_cast<int>(text_room(binary));
+
+	return push_record(record, finish_text_record(record, binary, stream, static_cast<size_t>(len)));
+}
+
+
+
+
+static bool start_writer(const size_t bufferSize, const LogOverflow overflow, FILE* const file) noexcept
+{
+	// whole records must fit, and the ring rounds up to a power of two anyway
+	buffer_size = bufferSize > record_header + LogRecordMax ? bufferSize : record_header + LogRecordMax;
+	overflow_policy = overflow;
+
+	LogWriter* const logWriter = alloc_arr<LogWriter>(1);
+	if( !logWriter ) {
+		LogError("Failed to allocate the async log writer");
+		return false;
+	}
+
+	new(logWriter) LogWriter();
+	if( !logWriter->Initialize(buffer_size) ) {
+		logWriter->~LogWriter();
+		free_arr(logWriter);
+		LogError("Failed to allocate the async log writer");
+		return false;
+	}
+
+	// what's in stdio's buffers goes out first
+	fflush(stdout);
+	fflush(stderr);
+
+	binary_file = file;
+	binary_mode.store(file != nullptr, std::memory_order_relaxed);
+	writer_stop.store(false, std::memory_order_relaxed);
+	writer = std::thread([logWriter] {
+		logWriter->Run();
+		logWriter->~LogWriter();
+		free_arr(logWriter);
+	});
+
+	async_running.store(true, std::memory_order_release);
+	return true;
+}
+
+
+bool StartAsyncLog(const size_t bufferSize, const LogOverflow overflow) noexcept
+{
+	if( async_running.load(std::memory_order_relaxed) ) {
+		LogError("Async logging already started");
+		return false;
+	}
+
+	return start_writer(bufferSize, overflow, nullptr);
+}
+
+
+bool StartBinaryLog(const char* const path, const size_t bufferSize, const LogOverflow overflow) noexcept
+{
+	if( async_running.load(std::memory_order_relaxed) ) {
+		LogError("Async logging already started");
+		return false;
+	}
+
+	FILE* const file = fopen(path, "wb");
+	if( !file ) {
+		LogError("Failed to open binary log %s", path);
+		return false;
+	}
+
+	// the writer hands over whole passes, stdio buffering would only delay FlushLogs
+	setvbuf(file, nullptr, _IONBF, 0);
+
+	using namespace std::chrono;
+	BinaryLogHeader header;
+	memcpy(header.magic, BinaryLogMagic, sizeof(header.magic));
+	header.version = BinaryLogVersion;
+	header.longDoubleSize = sizeof(long double);
+	header.startTime = now_ns();
+	header.startWallTime = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+
+	if( fwrite(&header, sizeof(header), 1, file) != 1 ) {
+		LogError("Failed to write binary log %s", path);
+		fclose(file);
+		return false;
+	}
+
+	if( !start_writer(bufferSize, overflow, file) ) {
+		fclose(file);
+		return false;
+	}
+
+	return true;
+}
+
+
+void StopAsyncLog() noexcept
+{
+	if( !async_running.load(std::memory_order_relaxed) )
+		return;
+
+	async_running.store(false, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// wait out the producers that got in before the store. not under the lock,
+	// a Block producer may be waiting for the writer, which needs it
+	for(bool busy = true; busy; ) 
+	{
+		busy = false;
+		{
+			std::lock_guard<std::mutex> lock(buffers_mutex);
+			for(LogBuffer* buffer = buffers; buffer; buffer = buffer->next)
+				busy = busy || buffer->busy.load(std::memory_order_acquire);
+		}
+
+		if( busy )
+			std::this_thread::yield();
+	}
+
+	writer_stop.store(true, std::memory_order_release);
+	wake_writer();
+	writer.join();
+
+	if( binary_file ) {
+		fclose(binary_file);
+		binary_file = nullptr;
+		binary_mode.store(false, std::memory_order_relaxed);
+	}
+
+	// release FlushLogs calls the writer didn't get to see
+	flush_done.store(flush_request.load(std::memory_order_acquire), std::memory_order_release);
+	futex_wake_all(&flush_done);
+}
+
+
+void FlushLogs() noexcept
+{
+	if( !async_running.load(std::memory_order_acquire) ) {
+		fflush(stdout);
+		fflush(stderr);
+		return;
+	}
+
+	const uint32_t target = flush_request.fetch_add(1, std::memory_order_acq_rel) + 1;
+	wake_writer();
+
+	for(;;) 
+	{
+		const uint32_t done = flush_done.load(std::memory_order_acquire);
+		if( static_cast<int32_t>(done - target) >= 0 || !async_running.load(std::memory_order_relaxed) )
+			break;
+		futex_wait(&flush_done, done);
+	}
 }
 
 
-const std::string& GetLastLogError() noexcept
+uint64_t GetDroppedLogCount() noexcept
 {
-	return errstr;
+	return dropped.load(std::memory_order_relaxed);
 }
 
 
@@ -0,0 +1,1115 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <Utix/Simd.h>
+#include <Utix/Assert.h>
+#include <Utix/CpuFeatures.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define UTIX_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define UTIX_TARGET(isa)
+#else
+#define UTIX_TARGET(isa) __attribute__((target(isa)))
+#endif
+// gcc learned the AVX-512 BW intrinsics in 5 (the Android NDK ships 4.9)
+#if (defined(_MSC_VER) && _MSC_VER >= 1911) || defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+#define UTIX_SIMD_AVX512 1
+#else
+#define UTIX_SIMD_AVX512 0
+#endif
+#else
+#define UTIX_SIMD_X86 0
+#define UTIX_SIMD_AVX512 0
+#endif
+
+
+namespace utix {
+
+
+namespace {
+
+
+struct SimdKernels
+{
+	SimdIsa isa;
+	float (*sum_f32)(const float*, size_t);
+	int64_t (*sum_i32)(const int32_t*, size_t);
+	uint64_t (*sum_u8)(const uint8_t*, size_t);
+	float (*min_f32)(const float*, size_t);
+	int32_t (*min_i32)(const int32_t*, size_t);
+	uint8_t (*min_u8)(const uint8_t*, size_t);
+	float (*max_f32)(const float*, size_t);
+	int32_t (*max_i32)(const int32_t*, size_t);
+	uint8_t (*max_u8)(const uint8_t*, size_t);
+	float (*dot_f32)(const float*, const float*, size_t);
+	void (*axpy_f32)(float, const float*, float*, size_t);
+	void (*scale_f32)(float*, size_t, float);
+	void (*fill_f32)(float*, size_t, float);
+	void (*fill_i32)(int32_t*, size_t, int32_t);
+	void (*fill_u8)(uint8_t*, size_t, uint8_t);
+	size_t (*count_i32)(const int32_t*, size_t, int32_t);
+	size_t (*count_u8)(const uint8_t*, size_t, uint8_t);
+	size_t (*find_i32)(const int32_t*, size_t, int32_t);
+	size_t (*find_u8)(const uint8_t*, size_t, uint8_t);
+};
+
+
+
+
+namespace scalar {
+
+template<class R, class T>
+R sum(const T* const data, const size_t count)
+{
+	R sum = 0;
+	for(size_t i = 0; i < count; ++i)
+		sum += data[i];
+	return sum;
+}
+
+template<class T>
+T min(const T* const data, const size_t count)
+{
+	T result = data[0];
+	for(size_t i = 1; i < count; ++i)
+		result = data[i] < result ? data[i] : result;
+	return result;
+}
+
+template<class T>
+T max(const T* const data, const size_t count)
+{
+	T result = data[0];
+	for(size_t i = 1; i < count; ++i)
+		result = data[i] > result ? data[i] : result;
+	return result;
+}
+
+float dot(const float* const a, const float* const b, const size_t count)
+{
+	float sum = 0;
+	for(size_t i = 0; i < count; ++i)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+void axpy(const float a, const float* const x, float* const y, const size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+		y[i] += a * x[i];
+}
+
+void scale(float* const data, const size_t count, const float a)
+{
+	for(size_t i = 0; i < count; ++i)
+		data[i] *= a;
+}
+
+template<class T>
+void fill(T* const data, const size_t count, const T value)
+{
+	for(size_t i = 0; i < count; ++i)
+		data[i] = value;
+}
+
+// memset is already as wide as the machine goes
+void fill_u8(uint8_t* const data, const size_t count, const uint8_t value)
+{
+	memset(data, value, count);
+}
+
+template<class T>
+size_t count(const T* const data, const size_t count, const T value)
+{
+	size_t result = 0;
+	for(size_t i = 0; i < count; ++i)
+		result += data[i] == value;
+	return result;
+}
+
+template<class T>
+size_t find(const T* const data, const size_t count, const T value)
+{
+	for(size_t i = 0; i < count; ++i)
+		if( data[i] == value )
+			return i;
+	return count;
+}
+
+const SimdKernels kernels = {
+	SimdIsa::Scalar,
+	sum<float, float>, sum<int64_t, int32_t>, sum<uint64_t, uint8_t>,
+	min<float>, min<int32_t>, min<uint8_t>,
+	max<float>, max<int32_t>, max<uint8_t>,
+	dot, axpy, scale,
+	fill<float>, fill<int32_t>, fill_u8,
+	count<int32_t>, count<uint8_t>,
+	find<int32_t>, find<uint8_t>
+};
+
+}
+
+
+
+
+#if UTIX_SIMD_X86
+
+unsigned first_bit(const uint32_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+
+unsigned first_bit64(const uint64_t mask)
+{
+	const uint32_t low = static_cast<uint32_t>(mask);
+	return low ? first_bit(low) : 32 + first_bit(static_cast<uint32_t>(mask >> 32));
+}
+
+
+unsigned bit_count(const uint32_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	return __popcnt(mask);
+#else
+	return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+}
+
+
+unsigned bit_count64(const uint64_t mask)
+{
+	return bit_count(static_cast<uint32_t>(mask)) + bit_count(static_cast<uint32_t>(mask >> 32));
+}
+
+
+// lane counters in the count kernels are emptied before they can overflow
+constexpr size_t count_block_i32 = size_t(1) << 20;
+constexpr size_t count_block_u8 = 255;
+
+
+
+
+namespace sse2 {
+
+#define UTIX_SSE2 UTIX_TARGET("sse2")
+
+UTIX_SSE2 float sum_f32(const float* const data, const size_t count)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_loadu_ps(data + i));
+		acc1 = _mm_add_ps(acc1, _mm_loadu_ps(data + i + 4));
+	}
+
+	float lanes[4];
+	_mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+	float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for(; i < count; ++i)
+		sum += data[i];
+	return sum;
+}
+
+UTIX_SSE2 int64_t sum_i32(const int32_t* const data, const size_t count)
+{
+	__m128i acc = _mm_setzero_si128();
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		const __m128i sign = _mm_srai_epi32(v, 31);
+		acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+		acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+	}
+
+	int64_t lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+	int64_t sum = lanes[0] + lanes[1];
+	for(; i < count; ++i)
+		sum += data[i];
+	return sum;
+}
+
+UTIX_SSE2 uint64_t sum_u8(const uint8_t* const data, const size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = zero;
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16)
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), zero));
+
+	uint64_t lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+	uint64_t sum = lanes[0] + lanes[1];
+	for(; i < count; ++i)
+		sum += data[i];
+	return sum;
+}
+
+// SSE2 has no min / max for int32, select on a compare
+UTIX_SSE2 inline __m128i min_epi32(const __m128i a, const __m128i b)
+{
+	const __m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+
+UTIX_SSE2 inline __m128i max_epi32(const __m128i a, const __m128i b)
+{
+	const __m128i gt = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+// min and max go over the last full vector again for the tail,
+// seeing an element twice doesn't change them
+#define UTIX_SSE2_MINMAX_F32(name, op)                                  \
+UTIX_SSE2 float name(const float* const data, const size_t count)      \
+{                                                                      \
+	if( count < 4 )                                                    \
+		return scalar::name(data, count);                              \
+	__m128 acc = _mm_loadu_ps(data);                                   \
+	for(size_t i = 4; i + 4 <= count; i += 4)                          \
+		acc = op(acc, _mm_loadu_ps(data + i));                         \
+	acc = op(acc, _mm_loadu_ps(data + count - 4));                     \
+	float lanes[4];                                                    \
+	_mm_storeu_ps(lanes, acc);                                         \
+	return scalar::name(lanes, 4);                                     \
+}
+
+#define UTIX_SSE2_MINMAX_INT(name, T, lanes_n, op)                                   \
+UTIX_SSE2 T name(const T* const data, const size_t count)                            \
+{                                                                                    \
+	if( count < lanes_n )                                                            \
+		return scalar::name(data, count);                                            \
+	__m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));           \
+	for(size_t i = lanes_n; i + lanes_n <= count; i += lanes_n)                      \
+		acc = op(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));  \
+	acc = op(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + count - lanes_n))); \
+	T lanes[lanes_n];                                                                \
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);                        \
+	return scalar::name(lanes, lanes_n);                                             \
+}
+
+UTIX_SSE2_MINMAX_F32(min, _mm_min_ps)
+UTIX_SSE2_MINMAX_F32(max, _mm_max_ps)
+UTIX_SSE2_MINMAX_INT(min, int32_t, 4, min_epi32)
+UTIX_SSE2_MINMAX_INT(max, int32_t, 4, max_epi32)
+UTIX_SSE2_MINMAX_INT(min, uint8_t, 16, _mm_min_epu8)
+UTIX_SSE2_MINMAX_INT(max, uint8_t, 16, _mm_max_epu8)
+
+UTIX_SSE2 float dot_f32(const float* const a, const float* const b, const size_t count)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+
+	float lanes[4];
+	_mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+	float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for(; i < count; ++i)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+UTIX_SSE2 void axpy_f32(const float a, const float* const x, float* const y, const size_t count)
+{
+	const __m128 va = _mm_set1_ps(a);
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+	for(; i < count; ++i)
+		y[i] += a * x[i];
+}
+
+UTIX_SSE2 void scale_f32(float* const data, const size_t count, const float a)
+{
+	const __m128 va = _mm_set1_ps(a);
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+		_mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), va));
+	for(; i < count; ++i)
+		data[i] *= a;
+}
+
+UTIX_SSE2 void fill_f32(float* const data, const size_t count, const float value)
+{
+	const __m128 v = _mm_set1_ps(value);
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+		_mm_storeu_ps(data + i, v);
+	for(; i < count; ++i)
+		data[i] = value;
+}
+
+UTIX_SSE2 void fill_i32(int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m128i v = _mm_set1_epi32(value);
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), v);
+	for(; i < count; ++i)
+		data[i] = value;
+}
+
+// matches are -1 per lane, subtracting them counts up
+UTIX_SSE2 size_t count_i32(const int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m128i needle = _mm_set1_epi32(value);
+	size_t result = 0;
+	size_t i = 0;
+	while( i + 4 <= count )
+	{
+		const size_t end = i + std::min((count - i) & ~size_t(3), count_block_i32 * 4);
+		__m128i acc = _mm_setzero_si128();
+		for(; i < end; i += 4)
+			acc = _mm_sub_epi32(acc, _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), needle));
+
+		uint32_t lanes[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+		result += size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+	}
+
+	for(; i < count; ++i)
+		result += data[i] == value;
+	return result;
+}
+
+UTIX_SSE2 size_t count_u8(const uint8_t* const data, const size_t count, const uint8_t value)
+{
+	const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+	const __m128i zero = _mm_setzero_si128();
+	__m128i total = zero;
+	size_t i = 0;
+	while( i + 16 <= count )
+	{
+		const size_t end = i + std::min((count - i) & ~size_t(15), count_block_u8 * 16);
+		__m128i acc = zero;
+		for(; i < end; i += 16)
+			acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), needle));
+		total = _mm_add_epi64(total, _mm_sad_epu8(acc, zero));
+	}
+
+	uint64_t lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+	size_t result = static_cast<size_t>(lanes[0] + lanes[1]);
+	for(; i < count; ++i)
+		result += data[i] == value;
+	return result;
+}
+
+UTIX_SSE2 size_t find_i32(const int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m128i needle = _mm_set1_epi32(value);
+	size_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), needle);
+		const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+		if( mask )
+			return i + first_bit(mask);
+	}
+	return i + scalar::find(data + i, count - i, value);
+}
+
+UTIX_SSE2 size_t find_u8(const uint8_t* const data, const size_t count, const uint8_t value)
+{
+	const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		const __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), needle);
+		const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+		if( mask )
+			return i + first_bit(mask);
+	}
+	return i + scalar::find(data + i, count - i, value);
+}
+
+const SimdKernels kernels = {
+	SimdIsa::Sse2,
+	sum_f32, sum_i32, sum_u8,
+	min, min, min,
+	max, max, max,
+	dot_f32, axpy_f32, scale_f32,
+	fill_f32, fill_i32, scalar::fill_u8,
+	count_i32, count_u8,
+	find_i32, find_u8
+};
+
+#undef UTIX_SSE2_MINMAX_F32
+#undef UTIX_SSE2_MINMAX_INT
+#undef UTIX_SSE2
+
+}
+
+
+
+
+namespace avx2 {
+
+#define UTIX_AVX2 UTIX_TARGET("avx2,fma")
+
+UTIX_AVX2 float sum_f32(const float* const data, const size_t count)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+		acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(data + i + 8));
+	}
+
+	float lanes[8];
+	_mm256_storeu_ps(lanes, _mm256_add_ps(acc0, acc1));
+	float sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+	for(; i < count; ++i)
+		sum += data[i];
+	return sum;
+}
+
+UTIX_AVX2 int64_t sum_i32(const int32_t* const data, const size_t count)
+{
+	__m256i acc = _mm256_setzero_si256();
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))));
+		acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4))));
+	}
+
+	int64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+	int64_t sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for(; i < count; ++i)
+		sum += data[i];
+	return sum;
+}
+
+UTIX_AVX2 uint64_t sum_u8(const uint8_t* const data, const size_t count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc = zero;
+	size_t i = 0;
+	for(; i + 32 <= count; i += 32)
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), zero));
+
+	uint64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+	uint64_t sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for(; i < count; ++i)
+		sum += data[i];
+	return sum;
+}
+
+#define UTIX_AVX2_MINMAX_F32(name, op)                                  \
+UTIX_AVX2 float name(const float* const data, const size_t count)      \
+{                                                                      \
+	if( count < 8 )                                                    \
+		return scalar::name(data, count);                              \
+	__m256 acc = _mm256_loadu_ps(data);                                \
+	for(size_t i = 8; i + 8 <= count; i += 8)                          \
+		acc = op(acc, _mm256_loadu_ps(data + i));                      \
+	acc = op(acc, _mm256_loadu_ps(data + count - 8));                  \
+	float lanes[8];                                                    \
+	_mm256_storeu_ps(lanes, acc);                                      \
+	return scalar::name(lanes, 8);                                     \
+}
+
+#define UTIX_AVX2_MINMAX_INT(name, T, lanes_n, op)                                   \
+UTIX_AVX2 T name(const T* const data, const size_t count)                            \
+{                                                                                    \
+	if( count < lanes_n )                                                            \
+		return scalar::name(data, count);                                            \
+	__m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));        \
+	for(size_t i = lanes_n; i + lanes_n <= count; i += lanes_n)                      \
+		acc = op(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))); \
+	acc = op(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + count - lanes_n))); \
+	T lanes[lanes_n];                                                                \
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);                     \
+	return scalar::name(lanes, lanes_n);                                             \
+}
+
+UTIX_AVX2_MINMAX_F32(min, _mm256_min_ps)
+UTIX_AVX2_MINMAX_F32(max, _mm256_max_ps)
+UTIX_AVX2_MINMAX_INT(min, int32_t, 8, _mm256_min_epi32)
+UTIX_AVX2_MINMAX_INT(max, int32_t, 8, _mm256_max_epi32)
+UTIX_AVX2_MINMAX_INT(min, uint8_t, 32, _mm256_min_epu8)
+UTIX_AVX2_MINMAX_INT(max, uint8_t, 32, _mm256_max_epu8)
+
+UTIX_AVX2 float dot_f32(const float* const a, const float* const b, const size_t count)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+		acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+	}
+
+	float lanes[8];
+	_mm256_storeu_ps(lanes, _mm256_add_ps(acc0, acc1));
+	float sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+	for(; i < count; ++i)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+UTIX_AVX2 void axpy_f32(const float a, const float* const x, float* const y, const size_t count)
+{
+	const __m256 va = _mm256_set1_ps(a);
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+	for(; i < count; ++i)
+		y[i] += a * x[i];
+}
+
+UTIX_AVX2 void scale_f32(float* const data, const size_t count, const float a)
+{
+	const __m256 va = _mm256_set1_ps(a);
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), va));
+	for(; i < count; ++i)
+		data[i] *= a;
+}
+
+UTIX_AVX2 void fill_f32(float* const data, const size_t count, const float value)
+{
+	const __m256 v = _mm256_set1_ps(value);
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(data + i, v);
+	for(; i < count; ++i)
+		data[i] = value;
+}
+
+UTIX_AVX2 void fill_i32(int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m256i v = _mm256_set1_epi32(value);
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), v);
+	for(; i < count; ++i)
+		data[i] = value;
+}
+
+UTIX_AVX2 size_t count_i32(const int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m256i needle = _mm256_set1_epi32(value);
+	size_t result = 0;
+	size_t i = 0;
+	while( i + 8 <= count )
+	{
+		const size_t end = i + std::min((count - i) & ~size_t(7), count_block_i32 * 8);
+		__m256i acc = _mm256_setzero_si256();
+		for(; i < end; i += 8)
+			acc = _mm256_sub_epi32(acc, _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), needle));
+
+		uint32_t lanes[8];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+		for(const uint32_t lane : lanes)
+			result += lane;
+	}
+
+	for(; i < count; ++i)
+		result += data[i] == value;
+	return result;
+}
+
+UTIX_AVX2 size_t count_u8(const uint8_t* const data, const size_t count, const uint8_t value)
+{
+	const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i total = zero;
+	size_t i = 0;
+	while( i + 32 <= count )
+	{
+		const size_t end = i + std::min((count - i) & ~size_t(31), count_block_u8 * 32);
+		__m256i acc = zero;
+		for(; i < end; i += 32)
+			acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), needle));
+		total = _mm256_add_epi64(total, _mm256_sad_epu8(acc, zero));
+	}
+
+	uint64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+	size_t result = static_cast<size_t>((lanes[0] + lanes[1]) + (lanes[2] + lanes[3]));
+	for(; i < count; ++i)
+		result += data[i] == value;
+	return result;
+}
+
+UTIX_AVX2 size_t find_i32(const int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m256i needle = _mm256_set1_epi32(value);
+	size_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		const __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), needle);
+		const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+		if( mask )
+			return i + first_bit(mask);
+	}
+	return i + scalar::find(data + i, count - i, value);
+}
+
+UTIX_AVX2 size_t find_u8(const uint8_t* const data, const size_t count, const uint8_t value)
+{
+	const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+	size_t i = 0;
+	for(; i + 32 <= count; i += 32) {
+		const __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), needle);
+		const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+		if( mask )
+			return i + first_bit(mask);
+	}
+	return i + scalar::find(data + i, count - i, value);
+}
+
+const SimdKernels kernels = {
+	SimdIsa::Avx2,
+	sum_f32, sum_i32, sum_u8,
+	min, min, min,
+	max, max, max,
+	dot_f32, axpy_f32, scale_f32,
+	fill_f32, fill_i32, scalar::fill_u8,
+	count_i32, count_u8,
+	find_i32, find_u8
+};
+
+#undef UTIX_AVX2_MINMAX_F32
+#undef UTIX_AVX2_MINMAX_INT
+#undef UTIX_AVX2
+
+}
+
+
+
+
+#if UTIX_SIMD_AVX512
+
+// gcc's avx512 headers start some intrinsics from _mm512_undefined_*,
+// which -Wmaybe-uninitialized takes for a real uninitialized read
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// tails go through masked loads and stores instead of scalar loops
+namespace avx512 {
+
+#define UTIX_AVX512 UTIX_TARGET("avx512f,avx512bw,popcnt")
+
+inline __mmask16 tail_mask16(const size_t remaining) 
+{ 
+	return static_cast<__mmask16>((1u << remaining) - 1); 
+}
+
+inline __mmask64 tail_mask64(const size_t remaining) 
+{ 
+	return remaining >= 64 ? ~__mmask64(0) : static_cast<__mmask64>((uint64_t(1) << remaining) - 1); 
+}
+
+UTIX_AVX512 float sum_f32(const float* const data, const size_t count)
+{
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	size_t i = 0;
+	for(; i + 32 <= count; i += 32) {
+		acc0 = _mm512_add_ps(acc0, _mm512_loadu_ps(data + i));
+		acc1 = _mm512_add_ps(acc1, _mm512_loadu_ps(data + i + 16));
+	}
+	for(; i < count; i += 16)
+		acc0 = _mm512_add_ps(acc0, _mm512_maskz_loadu_ps(tail_mask16(std::min<size_t>(count - i, 16)), data + i));
+
+	float lanes[16];
+	_mm512_storeu_ps(lanes, _mm512_add_ps(acc0, acc1));
+	for(int step = 8; step > 0; step /= 2)
+		for(int l = 0; l < step; ++l)
+			lanes[l] += lanes[l + step];
+	return lanes[0];
+}
+
+UTIX_AVX512 inline __m512i add_widened(const __m512i acc, const __m512i v)
+{
+	const __m512i low = _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v));
+	const __m512i high = _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1));
+	return _mm512_add_epi64(acc, _mm512_add_epi64(low, high));
+}
+
+UTIX_AVX512 int64_t sum_i32(const int32_t* const data, const size_t count)
+{
+	__m512i acc = _mm512_setzero_si512();
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16)
+		acc = add_widened(acc, _mm512_loadu_si512(data + i));
+	if( i < count )
+		acc = add_widened(acc, _mm512_maskz_loadu_epi32(tail_mask16(count - i), data + i));
+
+	int64_t lanes[8];
+	_mm512_storeu_si512(lanes, acc);
+	int64_t sum = 0;
+	for(const int64_t lane : lanes)
+		sum += lane;
+	return sum;
+}
+
+UTIX_AVX512 uint64_t sum_u8(const uint8_t* const data, const size_t count)
+{
+	const __m512i zero = _mm512_setzero_si512();
+	__m512i acc = zero;
+	size_t i = 0;
+	for(; i + 64 <= count; i += 64)
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_loadu_si512(data + i), zero));
+	if( i < count )
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_maskz_loadu_epi8(tail_mask64(count - i), data + i), zero));
+
+	uint64_t lanes[8];
+	_mm512_storeu_si512(lanes, acc);
+	uint64_t sum = 0;
+	for(const uint64_t lane : lanes)
+		sum += lane;
+	return sum;
+}
+
+#define UTIX_AVX512_MINMAX(name, T, lanes_n, reg, load, store, op)             \
+UTIX_AVX512 T name(const T* const data, const size_t count)                   \
+{                                                                             \
+	if( count < lanes_n )                                                     \
+		return scalar::name(data, count);                                     \
+	reg acc = load(data);                                                     \
+	for(size_t i = lanes_n; i + lanes_n <= count; i += lanes_n)               \
+		acc = op(acc, load(data + i));                                        \
+	acc = op(acc, load(data + count - lanes_n));                              \
+	T lanes[lanes_n];                                                         \
+	store(lanes, acc);                                                        \
+	return scalar::name(lanes, lanes_n);                                      \
+}
+
+UTIX_AVX512_MINMAX(min, float, 16, __m512, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_min_ps)
+UTIX_AVX512_MINMAX(max, float, 16, __m512, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_max_ps)
+UTIX_AVX512_MINMAX(min, int32_t, 16, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_min_epi32)
+UTIX_AVX512_MINMAX(max, int32_t, 16, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_max_epi32)
+UTIX_AVX512_MINMAX(min, uint8_t, 64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_min_epu8)
+UTIX_AVX512_MINMAX(max, uint8_t, 64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512, _mm512_max_epu8)
+
+UTIX_AVX512 float dot_f32(const float* const a, const float* const b, const size_t count)
+{
+	__m512 acc0 = _mm512_setzero_ps();
+	__m512 acc1 = _mm512_setzero_ps();
+	size_t i = 0;
+	for(; i + 32 <= count; i += 32) {
+		acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+		acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+	}
+	for(; i < count; i += 16) {
+		const __mmask16 mask = tail_mask16(std::min<size_t>(count - i, 16));
+		acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), acc0);
+	}
+
+	float lanes[16];
+	_mm512_storeu_ps(lanes, _mm512_add_ps(acc0, acc1));
+	for(int step = 8; step > 0; step /= 2)
+		for(int l = 0; l < step; ++l)
+			lanes[l] += lanes[l + step];
+	return lanes[0];
+}
+
+UTIX_AVX512 void axpy_f32(const float a, const float* const x, float* const y, const size_t count)
+{
+	const __m512 va = _mm512_set1_ps(a);
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16)
+		_mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+	if( i < count ) {
+		const __mmask16 mask = tail_mask16(count - i);
+		const __m512 result = _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(mask, x + i), _mm512_maskz_loadu_ps(mask, y + i));
+		_mm512_mask_storeu_ps(y + i, mask, result);
+	}
+}
+
+UTIX_AVX512 void scale_f32(float* const data, const size_t count, const float a)
+{
+	const __m512 va = _mm512_set1_ps(a);
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16)
+		_mm512_storeu_ps(data + i, _mm512_mul_ps(_mm512_loadu_ps(data + i), va));
+	if( i < count ) {
+		const __mmask16 mask = tail_mask16(count - i);
+		_mm512_mask_storeu_ps(data + i, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, data + i), va));
+	}
+}
+
+UTIX_AVX512 void fill_f32(float* const data, const size_t count, const float value)
+{
+	const __m512 v = _mm512_set1_ps(value);
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16)
+		_mm512_storeu_ps(data + i, v);
+	if( i < count )
+		_mm512_mask_storeu_ps(data + i, tail_mask16(count - i), v);
+}
+
+UTIX_AVX512 void fill_i32(int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m512i v = _mm512_set1_epi32(value);
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16)
+		_mm512_storeu_si512(data + i, v);
+	if( i < count )
+		_mm512_mask_storeu_epi32(data + i, tail_mask16(count - i), v);
+}
+
+// compares give bit masks here, no lane counters to empty
+UTIX_AVX512 size_t count_i32(const int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m512i needle = _mm512_set1_epi32(value);
+	size_t result = 0;
+	size_t i = 0;
+	for(; i + 16 <= count; i += 16)
+		result += bit_count(_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i), needle));
+	if( i < count ) {
+		const __mmask16 mask = tail_mask16(count - i);
+		result += bit_count(_mm512_mask_cmpeq_epi32_mask(mask, _mm512_maskz_loadu_epi32(mask, data + i), needle));
+	}
+	return result;
+}
+
+UTIX_AVX512 size_t count_u8(const uint8_t* const data, const size_t count, const uint8_t value)
+{
+	const __m512i needle = _mm512_set1_epi8(static_cast<char>(value));
+	size_t result = 0;
+	size_t i = 0;
+	for(; i + 64 <= count; i += 64)
+		result += bit_count64(_mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + i), needle));
+	if( i < count ) {
+		const __mmask64 mask = tail_mask64(count - i);
+		result += bit_count64(_mm512_mask_cmpeq_epi8_mask(mask, _mm512_maskz_loadu_epi8(mask, data + i), needle));
+	}
+	return result;
+}
+
+UTIX_AVX512 size_t find_i32(const int32_t* const data, const size_t count, const int32_t value)
+{
+	const __m512i needle = _mm512_set1_epi32(value);
+	size_t i = 0;
+	for(; i < count; i += 16) {
+		const __mmask16 mask = tail_mask16(std::min<size_t>(count - i, 16));
+		const uint32_t found = _mm512_mask_cmpeq_epi32_mask(mask, _mm512_maskz_loadu_epi32(mask, data + i), needle);
+		if( found )
+			return i + first_bit(found);
+	}
+	return count;
+}
+
+UTIX_AVX512 size_t find_u8(const uint8_t* const data, const size_t count, const uint8_t value)
+{
+	const __m512i needle = _mm512_set1_epi8(static_cast<char>(value));
+	size_t i = 0;
+	for(; i < count; i += 64) {
+		const __mmask64 mask = tail_mask64(count - i);
+		const uint64_t found = _mm512_mask_cmpeq_epi8_mask(mask, _mm512_maskz_loadu_epi8(mask, data + i), needle);
+		if( found )
+			return i + first_bit64(found);
+	}
+	return count;
+}
+
+const SimdKernels kernels = {
+	SimdIsa::Avx512,
+	sum_f32, sum_i32, sum_u8,
+	min, min, min,
+	max, max, max,
+	dot_f32, axpy_f32, scale_f32,
+	fill_f32, fill_i32, scalar::fill_u8,
+	count_i32, count_u8,
+	find_i32, find_u8
+};
+
+#undef UTIX_AVX512_MINMAX
+#undef UTIX_AVX512
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // UTIX_SIMD_AVX512
+
+
+
+
+#endif // UTIX_SIMD_X86
+
+
+
+
+// best first. AVX2 comes with FMA on every cpu that has it, the kernels use both
+const CpuVariant<SimdKernels> variants[] = {
+#if UTIX_SIMD_AVX512
+	{ CpuFeatures::Avx512F | CpuFeatures::Avx512BW | CpuFeatures::Popcnt, &avx512::kernels },
+#endif
+#if UTIX_SIMD_X86
+	{ CpuFeatures::Avx2 | CpuFeatures::Fma, &avx2::kernels },
+	{ CpuFeatures::Sse2, &sse2::kernels },
+#endif
+	{ 0, &scalar::kernels }
+};
+
+
+std::atomic<const SimdKernels*> active_kernels{nullptr};
+
+
+// two threads racing the first call store the same table
+const SimdKernels& kernels()
+{
+	const SimdKernels* table = active_kernels.load(std::memory_order_acquire);
+	if( !table ) {
+		table = &cpu_dispatch(variants);
+		active_kernels.store(table, std::memory_order_release);
+	}
+	return *table;
+}
+
+
+}
+
+
+
+
+SimdIsa get_simd_isa()
+{
+	return kernels().isa;
+}
+
+
+const char* get_simd_isa_name(const SimdIsa isa)
+{
+	switch( isa ) 
+	{
+	case SimdIsa::Sse2: return "SSE2";
+	case SimdIsa::Avx2: return "AVX2";
+	case SimdIsa::Avx512: return "AVX-512";
+	default: return "Scalar";
+	}
+}
+
+
+bool set_simd_isa(const SimdIsa isa)
+{
+	const CpuFeatures& cpu = get_cpu_features();
+
+	for(const CpuVariant<SimdKernels>& variant : variants) 
+	{
+		if( variant.value->isa == isa ) {
+			if( !cpu.Has(variant.required) )
+				return false;
+
+			active_kernels.store(variant.value, std::memory_order_release);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+
+
+float simd_sum(const float* const data, const size_t count) { return kernels().sum_f32(data, count); }
+int64_t simd_sum(const int32_t* const data, const size_t count) { return kernels().sum_i32(data, count); }
+uint64_t simd_sum(const uint8_t* const data, const size_t count) { return kernels().sum_u8(data, count); }
+
+
+float simd_min(const float* const data, const size_t count)
+{
+	ASSERT_MSG(count > 0, "simd_min of nothing");
+	return kernels().min_f32(data, count);
+}
+
+
+int32_t simd_min(const int32_t* const data, const size_t count)
+{
+	ASSERT_MSG(count > 0, "simd_min of nothing");
+	return kernels().min_i32(data, count);
+}
+
+
+uint8_t simd_min(const uint8_t* const data, const size_t count)
+{
+	ASSERT_MSG(count > 0, "simd_min of nothing");
+	return kernels().min_u8(data, count);
+}
+
+
+float simd_max(const float* const data, const size_t count)
+{
+	ASSERT_MSG(count > 0, "simd_max of nothing");
+	return kernels().max_f32(data, count);
+}
+
+
+int32_t simd_max(const int32_t* const data, const size_t count)
+{
+	ASSERT_MSG(count > 0, "simd_max of nothing");
+	return kernels().max_i32(data, count);
+}
+
+
+uint8_t simd_max(const uint8_t* const data, const size_t count)
+{
+	ASSERT_MSG(count > 0, "simd_max of nothing");
+	return kernels().max_u8(data, count);
+}
+
+
+float simd_dot(const float* const a, const float* const b, const size_t count) { return kernels().dot_f32(a, b, count); }
+void simd_axpy(const float a, const float* const x, float* const y, const size_t count) { kernels().axpy_f32(a, x, y, count); }
+void simd_scale(float* const data, const size_t count, const float a) { kernels().scale_f32(data, count, a); }
+
+
+void simd_fill(float* const data, const size_t count, const float value) { kernels().fill_f32(data, count, value); }
+void simd_fill(int32_t* const data, const size_t count, const int32_t value) { kernels().fill_i32(data, count, value); }
+void simd_fill(uint8_t* const data, const size_t count, const uint8_t value) { kernels().fill_u8(data, count, value); }
+
+
+size_t simd_count(const int32_t* const data, const size_t count, const int32_t value) { return kernels().count_i32(data, count, value); }
+size_t simd_count(const uint8_t* const data, const size_t count, const uint8_t value) { return kernels().count_u8(data, count, value); }
+
+
+size_t simd_find(const int32_t* const data, const size_t count, const int32_t value) { return kernels().find_i32(data, count, value); }
+size_t simd_find(const uint8_t* const data, const size_t count, const uint8_t value) { return kernels().find_u8(data, count, value); }
+
+
+}
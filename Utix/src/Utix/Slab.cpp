@@ -0,0 +1,372 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <Utix/Slab.h>
+#include <Utix/Assert.h>
+#include <Utix/Log.h>
+
+
+
+namespace utix {
+
+
+namespace {
+
+
+constexpr size_t class_count = 20;
+constexpr size_t slab_bytes = 64 * 1024;
+
+constexpr size_t class_sizes[class_count] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256, 320, 384, 448, 512,
+	640, 768, 896, 1024
+};
+
+// indexed by (bytes + 15) / 16
+constexpr uint8_t size_to_class[(SlabMaxBlockSize / 16) + 1] = {
+	0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 9, 10, 10, 11, 11, 
+	12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15, 
+	16, 16, 16, 16, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17, 17, 
+	18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19, 19
+};
+
+
+struct FreeNode
+{
+	FreeNode* next;
+};
+
+
+struct CentralList
+{
+	std::mutex mutex;
+	FreeNode* head = nullptr;
+};
+
+
+CentralList central[class_count];
+
+
+
+inline size_t get_class(const size_t bytes)
+{
+	ASSERT_MSG(bytes <= SlabMaxBlockSize, "slab block size overflow");
+	return size_to_class[(bytes + 15) / 16];
+}
+
+
+// small classes move more blocks per trip to the central list
+inline size_t batch_size(const size_t cls)
+{
+	const size_t count = (8 * 1024) / class_sizes[cls];
+	return count < 8 ? 8 : count > 64 ? 64 : count;
+}
+
+
+
+struct ThreadCache
+{
+	ThreadCache() = default;
+	ThreadCache(const ThreadCache&) = delete;
+	ThreadCache& operator=(const ThreadCache&) = delete;
+	~ThreadCache();
+
+	FreeNode* heads[class_count] = { };
+	size_t counts[class_count] = { };
+};
+
+
+thread_local ThreadCache thread_cache;
+
+// set once this thread's cache is gone. thread_local destructors that run later,
+// and the main thread's static destructors, then go to the central lists.
+// trivially destructible, so it can still be read by then
+thread_local bool thread_cache_destroyed = false;
+
+
+
+// gives the chain [first, last] to the central list
+void release(const size_t cls, FreeNode* const first, FreeNode* const last)
+{
+	CentralList& list = central[cls];
+	std::lock_guard<std::mutex> lock(list.mutex);
+	last->next = list.head;
+	list.head = first;
+}
+
+
+
+// takes a batch of blocks, from the central list or a new slab. nullptr if out of memory
+FreeNode* take_batch(const size_t cls, size_t& taken)
+{
+	const size_t batch = batch_size(cls);
+	CentralList& list = central[cls];
+	FreeNode* first = nullptr;
+	size_t count = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(list.mutex);
+		first = list.head;
+		FreeNode* last = nullptr;
+		for(FreeNode* itr = first; itr != nullptr && count < batch; itr = itr->next) {
+			last = itr;
+			++count;
+		}
+
+		if(last) {
+			list.head = last->next;
+			last->next = nullptr;
+		}
+	}
+
+	if(count == 0)
+	{
+		// central list is empty, carve a new slab
+		auto* const slab = static_cast<uint8_t*>(malloc(slab_bytes));
+
+		if(!slab) {
+			LogError("Failed to allocate slab");
+			return nullptr;
+		}
+
+		const size_t blockSize = class_sizes[cls];
+		const size_t blocks = slab_bytes / blockSize;
+		for(size_t i = 0; i < blocks; ++i) {
+			auto* const node = reinterpret_cast<FreeNode*>(slab + (i * blockSize));
+			node->next = (i + 1) < blocks 
+				? reinterpret_cast<FreeNode*>(slab + ((i + 1) * blockSize)) : nullptr;
+		}
+
+		first = reinterpret_cast<FreeNode*>(slab);
+		count = blocks;
+
+		// keep one batch, the rest goes to the central list
+		if(blocks > batch) {
+			auto* const rest = reinterpret_cast<FreeNode*>(slab + (batch * blockSize));
+			auto* const restLast = reinterpret_cast<FreeNode*>(slab + ((blocks - 1) * blockSize));
+			reinterpret_cast<FreeNode*>(slab + ((batch - 1) * blockSize))->next = nullptr;
+			release(cls, rest, restLast);
+			count = batch;
+		}
+	}
+
+	taken = count;
+	return first;
+}
+
+
+
+// refills the cache of a class, returns false if out of memory
+bool refill(ThreadCache& cache, const size_t cls)
+{
+	size_t count = 0;
+	FreeNode* const first = take_batch(cls, count);
+
+	if(!first)
+		return false;
+
+	cache.heads[cls] = first;
+	cache.counts[cls] = count;
+	return true;
+}
+
+
+
+// one block without a thread cache, the rest of its batch goes back
+void* alloc_uncached(const size_t cls)
+{
+	size_t count = 0;
+	FreeNode* const first = take_batch(cls, count);
+
+	if(first && first->next) {
+		FreeNode* last = first->next;
+		while(last->next)
+			last = last->next;
+		release(cls, first->next, last);
+	}
+
+	return first;
+}
+
+
+
+ThreadCache::~ThreadCache()
+{
+	for(size_t cls = 0; cls < class_count; ++cls) 
+	{
+		if(heads[cls]) {
+			FreeNode* last = heads[cls];
+			while(last->next)
+				last = last->next;
+			release(cls, heads[cls], last);
+		}
+		heads[cls] = nullptr;
+		counts[cls] = 0;
+	}
+
+	thread_cache_destroyed = true;
+}
+
+
+
+} // anonymous namespace
+
+
+
+
+
+void* slab_alloc(const size_t bytes) noexcept
+{
+	const size_t cls = get_class(bytes);
+
+	if(thread_cache_destroyed)
+		return alloc_uncached(cls);
+
+	ThreadCache& cache = thread_cache;
+
+	if(!cache.heads[cls] && !refill(cache, cls))
+		return nullptr;
+
+	FreeNode* const node = cache.heads[cls];
+	cache.heads[cls] = node->next;
+	--cache.counts[cls];
+	return node;
+}
+
+
+
+void slab_free(void* block, const size_t bytes) noexcept
+{
+	ASSERT_MSG(block != nullptr, "attempt to free null pointer!");
+
+	const size_t cls = get_class(bytes);
+	auto* const node = static_cast<FreeNode*>(block);
+
+	if(thread_cache_destroyed) {
+		release(cls, node, node);
+		return;
+	}
+
+	ThreadCache& cache = thread_cache;
+	node->next = cache.heads[cls];
+	cache.heads[cls] = node;
+
+	// keeps the cache bounded, gives back one batch
+	const size_t batch = batch_size(cls);
+	if(++cache.counts[cls] >= (batch * 2)) 
+	{
+		FreeNode* last = node;
+		for(size_t i = 1; i < batch; ++i)
+			last = last->next;
+
+		cache.heads[cls] = last->next;
+		cache.counts[cls] -= batch;
+		last->next = nullptr;
+		release(cls, node, last);
+	}
+}
+
+
+
+size_t slab_block_size(const size_t bytes) noexcept
+{
+	return class_sizes[get_class(bytes)];
+}
+
+
+
+
+// SlabArrAlloc blocks: [ size ][ data... ], the size with header picks slab or malloc
+
+void* SlabArrAlloc::allocate(const size_t bytes) noexcept
+{
+	ASSERT_MSG(bytes > 0, "attempt to alloc array of size 0");
+
+	const size_t total = bytes + sizeof(size_t);
+	auto* const block = static_cast<size_t*>(total <= SlabMaxBlockSize ? slab_alloc(total) : malloc(total));
+
+	if(block) {
+		*block = bytes;
+		return block + 1;
+	}
+
+	return nullptr;
+}
+
+
+
+void* SlabArrAlloc::reallocate(void* from, const size_t bytes) noexcept
+{
+	ASSERT_MSG(from != nullptr, "attempt to realloc from null pointer!");
+	ASSERT_MSG(bytes > 0, "attempt to realloc to size 0!");
+
+	auto* const oldBlock = static_cast<size_t*>(from) - 1;
+	const size_t oldTotal = *oldBlock + sizeof(size_t);
+	const size_t total = bytes + sizeof(size_t);
+
+	if(oldTotal > SlabMaxBlockSize && total > SlabMaxBlockSize)
+	{
+		auto* const block = static_cast<size_t*>(realloc(oldBlock, total));
+		if(!block)
+			return nullptr;
+
+		*block = bytes;
+		return block + 1;
+	}
+
+	if(oldTotal <= SlabMaxBlockSize && total <= SlabMaxBlockSize 
+	    && get_class(oldTotal) == get_class(total))
+	{
+		*oldBlock = bytes;
+		return from;
+	}
+
+	void* const block = this->allocate(bytes);
+	if(block) {
+		memcpy(block, from, *oldBlock < bytes ? *oldBlock : bytes);
+		this->deallocate(from);
+	}
+
+	return block;
+}
+
+
+
+void SlabArrAlloc::deallocate(const void* block) noexcept
+{
+	ASSERT_MSG(block != nullptr, "attempt to free null pointer!");
+
+	auto* const header = const_cast<size_t*>(static_cast<const size_t*>(block)) - 1;
+	const size_t total = *header + sizeof(size_t);
+
+	if(total <= SlabMaxBlockSize)
+		slab_free(header, total);
+	else
+		free(header);
+}
+
+
+
+
+
+}
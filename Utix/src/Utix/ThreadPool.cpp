@@ -0,0 +1,491 @@
+/*
+
+UTIX - utility library from XChip
+Copyright (C) 2016  Rafael Moura
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see http://www.gnu.org/licenses/gpl-3.0.html.
+
+*/
+
+#include <chrono>
+#include <thread>
+#include <Utix/ThreadPool.h>
+#include <Utix/Futex.h>
+#include <Utix/Assert.h>
+#include <Utix/Log.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
+
+namespace utix {
+
+
+namespace {
+
+
+constexpr int spin_count = 128;
+
+
+uint64_t now_ns()
+{
+	using namespace std::chrono;
+	return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+
+// Chase-Lev deque, fixed size. the owner pushes and pops at the bottom,
+// thieves take from the top. (C11 version from Le, Pop, Cohen and Zappa Nardelli)
+class TaskDeque
+{
+	static constexpr size_t mask = ThreadPool::DequeSize - 1;
+	static_assert((ThreadPool::DequeSize & mask) == 0, "DequeSize must be a power of two");
+
+public:
+	TaskDeque()
+	{
+		for(auto& slot : _slots)
+			slot.store(nullptr, std::memory_order_relaxed);
+	}
+
+
+	// owner only, false when full
+	bool Push(Task* const task)
+	{
+		const intptr_t bottom = _bottom.load(std::memory_order_relaxed);
+		const intptr_t top = _top.load(std::memory_order_acquire);
+
+		if( bottom - top > static_cast<intptr_t>(mask) )
+			return false;
+
+		_slots[bottom & mask].store(task, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+
+	// owner only
+	Task* Pop()
+	{
+		const intptr_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+		_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		intptr_t top = _top.load(std::memory_order_relaxed);
+
+		if( top > bottom ) {
+			_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Task* task = _slots[bottom & mask].load(std::memory_order_relaxed);
+
+		// last one: race the thieves for it
+		if( top == bottom ) 
+		{
+			if( !_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) )
+				task = nullptr;
+
+			_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		return task;
+	}
+
+
+	// any thread, nullptr when empty or another thread won the race
+	Task* Steal()
+	{
+		intptr_t top = _top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const intptr_t bottom = _bottom.load(std::memory_order_acquire);
+
+		if( top >= bottom )
+			return nullptr;
+
+		Task* const task = _slots[top & mask].load(std::memory_order_relaxed);
+
+		if( !_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) )
+			return nullptr;
+
+		return task;
+	}
+
+private:
+	std::atomic<intptr_t> _top{0};
+	uint8_t _pad0[CacheLineSize];
+	std::atomic<intptr_t> _bottom{0};
+	uint8_t _pad1[CacheLineSize];
+	std::atomic<Task*> _slots[ThreadPool::DequeSize];
+};
+
+
+// the Worker of the calling thread, if it is one (Worker is private to ThreadPool)
+thread_local void* current_worker = nullptr;
+
+
+}
+
+
+
+
+struct ThreadPool::Worker
+{
+	TaskDeque deque;
+	std::thread thread;
+	ThreadPool* pool;
+	unsigned index;
+	unsigned depth;
+	uint32_t rng;
+
+	// written by this worker only
+	std::atomic<uint64_t> tasks{0};
+	std::atomic<uint64_t> steals{0};
+	std::atomic<uint64_t> sleeps{0};
+	std::atomic<uint64_t> busyNs{0};
+	std::atomic<uint64_t> startNs{0};
+	uint8_t pad[CacheLineSize];
+};
+
+
+
+
+ThreadPool::~ThreadPool()
+{
+	this->Stop();
+}
+
+
+
+
+bool ThreadPool::Start(unsigned workers, const bool pin)
+{
+	if( _workers ) {
+		LogError("ThreadPool already started");
+		return false;
+	}
+
+	const unsigned cpus = std::thread::hardware_concurrency();
+
+	if( workers == 0 )
+		workers = cpus > 0 ? cpus : 1;
+
+	if( !_inject.initialize(InjectSize) )
+		return false;
+
+	_workers = alloc_arr<Worker>(workers);
+
+	if( !_workers ) {
+		LogError("Failed to allocate %u ThreadPool workers", workers);
+		_inject.free();
+		return false;
+	}
+
+	_stop.store(false, std::memory_order_relaxed);
+	_workerCount = workers;
+
+	for(unsigned i = 0; i < workers; ++i) 
+	{
+		Worker* const worker = new(&_workers[i]) Worker();
+		worker->pool = this;
+		worker->index = i;
+		worker->depth = 0;
+		worker->rng = (i + 1) * 0x9E3779B9u;
+		worker->startNs.store(now_ns(), std::memory_order_relaxed);
+	}
+
+	// threads start once every worker is there to steal from
+	for(unsigned i = 0; i < workers; ++i) 
+	{
+		Worker* const worker = &_workers[i];
+		worker->thread = std::thread([this, worker] { this->WorkerLoop(worker); });
+
+		if( pin && cpus > 0 )
+		{
+#if defined(__linux__)
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(i % cpus, &set);
+			if( pthread_setaffinity_np(worker->thread.native_handle(), sizeof(set), &set) != 0 )
+				LogError("Failed to pin ThreadPool worker %u to cpu %u", i, i % cpus);
+#elif defined(_WIN32)
+			if( !SetThreadAffinityMask(worker->thread.native_handle(), DWORD_PTR(1) << (i % cpus)) )
+				LogError("Failed to pin ThreadPool worker %u to cpu %u", i, i % cpus);
+#endif
+		}
+	}
+
+	return true;
+}
+
+
+
+
+void ThreadPool::Stop()
+{
+	if( !_workers )
+		return;
+
+	_stop.store(true, std::memory_order_seq_cst);
+	_wakeEpoch.fetch_add(1, std::memory_order_release);
+	futex_wake_all(&_wakeEpoch);
+
+	for(unsigned i = 0; i < _workerCount; ++i) {
+		_workers[i].thread.join();
+		_workers[i].~Worker();
+	}
+
+	free_arr(_workers);
+	_workers = nullptr;
+	_workerCount = 0;
+	_inject.free();
+}
+
+
+bool ThreadPool::IsRunning() const noexcept
+{
+	return _workers != nullptr;
+}
+
+
+unsigned ThreadPool::GetWorkerCount() const noexcept
+{
+	return _workerCount;
+}
+
+
+
+
+void ThreadPool::Submit(Task& task)
+{
+	ASSERT_MSG(task.group != nullptr, "Task submitted without a TaskGroup");
+	task.group->_pending.fetch_add(1, std::memory_order_relaxed);
+
+	Worker* const self = this->CurrentWorker();
+	const bool queued = self ? self->deque.Push(&task) 
+	                         : (_workers != nullptr && _inject.try_push(&task));
+
+	if( !queued ) {
+		this->Run(&task, self);
+		return;
+	}
+
+	this->Notify();
+}
+
+
+
+
+void ThreadPool::Wait(TaskGroup& group)
+{
+	Worker* const self = this->CurrentWorker();
+
+	int idle = 0;
+
+	while( !group.IsDone() )
+	{
+		if( Task* const task = this->FindTask(self) ) {
+			this->Run(task, self);
+			idle = 0;
+		} else if( ++idle < spin_count ) {
+			cpu_relax();
+		} else {
+			// the last tasks are running elsewhere, let them have the cpu
+			std::this_thread::yield();
+		}
+	}
+}
+
+
+
+
+ThreadPool::WorkerStats ThreadPool::GetWorkerStats(const unsigned index) const
+{
+	ASSERT_MSG(index < _workerCount, "ThreadPool worker index out of range");
+
+	const Worker& worker = _workers[index];
+	WorkerStats stats;
+	stats.tasks = worker.tasks.load(std::memory_order_relaxed);
+	stats.steals = worker.steals.load(std::memory_order_relaxed);
+	stats.sleeps = worker.sleeps.load(std::memory_order_relaxed);
+	stats.busyNs = worker.busyNs.load(std::memory_order_relaxed);
+	stats.uptimeNs = now_ns() - worker.startNs.load(std::memory_order_relaxed);
+	return stats;
+}
+
+
+// counters of a task running right now may land before or after the reset
+void ThreadPool::ResetStats()
+{
+	const uint64_t now = now_ns();
+
+	for(unsigned i = 0; i < _workerCount; ++i)
+	{
+		Worker& worker = _workers[i];
+		worker.tasks.store(0, std::memory_order_relaxed);
+		worker.steals.store(0, std::memory_order_relaxed);
+		worker.sleeps.store(0, std::memory_order_relaxed);
+		worker.busyNs.store(0, std::memory_order_relaxed);
+		worker.startNs.store(now, std::memory_order_relaxed);
+	}
+}
+
+
+
+
+ThreadPool::Worker* ThreadPool::CurrentWorker() const noexcept
+{
+	Worker* const worker = static_cast<Worker*>(current_worker);
+	return (worker && worker->pool == this) ? worker : nullptr;
+}
+
+
+
+
+// own deque first, then the shared queue, then steal starting at a random victim
+Task* ThreadPool::FindTask(Worker* const self)
+{
+	if( self )
+		if( Task* const task = self->deque.Pop() )
+			return task;
+
+	if( !_workers )
+		return nullptr;
+
+	Task* task;
+	if( _inject.try_pop(task) )
+		return task;
+
+	unsigned victim = 0;
+	if( self ) {
+		self->rng ^= self->rng << 13;
+		self->rng ^= self->rng >> 17;
+		self->rng ^= self->rng << 5;
+		victim = self->rng % _workerCount;
+	}
+
+	for(unsigned i = 0; i < _workerCount; ++i, victim = (victim + 1) % _workerCount)
+	{
+		if( &_workers[victim] == self )
+			continue;
+
+		if( Task* const stolen = _workers[victim].deque.Steal() ) {
+			if( self )
+				self->steals.fetch_add(1, std::memory_order_relaxed);
+			return stolen;
+		}
+	}
+
+	return nullptr;
+}
+
+
+
+
+void ThreadPool::Run(Task* const task, Worker* const self)
+{
+	// read before func, the task memory may be gone once the group is done
+	TaskGroup* const group = task->group;
+
+	if( self )
+	{
+		// tasks run from a Wait inside a task are already in the outer one's busy time
+		const uint64_t begin = self->depth++ == 0 ? now_ns() : 0;
+		task->func(task->data);
+		if( --self->depth == 0 )
+			self->busyNs.fetch_add(now_ns() - begin, std::memory_order_relaxed);
+		self->tasks.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		task->func(task->data);
+	}
+
+	group->_pending.fetch_sub(1, std::memory_order_release);
+}
+
+
+
+
+void ThreadPool::WorkerLoop(Worker* const self)
+{
+	current_worker = self;
+
+	while( !_stop.load(std::memory_order_acquire) )
+	{
+		if( Task* const task = this->FindTask(self) ) {
+			this->Run(task, self);
+			continue;
+		}
+
+		bool found = false;
+		for(int spin = 0; spin < spin_count && !found; ++spin) {
+			cpu_relax();
+			found = !_inject.empty();
+		}
+
+		if( found )
+			continue;
+
+		// same handshake as MpmcQueue: register, recheck, then sleep
+		const uint32_t seen = _wakeEpoch.load(std::memory_order_acquire);
+		_sleepers.fetch_add(1, std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		Task* const task = this->FindTask(self);
+
+		if( !task && !_stop.load(std::memory_order_acquire) ) {
+			self->sleeps.fetch_add(1, std::memory_order_relaxed);
+			futex_wait(&_wakeEpoch, seen);
+		}
+
+		_sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+		if( task )
+			this->Run(task, self);
+	}
+
+	current_worker = nullptr;
+}
+
+
+
+
+void ThreadPool::Notify()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if( _sleepers.load(std::memory_order_relaxed) != 0 ) {
+		_wakeEpoch.fetch_add(1, std::memory_order_release);
+		futex_wake(&_wakeEpoch, 1);
+	}
+}
+
+
+
+
+// about 8 chunks per worker, so stealing can even out uneven chunks
+size_t _parallel_grain(const ThreadPool& pool, const size_t count)
+{
+	const size_t chunks = size_t(pool.GetWorkerCount() + 1) * 8;
+	const size_t grain = count / chunks;
+	return grain > 0 ? grain : 1;
+}
+
+
+}